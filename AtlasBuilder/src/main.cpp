@@ -0,0 +1,253 @@
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Core/AtlasFile.h"
+#include "Core/SkylinePacker.h"
+#include "Rendering/stb_image.h"
+
+// Packs every image under a directory into atlas pages and writes them, with a perfect hash of the
+// sprite names, as one container for WompRenderer::loadAtlas. Sprites are named by their path
+// relative to the directory, with forward slashes: "icons/sword.png".
+
+namespace {
+    constexpr uint32_t DEFAULT_PAGE_SIZE = 2048;
+    constexpr uint32_t MAX_SEED = 1u << 24;
+
+    struct SourceImage {
+        std::string name;
+        glm::ivec2 size{};
+        std::vector<uint8_t> pixels{};
+        uint32_t page{};
+        glm::ivec2 position{};  // Of the padded rect
+    };
+
+    bool IsImage(const std::filesystem::path& path) {
+        std::string extension = path.extension().string();
+        std::ranges::transform(extension, extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return extension == ".png" || extension == ".jpg" || extension == ".jpeg" || extension == ".tga" || extension == ".bmp";
+    }
+
+    std::vector<SourceImage> LoadImages(const std::filesystem::path& directory) {
+        std::vector<std::filesystem::path> paths;
+        for (const auto& entry: std::filesystem::recursive_directory_iterator(directory)) {
+            if (entry.is_regular_file() && IsImage(entry.path())) {
+                paths.push_back(entry.path());
+            }
+        }
+        // Same input, same file
+        std::ranges::sort(paths);
+
+        std::vector<SourceImage> images;
+        for (const auto& path: paths) {
+            int width, height, channels;
+            uint8_t* pixels = stbi_load(path.string().c_str(), &width, &height, &channels, STBI_rgb_alpha);
+            if (!pixels) {
+                std::cerr << "Skipping " << path << ": " << stbi_failure_reason() << std::endl;
+                continue;
+            }
+
+            SourceImage& image = images.emplace_back();
+            image.name = std::filesystem::relative(path, directory).generic_string();
+            image.size = glm::ivec2(width, height);
+            image.pixels.assign(pixels, pixels + static_cast<size_t>(width) * height * 4);
+            stbi_image_free(pixels);
+        }
+        return images;
+    }
+
+    // Tallest first packs a skyline noticeably tighter than file order
+    uint32_t Pack(std::vector<SourceImage>& images, uint32_t pageSize) {
+        std::vector<SourceImage*> order;
+        for (auto& image: images) {
+            order.push_back(&image);
+        }
+        std::ranges::stable_sort(order, [](const SourceImage* a, const SourceImage* b) {
+            return a->size.y != b->size.y ? a->size.y > b->size.y : a->size.x > b->size.x;
+        });
+
+        std::vector<womp::SkylinePacker> pages;
+        for (SourceImage* image: order) {
+            const glm::ivec2 paddedSize = image->size + glm::ivec2(womp::ATLAS_SPRITE_PADDING * 2);
+            if (paddedSize.x > static_cast<int>(pageSize) || paddedSize.y > static_cast<int>(pageSize)) {
+                throw std::runtime_error(image->name + " does not fit in a " + std::to_string(pageSize) + " page");
+            }
+
+            std::optional<glm::ivec2> position;
+            uint32_t page = 0;
+            for (; page < pages.size(); ++page) {
+                position = pages[page].insert(paddedSize);
+                if (position) break;
+            }
+            if (!position) {
+                position = pages.emplace_back(static_cast<int>(pageSize), static_cast<int>(pageSize)).insert(paddedSize);
+            }
+
+            image->page = page;
+            image->position = *position;
+        }
+
+        for (size_t i = 0; i < pages.size(); ++i) {
+            std::cout << "Page " << i << ": " << static_cast<int>(pages[i].getOccupancy() * 100.0f) << "% used" << std::endl;
+        }
+        return static_cast<uint32_t>(pages.size());
+    }
+
+    // Hash and displace: names are bucketed by their unseeded hash, then the biggest buckets search for a
+    // seed that sends all of their names to free slots. Buckets of one name point straight at a free slot.
+    std::vector<int32_t> BuildPerfectHash(const std::vector<SourceImage>& images, std::vector<uint32_t>& slotImages) {
+        const auto count = static_cast<uint32_t>(images.size());
+
+        std::vector<std::vector<uint32_t>> buckets(count);
+        for (uint32_t i = 0; i < count; ++i) {
+            buckets[womp::AtlasNameHash(images[i].name, 0) % count].push_back(i);
+        }
+
+        std::vector<uint32_t> bucketOrder(count);
+        for (uint32_t i = 0; i < count; ++i) {
+            bucketOrder[i] = i;
+        }
+        std::ranges::stable_sort(bucketOrder, [&buckets](uint32_t a, uint32_t b) {
+            return buckets[a].size() > buckets[b].size();
+        });
+
+        std::vector<int32_t> seeds(count, 0);
+        std::vector<bool> used(count, false);
+        slotImages.assign(count, 0);
+
+        size_t next = 0;
+        for (; next < count && buckets[bucketOrder[next]].size() > 1; ++next) {
+            const auto& bucket = buckets[bucketOrder[next]];
+
+            std::vector<uint32_t> slots;
+            for (uint32_t seed = 1;; ++seed) {
+                if (seed >= MAX_SEED) {
+                    throw std::runtime_error("Could not find a perfect hash for the sprite names");
+                }
+
+                slots.clear();
+                for (const uint32_t image: bucket) {
+                    const uint32_t slot = womp::AtlasNameHash(images[image].name, seed) % count;
+                    if (used[slot] || std::ranges::find(slots, slot) != slots.end()) break;
+                    slots.push_back(slot);
+                }
+                if (slots.size() < bucket.size()) continue;
+
+                for (size_t i = 0; i < bucket.size(); ++i) {
+                    used[slots[i]] = true;
+                    slotImages[slots[i]] = bucket[i];
+                }
+                seeds[bucketOrder[next]] = static_cast<int32_t>(seed);
+                break;
+            }
+        }
+
+        uint32_t freeSlot = 0;
+        for (; next < count && buckets[bucketOrder[next]].size() == 1; ++next) {
+            while (used[freeSlot]) {
+                ++freeSlot;
+            }
+            used[freeSlot] = true;
+            slotImages[freeSlot] = buckets[bucketOrder[next]][0];
+            seeds[bucketOrder[next]] = -static_cast<int32_t>(freeSlot) - 1;
+        }
+
+        return seeds;
+    }
+
+    uint64_t AlignUp(uint64_t value, uint64_t alignment) {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    void Write(const std::filesystem::path& output, const std::vector<SourceImage>& images, uint32_t pageSize, uint32_t pageCount) {
+        std::vector<uint32_t> slotImages;
+        const std::vector<int32_t> seeds = BuildPerfectHash(images, slotImages);
+        const auto spriteCount = static_cast<uint32_t>(images.size());
+
+        const uint64_t pageBytes = static_cast<uint64_t>(pageSize) * pageSize * 4;
+
+        womp::AtlasFileHeader header{};
+        std::copy_n(womp::ATLAS_FILE_MAGIC, 4, header.magic);
+        header.version = womp::ATLAS_FILE_VERSION;
+        header.pageSize = pageSize;
+        header.pageCount = pageCount;
+        header.spriteCount = spriteCount;
+        header.pagesOffset = AlignUp(sizeof(womp::AtlasFileHeader), womp::ATLAS_FILE_PAGE_ALIGNMENT);
+        header.spritesOffset = header.pagesOffset + pageBytes * pageCount;
+        header.seedsOffset = header.spritesOffset + sizeof(womp::AtlasFileSprite) * spriteCount;
+        header.namesOffset = header.seedsOffset + sizeof(int32_t) * spriteCount;
+
+        std::vector<uint8_t> pages(pageBytes * pageCount, 0);
+        for (const auto& image: images) {
+            uint8_t* page = pages.data() + image.page * pageBytes;
+            uint8_t* destination = page + (static_cast<size_t>(image.position.y) * pageSize + image.position.x) * 4;
+            womp::CopyWithBorder(image.pixels.data(), image.size, womp::ATLAS_SPRITE_PADDING, destination, static_cast<size_t>(pageSize) * 4);
+        }
+
+        std::vector<womp::AtlasFileSprite> sprites(spriteCount);
+        std::string names;
+        for (uint32_t slot = 0; slot < spriteCount; ++slot) {
+            const SourceImage& image = images[slotImages[slot]];
+            sprites[slot] = womp::AtlasFileSprite{
+                .page = image.page,
+                .nameOffset = static_cast<uint32_t>(names.size()),
+                .nameLength = static_cast<uint32_t>(image.name.size()),
+                .x = static_cast<uint32_t>(image.position.x + womp::ATLAS_SPRITE_PADDING),
+                .y = static_cast<uint32_t>(image.position.y + womp::ATLAS_SPRITE_PADDING),
+                .width = static_cast<uint32_t>(image.size.x),
+                .height = static_cast<uint32_t>(image.size.y)
+            };
+            names += image.name;
+        }
+
+        std::ofstream file(output, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            throw std::runtime_error("Could not open " + output.string() + " for writing");
+        }
+
+        const std::vector<char> alignment(header.pagesOffset - sizeof(header), 0);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(alignment.data(), static_cast<std::streamsize>(alignment.size()));
+        file.write(reinterpret_cast<const char*>(pages.data()), static_cast<std::streamsize>(pages.size()));
+        file.write(reinterpret_cast<const char*>(sprites.data()), static_cast<std::streamsize>(sprites.size() * sizeof(womp::AtlasFileSprite)));
+        file.write(reinterpret_cast<const char*>(seeds.data()), static_cast<std::streamsize>(seeds.size() * sizeof(int32_t)));
+        file.write(names.data(), static_cast<std::streamsize>(names.size()));
+
+        if (!file) {
+            throw std::runtime_error("Could not write " + output.string());
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "Usage: AtlasBuilder <image directory> <output file> [page size, default " << DEFAULT_PAGE_SIZE << "]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    const std::filesystem::path input = argv[1];
+    const std::filesystem::path output = argv[2];
+    const uint32_t pageSize = argc > 3 ? static_cast<uint32_t>(std::stoul(argv[3])) : DEFAULT_PAGE_SIZE;
+
+    try {
+        std::vector<SourceImage> images = LoadImages(input);
+        if (images.empty()) {
+            std::cerr << "No images found in " << input << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        const uint32_t pageCount = Pack(images, pageSize);
+        Write(output, images, pageSize, pageCount);
+
+        std::cout << "Packed " << images.size() << " sprites into " << pageCount << " page(s): " << output << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,151 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "Core/BlockCompression.h"
+#include "Core/Ktx2File.h"
+#include "Rendering/stb_image.h"
+
+// Texture memory and load time of every image in a directory, decoded from its file with stb_image
+// against read from a block compressed .ktx2 written by the same encoder as TextureEncoder. Loading
+// ends where both paths have their bytes in what would be staging memory, the upload itself is a
+// copy of the same size either way. Files are in the page cache after the first iteration.
+
+namespace {
+    constexpr int ITERATIONS = 20;
+
+    struct Result {
+        std::string name;
+        uint64_t rgbaBytes{};           // Level 0 as RGBA8, what createTexture uploads
+        uint64_t rgbaMipmappedBytes{};  // With the chain createTexture(path, true) generates
+        uint64_t compressedBytes{};     // Every level the .ktx2 stores
+        double decodeMs{};
+        double compressedMs{};
+    };
+
+    // Writes the .ktx2 TextureEncoder writes with its default options, BC1 or BC7 chosen by alpha and a full chain
+    uint64_t EncodeFile(const uint8_t* pixels, glm::ivec2 size, const std::filesystem::path& output, uint64_t& mipmappedBytes) {
+        const womp::BlockFormat format = womp::ChooseBlockFormat(pixels, size);
+        const womp::CompressedImage image = womp::CompressMipChain(pixels, size, format);
+        womp::Ktx2File::Write(output, format, size, image.levels);
+
+        mipmappedBytes = image.uncompressedBytes;
+        uint64_t compressedBytes = 0;
+        for (const auto& level: image.levels) {
+            compressedBytes += level.size();
+        }
+        return compressedBytes;
+    }
+
+    double DecodeMs(const std::filesystem::path& path, std::vector<uint8_t>& staging) {
+        const auto start = std::chrono::steady_clock::now();
+
+        int width, height, channels;
+        uint8_t* pixels = stbi_load(path.string().c_str(), &width, &height, &channels, STBI_rgb_alpha);
+        const size_t size = static_cast<size_t>(width) * height * 4;
+        staging.resize(size);
+        std::memcpy(staging.data(), pixels, size);
+        stbi_image_free(pixels);
+
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    double CompressedMs(const std::filesystem::path& path, std::vector<uint8_t>& staging) {
+        const auto start = std::chrono::steady_clock::now();
+
+        const womp::Ktx2File file(path.string());
+        staging.resize(file.getDataSize());
+        size_t offset = 0;
+        for (uint32_t level = 0; level < file.getLevelCount(); ++level) {
+            const std::span<const uint8_t> blocks = file.getLevel(level);
+            std::memcpy(staging.data() + offset, blocks.data(), blocks.size());
+            offset += blocks.size();
+        }
+
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+int main(int argc, char* argv[]) {
+    const std::filesystem::path input = argc > 1 ? argv[1] : "resources";
+    if (!std::filesystem::is_directory(input)) {
+        std::cerr << "Usage: CompressionBenchmark [image directory, default resources]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    const std::filesystem::path encoded = std::filesystem::temp_directory_path() / "womp_compression_benchmark";
+    std::filesystem::create_directories(encoded);
+
+    std::vector<std::filesystem::path> paths;
+    for (const auto& entry: std::filesystem::recursive_directory_iterator(input)) {
+        if (entry.is_regular_file() && womp::IsSourceImagePath(entry.path())) {
+            paths.push_back(entry.path());
+        }
+    }
+    std::ranges::sort(paths);
+
+    std::vector<Result> results;
+    std::vector<uint8_t> staging;
+    for (size_t i = 0; i < paths.size(); ++i) {
+        int width, height, channels;
+        uint8_t* pixels = stbi_load(paths[i].string().c_str(), &width, &height, &channels, STBI_rgb_alpha);
+        if (!pixels) {
+            std::cerr << "Skipping " << paths[i] << ": " << stbi_failure_reason() << std::endl;
+            continue;
+        }
+
+        Result& result = results.emplace_back();
+        result.name = std::filesystem::relative(paths[i], input).generic_string();
+        result.rgbaBytes = static_cast<uint64_t>(width) * height * 4;
+
+        const std::filesystem::path compressed = encoded / (std::to_string(i) + ".ktx2");
+        result.compressedBytes = EncodeFile(pixels, glm::ivec2(width, height), compressed, result.rgbaMipmappedBytes);
+        stbi_image_free(pixels);
+
+        result.decodeMs = 1e30;
+        result.compressedMs = 1e30;
+        for (int iteration = 0; iteration < ITERATIONS; ++iteration) {
+            result.decodeMs = std::min(result.decodeMs, DecodeMs(paths[i], staging));
+            result.compressedMs = std::min(result.compressedMs, CompressedMs(compressed, staging));
+        }
+    }
+    std::filesystem::remove_all(encoded);
+
+    if (results.empty()) {
+        std::cerr << "No images found in " << input << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::cout << "Texture memory and load time, best of " << ITERATIONS << " loads\n";
+    std::cout << std::left << std::setw(32) << "image" << std::right
+              << std::setw(12) << "RGBA8 KiB" << std::setw(14) << "+mips KiB" << std::setw(12) << "BCn KiB" << std::setw(10) << "saved"
+              << std::setw(14) << "decode ms" << std::setw(12) << "ktx2 ms" << std::setw(10) << "speedup" << "\n";
+
+    Result total{.name = "total"};
+    const auto print = [](const Result& result) {
+        std::cout << std::left << std::setw(32) << result.name << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(12) << static_cast<double>(result.rgbaBytes) / 1024.0
+                  << std::setw(14) << static_cast<double>(result.rgbaMipmappedBytes) / 1024.0
+                  << std::setw(12) << static_cast<double>(result.compressedBytes) / 1024.0
+                  << std::setw(9) << 100.0 * (1.0 - static_cast<double>(result.compressedBytes) / static_cast<double>(result.rgbaMipmappedBytes)) << "%"
+                  << std::setprecision(3)
+                  << std::setw(14) << result.decodeMs
+                  << std::setw(12) << result.compressedMs
+                  << std::setw(9) << std::setprecision(1) << result.decodeMs / result.compressedMs << "x\n";
+    };
+    for (const Result& result: results) {
+        print(result);
+        total.rgbaBytes += result.rgbaBytes;
+        total.rgbaMipmappedBytes += result.rgbaMipmappedBytes;
+        total.compressedBytes += result.compressedBytes;
+        total.decodeMs += result.decodeMs;
+        total.compressedMs += result.compressedMs;
+    }
+    print(total);
+
+    return EXIT_SUCCESS;
+}
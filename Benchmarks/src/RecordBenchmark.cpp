@@ -0,0 +1,167 @@
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <unordered_map>
+#include <vector>
+
+#include "Rendering/DrawQueue.h"
+#include "Rendering/SpriteStream.h"
+
+// Record time per 10k sprites, the AoS queue with a texture map lookup and UV normalization per draw
+// that render() used to do, against the SoA streams that are normalized when drawTexture is called.
+
+namespace {
+    constexpr uint32_t SPRITES = 10'000;
+    constexpr uint32_t TEXTURES = 16;
+    constexpr uint32_t RUN_LENGTH = 64;     // Consecutive draws sharing a texture
+    constexpr int ITERATIONS = 2000;
+
+    // Layout of the queue before the SoA rewrite
+    struct LegacyDrawCommand {
+        womp::TextureHandle texture;
+        WP_Rect srcRect;
+        WP_Rect dstRect;
+        float rotation = 0.0f;
+        glm::vec4 color = glm::vec4(1.0f);
+        uint8_t layer = 0;
+    };
+
+    struct LegacyTexture {
+        VkDescriptorSet descriptorSet{};
+        glm::ivec2 size{};
+    };
+
+    VkDescriptorSet FakeSet(uint32_t index) {
+        return reinterpret_cast<VkDescriptorSet>(static_cast<uintptr_t>(index) * 64);
+    }
+
+    uint32_t LegacyRecord(const std::vector<LegacyDrawCommand>& commands, const std::unordered_map<womp::TextureHandle, LegacyTexture>& textures,
+                          womp::SpriteInstance* instances, std::vector<womp::SpriteBatch>& batches) {
+        batches.clear();
+        uint32_t instanceCount = 0;
+
+        for (const auto& cmd: commands) {
+            auto it = textures.find(cmd.texture);
+            if (it == textures.end()) continue;
+
+            const LegacyTexture& tex = it->second;
+
+            glm::vec4 srcUV = cmd.srcRect.toVec4();
+            if (srcUV.z > 0 && srcUV.w > 0) {
+                srcUV.x /= tex.size.x;
+                srcUV.y /= tex.size.y;
+                srcUV.z /= tex.size.x;
+                srcUV.w /= tex.size.y;
+            } else {
+                srcUV = glm::vec4(0, 0, 1, 1);
+            }
+
+            if (batches.empty() || batches.back().descriptorSet != tex.descriptorSet) {
+                batches.push_back(womp::SpriteBatch{tex.descriptorSet, instanceCount, 0});
+            }
+
+            instances[instanceCount] = womp::SpriteInstance{
+                .srcRect = srcUV,
+                .dstRect = cmd.dstRect.toVec4(),
+                .color = cmd.color,
+                .rotation = cmd.rotation,
+                .textureIndex = cmd.texture,
+                .batchIndex = static_cast<uint32_t>(batches.size() - 1)
+            };
+
+            batches.back().instanceCount++;
+            instanceCount++;
+        }
+        return instanceCount;
+    }
+
+    template<typename F>
+    double NanosecondsPerRun(F&& run) {
+        using Clock = std::chrono::steady_clock;
+
+        // Warm up caches and vector capacities
+        for (int i = 0; i < ITERATIONS / 10; ++i) {
+            run();
+        }
+
+        const auto start = Clock::now();
+        for (int i = 0; i < ITERATIONS; ++i) {
+            run();
+        }
+        return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / ITERATIONS;
+    }
+}
+
+int main() {
+    std::unordered_map<womp::TextureHandle, LegacyTexture> textureMap;
+    std::vector<glm::vec2> textureSizes(TEXTURES + 1, glm::vec2(0.0f));
+    std::vector<VkDescriptorSet> textureSets(TEXTURES + 1, VK_NULL_HANDLE);
+    std::vector<uint32_t> textureSlots(TEXTURES + 1);
+    std::iota(textureSlots.begin(), textureSlots.end(), 0u);   // The legacy path wrote the handle
+    for (uint32_t t = 1; t <= TEXTURES; ++t) {
+        const glm::ivec2 size{static_cast<int>(64 * t), static_cast<int>(32 * t)};
+        textureMap.emplace(t, LegacyTexture{FakeSet(t), size});
+        textureSizes[t] = glm::vec2(size);
+        textureSets[t] = FakeSet(t);
+    }
+
+    std::vector<LegacyDrawCommand> legacyCommands;
+    legacyCommands.reserve(SPRITES);
+    for (uint32_t i = 0; i < SPRITES; ++i) {
+        legacyCommands.push_back(LegacyDrawCommand{
+            .texture = 1 + (i / RUN_LENGTH) % TEXTURES,
+            .srcRect = WP_Rect{static_cast<float>(i % 4) * 16, 0, 16, 16},
+            .dstRect = WP_Rect{static_cast<float>(i % 100) * 12, static_cast<float>(i / 100) * 12, 6, 6},
+            .rotation = static_cast<float>(i % 360) * 0.01745f,
+            .color = glm::vec4(1.0f, 0.5f, 0.25f, 1.0f)
+        });
+    }
+
+    std::vector<womp::SpriteInstance> legacyInstances(SPRITES);
+    std::vector<womp::SpriteInstance> streamInstances(SPRITES);
+    std::vector<womp::SpriteBatch> batches;
+
+    womp::DrawStreams streams;
+    streams.reserve(SPRITES);
+    const auto submitStreams = [&] {
+        streams.clear();
+        for (const auto& cmd: legacyCommands) {
+            streams.push(cmd.texture, cmd.layer, womp::NormalizeSourceRect(cmd.srcRect, textureSizes[cmd.texture]), cmd.dstRect.toVec4(), cmd.rotation, cmd.color);
+        }
+    };
+
+    const double legacyNs = NanosecondsPerRun([&] {
+        LegacyRecord(legacyCommands, textureMap, legacyInstances.data(), batches);
+    });
+
+    const double submitNs = NanosecondsPerRun(submitStreams);
+
+    submitStreams();
+    const double streamNs = NanosecondsPerRun([&] {
+        womp::WriteSpriteInstances(streams, nullptr, textureSets, textureSlots, VK_NULL_HANDLE, streamInstances.data(), batches);
+    });
+
+    const double bindlessNs = NanosecondsPerRun([&] {
+        womp::WriteSpriteInstances(streams, nullptr, textureSets, textureSlots, FakeSet(TEXTURES + 1), streamInstances.data(), batches);
+    });
+
+    // Both paths have to produce the same instances for the comparison to mean anything
+    womp::WriteSpriteInstances(streams, nullptr, textureSets, textureSlots, VK_NULL_HANDLE, streamInstances.data(), batches);
+    if (std::memcmp(legacyInstances.data(), streamInstances.data(), SPRITES * sizeof(womp::SpriteInstance)) != 0) {
+        std::cerr << "SoA and AoS paths wrote different instances" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    const double scale = 10'000.0 / SPRITES / 1000.0;
+    std::cout << "Record time per 10k sprites, " << TEXTURES << " textures in runs of " << RUN_LENGTH << ", " << ITERATIONS << " iterations\n";
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << std::setw(34) << std::left << "before: AoS + map lookup" << std::setw(10) << std::right << legacyNs * scale << " us\n";
+    std::cout << std::setw(34) << std::left << "after: SoA streams" << std::setw(10) << std::right << streamNs * scale << " us"
+              << "  (" << std::setprecision(2) << legacyNs / streamNs << "x)\n" << std::setprecision(1);
+    std::cout << std::setw(34) << std::left << "after: SoA streams, bindless" << std::setw(10) << std::right << bindlessNs * scale << " us\n";
+    std::cout << std::setw(34) << std::left << "drawTexture side: push + normalize" << std::setw(10) << std::right << submitNs * scale << " us\n";
+
+    return EXIT_SUCCESS;
+}
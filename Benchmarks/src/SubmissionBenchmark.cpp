@@ -0,0 +1,117 @@
+#include <algorithm>
+#include <atomic>
+#include <barrier>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "Rendering/DrawQueue.h"
+
+// Measures how many draw commands per second DrawQueue accepts as producer threads are added,
+// including the merge render() does at the start of a frame.
+
+namespace {
+    constexpr size_t DRAWS_PER_FRAME = 1 << 20;
+    constexpr int FRAMES = 20;
+
+    struct Result {
+        double submitMs;
+        double mergeMs;
+    };
+
+    void SubmitFrame(womp::DrawQueue& queue, unsigned thread, unsigned threadCount) {
+        queue.setSubmitOrder(thread);
+        queue.setLayer(static_cast<uint8_t>(thread));
+
+        const size_t count = DRAWS_PER_FRAME / threadCount;
+        for (size_t i = 0; i < count; ++i) {
+            const float x = static_cast<float>(i % 1024);
+            const float y = static_cast<float>(i / 1024);
+            queue.submit(
+                static_cast<womp::TextureHandle>(1 + i % 8),
+                glm::vec4(0.0f, 0.0f, 0.5f, 0.5f),
+                glm::vec4(x, y, 8.0f, 8.0f),
+                0.0f,
+                glm::vec4(1.0f)
+            );
+        }
+    }
+
+    // The producers live for the whole run like a game's worker threads, so after the first frame every
+    // submission goes to a chunk that is already registered and grown
+    Result RunFrames(womp::DrawQueue& queue, unsigned threadCount, womp::DrawStreams& merged) {
+        using Clock = std::chrono::steady_clock;
+
+        std::barrier frameSync(threadCount + 1);
+        std::atomic<bool> stop{false};
+        std::vector<std::jthread> producers;
+        for (unsigned t = 0; t < threadCount; ++t) {
+            producers.emplace_back([&, t] {
+                while (true) {
+                    frameSync.arrive_and_wait();
+                    if (stop.load()) return;
+                    SubmitFrame(queue, t, threadCount);
+                    frameSync.arrive_and_wait();
+                }
+            });
+        }
+
+        Result best{1e30, 1e30};
+        for (int frame = 0; frame < FRAMES; ++frame) {
+            merged.clear();
+
+            const auto submitStart = Clock::now();
+            frameSync.arrive_and_wait();
+            frameSync.arrive_and_wait();
+            const auto mergeStart = Clock::now();
+
+            queue.merge(merged);
+            const auto mergeEnd = Clock::now();
+
+            best.submitMs = std::min(best.submitMs, std::chrono::duration<double, std::milli>(mergeStart - submitStart).count());
+            best.mergeMs = std::min(best.mergeMs, std::chrono::duration<double, std::milli>(mergeEnd - mergeStart).count());
+        }
+
+        stop.store(true);
+        frameSync.arrive_and_wait();
+        return best;
+    }
+}
+
+int main() {
+    const unsigned maxThreads = std::max(1u, std::thread::hardware_concurrency());
+
+    std::cout << "DrawQueue submission, " << DRAWS_PER_FRAME << " draws per frame, best of " << FRAMES << " frames\n";
+    std::cout << std::setw(8) << "threads" << std::setw(14) << "submit ms" << std::setw(12) << "merge ms"
+              << std::setw(16) << "Mdraws/s" << std::setw(10) << "speedup" << "\n";
+
+    double baseline = 0.0;
+    womp::DrawStreams merged;
+    for (unsigned threads = 1; threads <= maxThreads; threads *= 2) {
+        // Fresh queue per run, chunk registration and growth only happen in its first frame
+        womp::DrawQueue queue;
+        const Result result = RunFrames(queue, threads, merged);
+
+        // Merged order must follow the submit order, each thread drew on the layer matching its order
+        if (!std::is_sorted(merged.layers.begin(), merged.layers.end())) {
+            std::cerr << "Merged stream is not in submit order" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        const double totalMs = result.submitMs + result.mergeMs;
+        const double drawsPerSecond = static_cast<double>(merged.size()) / (totalMs / 1000.0) / 1e6;
+        if (threads == 1) {
+            baseline = totalMs;
+        }
+
+        std::cout << std::setw(8) << threads
+                  << std::setw(14) << std::fixed << std::setprecision(2) << result.submitMs
+                  << std::setw(12) << result.mergeMs
+                  << std::setw(16) << drawsPerSecond
+                  << std::setw(9) << baseline / totalMs << "x\n";
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,81 @@
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include <womp/WompMath.h>
+
+// Time for WP_TransformQuads to turn 10k rotated sprites into clip space quads at each SIMD level,
+// and the largest difference between the SIMD paths and the scalar one.
+
+namespace {
+    constexpr size_t SPRITES = 10'000;
+    constexpr int ITERATIONS = 2000;
+    const glm::vec2 SCREEN_SIZE{1920.0f, 1080.0f};
+
+    const char* LevelName(WP_SimdLevel level) {
+        switch (level) {
+            case WP_SimdLevel::AVX2: return "AVX2";
+            case WP_SimdLevel::SSE2: return "SSE2";
+            default: return "scalar";
+        }
+    }
+
+    float MaxDifference(const std::vector<WP_Quad>& a, const std::vector<WP_Quad>& b) {
+        float difference = 0.0f;
+        for (size_t i = 0; i < a.size(); ++i) {
+            for (int corner = 0; corner < 4; ++corner) {
+                difference = std::max(difference, std::abs(a[i].corners[corner].x - b[i].corners[corner].x));
+                difference = std::max(difference, std::abs(a[i].corners[corner].y - b[i].corners[corner].y));
+            }
+        }
+        return difference;
+    }
+}
+
+int main() {
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> position(0.0f, 1920.0f);
+    std::uniform_real_distribution<float> halfSize(2.0f, 64.0f);
+    std::uniform_real_distribution<float> angle(-3.14159265f, 3.14159265f);
+
+    std::vector<glm::vec4> rects(SPRITES);
+    std::vector<float> rotations(SPRITES);
+    for (size_t i = 0; i < SPRITES; ++i) {
+        rects[i] = glm::vec4(position(rng), position(rng), halfSize(rng), halfSize(rng));
+        rotations[i] = angle(rng);
+    }
+
+    std::vector<WP_Quad> reference(SPRITES);
+    WP_TransformQuads(rects.data(), rotations.data(), SPRITES, SCREEN_SIZE, reference.data(), WP_SimdLevel::Scalar);
+
+    std::cout << "WP_TransformQuads per 10k sprites, CPU supports " << LevelName(WP_GetSimdLevel()) << "\n";
+    std::cout << std::fixed;
+
+    double scalarUs = 0.0;
+    for (const WP_SimdLevel level: {WP_SimdLevel::Scalar, WP_SimdLevel::SSE2, WP_SimdLevel::AVX2}) {
+        if (level > WP_GetSimdLevel()) {
+            continue;
+        }
+
+        std::vector<WP_Quad> quads(SPRITES);
+        using Clock = std::chrono::steady_clock;
+        const auto start = Clock::now();
+        for (int i = 0; i < ITERATIONS; ++i) {
+            WP_TransformQuads(rects.data(), rotations.data(), SPRITES, SCREEN_SIZE, quads.data(), level);
+        }
+        const double us = std::chrono::duration<double, std::micro>(Clock::now() - start).count() / ITERATIONS;
+        if (level == WP_SimdLevel::Scalar) {
+            scalarUs = us;
+        }
+
+        std::cout << std::setw(8) << std::left << LevelName(level)
+                  << std::setw(10) << std::right << std::setprecision(1) << us << " us  "
+                  << std::setprecision(2) << scalarUs / us << "x  max clip space error "
+                  << std::scientific << std::setprecision(1) << MaxDifference(reference, quads) << std::fixed << "\n";
+    }
+
+    return EXIT_SUCCESS;
+}
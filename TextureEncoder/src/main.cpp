@@ -0,0 +1,119 @@
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "Core/BlockCompression.h"
+#include "Core/Ktx2File.h"
+#include "Rendering/stb_image.h"
+
+// Encodes every image under a directory into a block compressed .ktx2 with its mip chain, at the same
+// relative path in the output directory. WompRenderer::createTexture uploads those as they are stored.
+
+namespace {
+    struct Options {
+        std::optional<womp::BlockFormat> format{};  // Chosen per image when empty
+        bool mipmaps{true};
+    };
+
+    const char* GetFormatName(womp::BlockFormat format) {
+        switch (format) {
+            case womp::BlockFormat::BC1: return "BC1";
+            case womp::BlockFormat::BC3: return "BC3";
+            case womp::BlockFormat::BC7: return "BC7";
+        }
+        return "";
+    }
+
+    // Bytes of the compressed file's levels, and of the same levels as RGBA8
+    struct Sizes {
+        uint64_t compressed{};
+        uint64_t uncompressed{};
+    };
+
+    Sizes Encode(const std::filesystem::path& input, const std::filesystem::path& output, const Options& options) {
+        int width, height, channels;
+        uint8_t* pixels = stbi_load(input.string().c_str(), &width, &height, &channels, STBI_rgb_alpha);
+        if (!pixels) {
+            throw std::runtime_error("Could not load " + input.string() + ": " + stbi_failure_reason());
+        }
+
+        const glm::ivec2 size(width, height);
+        const womp::BlockFormat format = options.format.value_or(womp::ChooseBlockFormat(pixels, size));
+        const womp::CompressedImage image = womp::CompressMipChain(pixels, size, format, options.mipmaps);
+        stbi_image_free(pixels);
+
+        Sizes sizes;
+        sizes.uncompressed = image.uncompressedBytes;
+        for (const auto& level: image.levels) {
+            sizes.compressed += level.size();
+        }
+
+        std::filesystem::create_directories(output.parent_path());
+        womp::Ktx2File::Write(output, format, size, image.levels);
+
+        std::cout << output.string() << ": " << width << "x" << height << " " << GetFormatName(format) << ", "
+                  << image.levels.size() << " level(s), " << sizes.uncompressed / 1024 << " KiB -> " << sizes.compressed / 1024 << " KiB" << std::endl;
+        return sizes;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "Usage: TextureEncoder <image directory> <output directory> [bc1 | bc3 | bc7, default per image] [--no-mips]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    const std::filesystem::path input = argv[1];
+    const std::filesystem::path output = argv[2];
+
+    Options options;
+    for (int i = 3; i < argc; ++i) {
+        const std::string argument = argv[i];
+        if (argument == "--no-mips") {
+            options.mipmaps = false;
+        } else if (const auto format = womp::ParseBlockFormat(argument)) {
+            options.format = format;
+        } else {
+            std::cerr << "Unknown option " << argument << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    try {
+        std::vector<std::filesystem::path> paths;
+        for (const auto& entry: std::filesystem::recursive_directory_iterator(input)) {
+            if (entry.is_regular_file() && womp::IsSourceImagePath(entry.path())) {
+                paths.push_back(entry.path());
+            }
+        }
+        if (paths.empty()) {
+            std::cerr << "No images found in " << input << std::endl;
+            return EXIT_FAILURE;
+        }
+        std::ranges::sort(paths);
+
+        const auto start = std::chrono::steady_clock::now();
+        Sizes total;
+        for (const auto& path: paths) {
+            std::filesystem::path target = output / std::filesystem::relative(path, input);
+            target.replace_extension(".ktx2");
+
+            const Sizes sizes = Encode(path, target, options);
+            total.compressed += sizes.compressed;
+            total.uncompressed += sizes.uncompressed;
+        }
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::cout << "Encoded " << paths.size() << " image(s) in " << seconds << " s, " << total.uncompressed / 1024 << " KiB -> "
+                  << total.compressed / 1024 << " KiB of texture memory" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,84 @@
+#ifndef PARTICLEEMITTER_H
+#define PARTICLEEMITTER_H
+
+#include <array>
+#include <memory>
+
+#include "WompMath.h"
+#include "Core/Hash.h"
+#include "Rendering/DrawQueue.h"
+#include "Rendering/Resources/Buffer.h"
+
+namespace womp {
+    class WompRenderer;
+
+    struct ParticleEmitterSettings {
+        TextureHandle texture{};
+        WP_Rect srcRect{0, 0, 0, 0};        // Empty samples the whole texture
+        glm::vec2 position{0.0f};
+        glm::vec2 spread{0.0f};             // Half size of the box particles spawn in, around position
+        float spawnRate{0.0f};              // Particles per second
+        glm::vec2 velocityMin{0.0f};        // Pixels per second, picked per axis between min and max
+        glm::vec2 velocityMax{0.0f};
+        glm::vec2 gravity{0.0f};            // Pixels per second squared
+        float angularVelocityMax{0.0f};     // Radians per second, picked between -max and max
+        float lifetimeMin{1.0f};            // Seconds
+        float lifetimeMax{1.0f};
+        float startSize{8.0f};              // Pixels, blended over the lifetime
+        float endSize{8.0f};
+        glm::vec4 startColor{1.0f};
+        glm::vec4 endColor{1.0f};
+        BlendMode blendMode{BlendMode::Alpha};  // Additive for sparks and glows
+    };
+
+    // Particles simulated entirely on the GPU. particles.comp ages, moves and compacts the live particles
+    // and spawns new ones in one dispatch, writing a SpriteInstance per survivor and the instance count of
+    // an indirect draw through the sprite pipeline. Live particles come out in no particular order.
+    // Get one from WompRenderer::createParticleEmitter and update it from the thread that calls render().
+    class ParticleEmitter {
+    public:
+        ParticleEmitter(const ParticleEmitter& other) = delete;
+        ParticleEmitter(ParticleEmitter&& other) noexcept = delete;
+        ParticleEmitter& operator=(const ParticleEmitter& other) = delete;
+        ParticleEmitter& operator=(ParticleEmitter&& other) noexcept = delete;
+
+        // Advances the simulation and spawns spawnRate * deltaTime particles the next time the emitter is
+        // drawn, calls in between add up. An emitter that isn't updated isn't simulated and draws as it was.
+        void update(float deltaTime);
+        // Spawns count particles at once on top of the spawn rate, past the capacity they are dropped
+        void burst(uint32_t count);
+
+        void setSettings(const ParticleEmitterSettings& settings);
+        void setPosition(glm::vec2 position);
+        [[nodiscard]] const ParticleEmitterSettings& getSettings() const { return m_settings; }
+        [[nodiscard]] uint32_t getCapacity() const { return m_capacity; }
+
+    private:
+        friend class WompRenderer;
+
+        ParticleEmitter(const WompRenderer& renderer, uint32_t capacity, const ParticleEmitterSettings& settings);
+
+        const WompRenderer& m_renderer;
+        uint32_t m_capacity{};
+        ParticleEmitterSettings m_settings{};
+
+        TextureHandle m_texture{};      // Atlased textures resolve to their page
+        glm::vec4 m_uvRect{};
+
+        float m_pendingTime{};
+        float m_spawnRemainder{};       // Fraction of a particle carried over to the next update
+        uint32_t m_pendingSpawns{};
+        uint32_t m_seed{};
+        uint64_t m_revision{NextRevision()};    // Taken again by update, burst and the setters, so a paused emitter replays
+
+        // Particle buffer and indirect draw the last dispatch wrote to, the other one is written next
+        uint32_t m_current{};
+
+        // Kept alive by the renderer for every frame that reads them, like SpriteLayer's buffer
+        std::array<std::shared_ptr<Buffer>, 2> m_particles{};
+        std::shared_ptr<Buffer> m_instances{};
+        std::shared_ptr<Buffer> m_draws{};  // Two VkDrawIndirectCommand, one per particle buffer
+    };
+}
+
+#endif //PARTICLEEMITTER_H
@@ -35,7 +35,10 @@ namespace womp {
 
         VkCommandBuffer BeginFrame();
         void endFrame();
-        void beginSwapChainRenderPass(VkCommandBuffer commandBuffer) const;
+        // With VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT the draws have to come from secondary
+        // command buffers, which set their own viewport and scissor
+        void beginSwapChainRenderPass(VkCommandBuffer commandBuffer, VkRenderingFlags flags = 0) const;
+        void setViewportAndScissor(VkCommandBuffer commandBuffer) const;
         void endSwapChainRenderPass(VkCommandBuffer commandBuffer) const;
         [[nodiscard]] VkDevice getVkDevice() const { return m_device->GetVkDevice(); }
         [[nodiscard]] Device& getDevice() const { return *m_device; }
@@ -0,0 +1,58 @@
+#ifndef SPRITELAYER_H
+#define SPRITELAYER_H
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "WompMath.h"
+#include "Core/Hash.h"
+#include "Rendering/DrawQueue.h"
+#include "Rendering/SpriteInstance.h"
+#include "Rendering/Resources/Buffer.h"
+
+namespace womp {
+    class WompRenderer;
+
+    using SpriteId = uint32_t;
+
+    // Retained set of sprites whose instance data lives in a device local buffer. Only the sprites
+    // changed since the last time the layer was drawn are uploaded, drawing it is a draw per texture run.
+    // Made by WompRenderer::createSpriteLayer, edit it on the thread that calls render().
+    class SpriteLayer {
+    public:
+        SpriteLayer(const SpriteLayer& other) = delete;
+        SpriteLayer(SpriteLayer&& other) noexcept = delete;
+        SpriteLayer& operator=(const SpriteLayer& other) = delete;
+        SpriteLayer& operator=(SpriteLayer&& other) noexcept = delete;
+
+        SpriteId add(TextureHandle texture, WP_Rect srcRect, WP_Rect dstRect, float rotation = 0.0f, glm::vec4 color = glm::vec4(1.0f));
+        void update(SpriteId sprite, TextureHandle texture, WP_Rect srcRect, WP_Rect dstRect, float rotation = 0.0f, glm::vec4 color = glm::vec4(1.0f));
+        void setDestination(SpriteId sprite, WP_Rect dstRect, float rotation = 0.0f);
+        void setColor(SpriteId sprite, glm::vec4 color);
+        void clear();
+
+        [[nodiscard]] size_t size() const { return m_instances.size(); }
+
+    private:
+        friend class WompRenderer;
+
+        explicit SpriteLayer(const WompRenderer& renderer);
+
+        [[nodiscard]] SpriteInstance makeInstance(TextureHandle texture, WP_Rect srcRect, WP_Rect dstRect, float rotation, glm::vec4 color) const;
+        void markDirty(uint32_t first, uint32_t count);
+
+        const WompRenderer& m_renderer;
+
+        std::vector<SpriteInstance> m_instances{};
+        std::vector<std::pair<uint32_t, uint32_t>> m_dirtyRanges{};    // first, end
+        bool m_batchesDirty{false};
+        uint64_t m_revision{NextRevision()};  // Taken again whenever a sprite is added, changed or cleared
+
+        // Kept alive by the renderer for every frame that reads it, so the layer can grow or go away at any time
+        std::shared_ptr<Buffer> m_buffer{};
+        std::vector<SpriteBatch> m_batches{};
+    };
+}
+
+#endif //SPRITELAYER_H
@@ -0,0 +1,76 @@
+#ifndef TILEMAP_H
+#define TILEMAP_H
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "WompMath.h"
+#include "Core/Hash.h"
+#include "Rendering/DrawQueue.h"
+#include "Rendering/Resources/Buffer.h"
+
+namespace womp {
+    class WompRenderer;
+
+    // Grid of tiles from a tileset, a grid of equally sized tiles over one texture numbered row by row from its
+    // top left. Tile (0, 0) sits at the position and rows go up the screen, like sprite coordinates.
+    // Tile indices live in a device local buffer split into CHUNK_SIZE x CHUNK_SIZE chunks; only the chunks
+    // overlapping the screen are drawn, with one instanced draw each, and an edit uploads the dirty range
+    // of its chunk when render() next draws it. WompRenderer::createTilemap makes one, it is not thread safe.
+    class Tilemap {
+    public:
+        static constexpr int CHUNK_SIZE = 32;   // Matches tilemap.vert
+        static constexpr uint32_t CHUNK_TILES = CHUNK_SIZE * CHUNK_SIZE;
+        static constexpr uint32_t EMPTY_TILE = ~0u;
+
+        Tilemap(const Tilemap& other) = delete;
+        Tilemap(Tilemap&& other) noexcept = delete;
+        Tilemap& operator=(const Tilemap& other) = delete;
+        Tilemap& operator=(Tilemap&& other) noexcept = delete;
+
+        void setTile(glm::ivec2 position, uint32_t tile);
+        [[nodiscard]] uint32_t getTile(glm::ivec2 position) const;
+        void fill(uint32_t tile);
+
+        // Screen position of the lower left corner of tile (0, 0), and the size every tile is drawn at
+        void setPosition(glm::vec2 position);
+        void setTileSize(glm::vec2 tileSize);
+        void setColor(glm::vec4 color);
+
+        [[nodiscard]] glm::ivec2 getSize() const { return m_size; }
+        [[nodiscard]] glm::vec2 getPosition() const { return m_position; }
+        [[nodiscard]] glm::vec2 getTileSize() const { return m_tileSize; }
+        [[nodiscard]] uint32_t getTilesetSize() const { return static_cast<uint32_t>(m_tileUVs.size()); }
+
+    private:
+        friend class WompRenderer;
+
+        Tilemap(const WompRenderer& renderer, glm::ivec2 size, TextureHandle tileset, glm::ivec2 tilesetTileSize);
+
+        [[nodiscard]] uint32_t tileOffset(glm::ivec2 position) const;
+        // Inclusive range of chunks on each axis that overlap the rect from 0 to screenSize
+        [[nodiscard]] std::pair<glm::ivec2, glm::ivec2> getVisibleChunks(glm::vec2 screenSize) const;
+
+        glm::ivec2 m_size{};
+        glm::ivec2 m_chunkCount{};
+        glm::vec2 m_position{0.0f};
+        glm::vec2 m_tileSize{};
+        glm::vec4 m_color{1.0f};
+
+        // Chunk by chunk, row major inside a chunk, so every chunk is one contiguous range
+        std::vector<uint32_t> m_tiles{};
+        std::vector<std::pair<uint32_t, uint32_t>> m_dirtyRanges{};  // first, end inside each chunk, empty when first >= end
+        bool m_allDirty{true};
+        uint64_t m_revision{NextRevision()};  // Taken again by tile edits and by moving, resizing or tinting the map
+
+        TextureHandle m_texture{};              // Atlased tilesets resolve to their page
+        std::vector<glm::vec4> m_tileUVs{};     // UV rect of every tile of the tileset
+
+        // Kept alive by the renderer for every frame that reads them, like SpriteLayer's buffer
+        std::shared_ptr<Buffer> m_buffer{};
+        std::shared_ptr<Buffer> m_tileUVBuffer{};
+    };
+}
+
+#endif //TILEMAP_H
@@ -7,5 +7,6 @@
 // Rendering system
 #include <Womp/Renderer.h>
 #include <Womp/WompRenderer.h>
+#include <Womp/SpriteLayer.h>
 
 #endif //WOMP_H
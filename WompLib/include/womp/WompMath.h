@@ -1,6 +1,9 @@
 #ifndef WOMPMATH_H
 #define WOMPMATH_H
 
+#include <cstddef>
+#include <cstdint>
+
 #include <glm/glm.hpp>
 
 struct WP_Rect {
@@ -20,4 +23,26 @@ struct WP_Rect {
     }
 };
 
+// Clip space corners of a transformed sprite, in the corner order basic.vert uses:
+// (-1,-1), (1,-1), (1,1), (-1,1) before rotation
+struct WP_Quad {
+    glm::vec2 corners[4];
+};
+
+enum class WP_SimdLevel : uint8_t {
+    Scalar,
+    SSE2,
+    AVX2
+};
+
+// Widest instruction set the CPU supports, detected once
+WP_SimdLevel WP_GetSimdLevel();
+
+// Does what basic.vert does per vertex for a whole array of sprites: rects are dstRects (center xy,
+// half size zw), rotated around their center by rotations (radians) and mapped to clip space.
+// The SIMD paths use a polynomial sin/cos that loses precision for angles far outside [-pi, pi].
+void WP_TransformQuads(const glm::vec4* rects, const float* rotations, size_t count, glm::vec2 screenSize, WP_Quad* quads);
+// Same, but runs at most the given level, for comparing the paths
+void WP_TransformQuads(const glm::vec4* rects, const float* rotations, size_t count, glm::vec2 screenSize, WP_Quad* quads, WP_SimdLevel level);
+
 #endif //WOMPMATH_H
@@ -1,30 +1,46 @@
 #ifndef WOMPRENDERER_H
 #define WOMPRENDERER_H
 
+#include <array>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <unordered_set>
+
 #include "Renderer.h"
 #include "WompMath.h"
 #include "Descriptors/DescriptorPool.h"
 #include "Descriptors/DescriptorSetLayout.h"
 #include "glm/vec4.hpp"
+#include "Core/AtlasFile.h"
+#include "Core/FontFile.h"
+#include "Core/Ktx2File.h"
+#include "Core/RadixSort.h"
+#include "Core/TaskQueue.h"
+#include "Rendering/ComputePipeline.h"
+#include "Rendering/DrawQueue.h"
+#include "Rendering/ParallelRecorder.h"
+#include "Rendering/SpriteInstance.h"
+#include "Rendering/SpriteStream.h"
+#include "Rendering/TextLayout.h"
+#include "Rendering/UploadBatch.h"
 #include "Rendering/Pipeline.h"
+#include "Rendering/PipelineCache.h"
 #include "Rendering/Resources/Buffer.h"
+#include "Rendering/Resources/FrameRingAllocator.h"
+#include "Rendering/Resources/TextureAtlas.h"
+#include "ParticleEmitter.h"
+#include "SpriteLayer.h"
+#include "Tilemap.h"
 
 namespace womp {
+    using FontHandle = uint32_t;
 
     //Uniform setup
-    //Set 0, binding 0; screensize vec2
-    //set 1, binding 0; texture sampler
-
+    //Set 0, binding 0; texture sampler, or sampler2D[] indexed by texture slot when bindless
+    //Push constants; device addresses of the frame's FrameUniforms and SpriteInstance[] in the frame ring
 
-    using TextureHandle = uint32_t;
-
-    struct DrawCommand {
-        TextureHandle texture;
-        WP_Rect srcRect;
-        WP_Rect dstRect;
-        float rotation = 0.0f;
-        glm::vec4 color = glm::vec4(1.0f);
-    };
 
 
     struct Texture {
@@ -33,33 +49,319 @@ namespace womp {
         glm::ivec2 size{};                    // Width, height in pixels (optional)
     };
 
-    struct alignas(16) PushConstants {
-        glm::vec4 srcRect;  // x, y, width, height
-        glm::vec4 dstRect;
-        float rotation;
-        float _pad[3];
+    struct FrameUniforms {
+        glm::vec2 screenSize;
+        VkDeviceAddress clipRects;  // glm::vec4[], min xy and max xy in screen pixels, the first one unclipped
+    };
+
+    struct SpritePushConstants {
+        VkDeviceAddress instances;  // SpriteInstance[], indexed by gl_InstanceIndex
+        VkDeviceAddress frame;      // FrameUniforms
+        VkDeviceAddress quads;      // WP_Quad[] for pretransformed.vert, unused by basic.vert
+    };
+
+    struct TilemapPushConstants {
+        VkDeviceAddress chunk;      // Tile indices of the chunk drawn
+        VkDeviceAddress tileset;    // UV rect per tile of the tileset
+        VkDeviceAddress frame;      // FrameUniforms
+        glm::vec2 origin;           // Screen position of the chunk's lower left corner
         glm::vec4 color;
+        glm::vec2 tileSize;
+        uint32_t textureIndex;
+    };
+
+    struct CullPushConstants {
+        VkDeviceAddress instances;
+        VkDeviceAddress visibleInstances;
+        VkDeviceAddress indirectDraws;
+        VkDeviceAddress scanScratch;
+        glm::vec2 screenSize;
+        uint32_t instanceCount;
+        uint32_t pass;              // Which of cull.comp's three dispatches this is
+    };
+
+    struct RendererSettings {
+        bool bindlessTextures = true; // Ignored when the device lacks descriptor indexing
+        bool sortedSubmission = false;
+        bool gpuCulling = false;
+        bool cpuTransform = false;
+        bool textureAtlas = false;   // Pack small textures into shared pages, see createTexture
+        bool frameReplay = false;    // Reuse the recorded draws of unchanged frames, see setFrameReplay
+        uint32_t recordingThreads = 0; // Threads recording secondary command buffers, 0 or 1 records on the render thread only
+        uint32_t textureLoadThreads = 2; // Threads decoding createTextureAsync files, started on first use
+        std::string pipelineCachePath{};   // Empty keeps it in memory, a path is loaded at startup and written at shutdown
+    };
+
+    // Emitter settings of one particles.comp dispatch, std430 layout
+    struct ParticleUniforms {
+        glm::vec4 uvRect;
+        glm::vec4 startColor;
+        glm::vec4 endColor;
+        glm::vec2 position;
+        glm::vec2 spread;
+        glm::vec2 velocityMin;
+        glm::vec2 velocityMax;
+        glm::vec2 gravity;
+        float angularVelocityMax;
+        float lifetimeMin;
+        float lifetimeMax;
+        float startSize;
+        float endSize;
+        float deltaTime;
+        uint32_t spawnCount;
+        uint32_t capacity;
+        uint32_t seed;
+        uint32_t textureIndex;
+    };
+
+    struct ParticlePushConstants {
+        VkDeviceAddress source;             // Particles alive after the previous dispatch
+        VkDeviceAddress destination;        // Survivors and new particles, compacted
+        VkDeviceAddress sourceDraw;         // VkDrawIndirectCommand whose instanceCount is the source's particle count
+        VkDeviceAddress destinationDraw;
+        VkDeviceAddress instances;          // SpriteInstance per destination particle
+        VkDeviceAddress emitter;            // ParticleUniforms
+    };
+
+    struct FrameStats {
+        uint32_t sprites{};
+        uint32_t glyphs{};
+        uint32_t drawCalls{};
+        uint32_t stateChanges{};        // Descriptor/pipeline binds between draws
+        int32_t stateChangesRemoved{};  // Binds saved by sorting compared to submission order, negative if layers interleave
+        bool replayed{};                // Drawn by commands recorded for an earlier, identical frame
     };
 
     class WompRenderer {
     public:
-        explicit WompRenderer(Window& windowRef);
+        static constexpr size_t INITIAL_INSTANCE_CAPACITY = 1024;
+        static constexpr VkDeviceSize FRAME_RING_SIZE = 4 * 1024 * 1024;
+        static constexpr uint32_t MIN_INSTANCES_PER_RECORDING_JOB = 4096;
+        static constexpr uint32_t ATLAS_PAGE_SIZE = 2048;
+        static constexpr int ATLAS_MAX_TEXTURE_SIZE = 256;
+
+        explicit WompRenderer(Window& windowRef, const RendererSettings& settings = {});
         ~WompRenderer();
 
+        // Draw calls and setLayer may come from any thread, but must be finished before render() is called
         void drawTexture(TextureHandle image, WP_Rect srcRect, WP_Rect dstRect, glm::vec4 color = glm::vec4(1.0f));
         void drawTexture(TextureHandle image, WP_Rect srcRect, WP_Rect dstRect, float rotation, glm::vec4 color = glm::vec4(1.0f));
         void drawTexture(TextureHandle image, glm::vec2 position, glm::vec2 size, glm::vec4 color = glm::vec4(1.0f));
 
+        // Solid shapes antialiased in the fragment shader. They go through the same queue, layers and batches
+        // as textured draws without binding a texture. dstRect is a center and half size like drawTexture's.
+        void drawRect(WP_Rect dstRect, glm::vec4 color, float rotation = 0.0f);
+        // radius is clamped to the smaller half size
+        void drawRoundedRect(WP_Rect dstRect, float radius, glm::vec4 color, float rotation = 0.0f);
+        void drawCircle(glm::vec2 center, float radius, glm::vec4 color);
+        // Square ends exactly at from and to
+        void drawLine(glm::vec2 from, glm::vec2 to, float thickness, glm::vec4 color);
+
+        // Render thread only. Layers are drawn in call order, before the frame's other sprites,
+        // or after them when overlay is set. The layer must stay alive until render() is called.
+        [[nodiscard]] std::unique_ptr<SpriteLayer> createSpriteLayer() const;
+        void drawLayer(SpriteLayer& layer, bool overlay = false);
+
+        // Render thread only. tileSize is the size of a tile in the tileset texture, in pixels, and the size
+        // tiles are drawn at until Tilemap::setTileSize. Tilemaps are drawn in call order, before the sprite
+        // layers, or after the overlay layers when overlay is set. The tilemap must stay alive until render() is called.
+        [[nodiscard]] std::unique_ptr<Tilemap> createTilemap(glm::ivec2 size, TextureHandle tileset, glm::ivec2 tileSize) const;
+        void drawTilemap(Tilemap& tilemap, bool overlay = false);
+
+        // Render thread only. capacity is the most particles alive at once. Emitters are simulated when drawn
+        // and drawn in call order after the sprite layers of the same kind, background or overlay.
+        // The emitter must stay alive until render() is called.
+        [[nodiscard]] std::unique_ptr<ParticleEmitter> createParticleEmitter(uint32_t capacity, const ParticleEmitterSettings& settings) const;
+        void drawParticles(ParticleEmitter& emitter, bool overlay = false);
+
+        // Render thread only. Text is drawn after everything else, every glyph of the frame in one instanced
+        // draw when bindless. position is the start of the first baseline and size the em size in pixels.
+        // Strings are shaped once and reused while they keep being drawn, see TextLayoutCache.
+        void drawText(FontHandle font, std::string_view text, glm::vec2 position, float size, glm::vec4 color = glm::vec4(1.0f));
+        // Width of the widest line and height of all lines at size, zero for unknown fonts
+        [[nodiscard]] glm::vec2 measureText(FontHandle font, std::string_view text, float size);
 
         void render();
 
+        // Layers are drawn back to front. With sorted submission, a draw inside a layer moves back next to an
+        // earlier draw with the same pipeline and texture when it overlaps nothing submitted between them, so
+        // overlapping draws keep painter's order.
+        void setLayer(uint8_t layer) { m_drawQueue.setLayer(layer); }
+        // Blend mode of the calling thread's next draws, Alpha until set. Each mode is its own pipeline, so draws
+        // only batch with draws of the same mode; sorted submission groups them where painter's order allows.
+        void setBlendMode(BlendMode blendMode) { m_drawQueue.setBlendMode(blendMode); }
+        // Draws and text of the calling thread are clipped to the intersection of every pushed rect, a center and
+        // half size like drawTexture's dstRect. Clipping is per instance, draws under different clips still batch.
+        // Retained layers, tilemaps and particles are never clipped.
+        void pushClip(WP_Rect clipRect);
+        void popClip() { m_drawQueue.popClip(); }
+        // Draws of a thread with a lower order come first, see DrawQueue
+        void setSubmitOrder(uint32_t order) { m_drawQueue.setSubmitOrder(order); }
+        void setSortedSubmission(bool enabled) { m_sortedSubmission = enabled; }
+        [[nodiscard]] bool isSortedSubmission() const { return m_sortedSubmission; }
+
+        // Visibility is resolved by cull.comp and the batches are drawn indirectly,
+        // survivors are compacted in submission order
+        void setGpuCulling(bool enabled) { m_gpuCulling = enabled; }
+        [[nodiscard]] bool isGpuCulling() const { return m_gpuCulling; }
+
+        // Sprites are rotated and mapped to clip space by WP_TransformQuads and drawn with pretransformed.vert.
+        // Skipped while GPU culling, which moves instances, and for sprite layers, which keep their data on the GPU.
+        void setCpuTransform(bool enabled) { m_cpuTransform = enabled; }
+        [[nodiscard]] bool isCpuTransform() const { return m_cpuTransform; }
+
+        // Every frame hashes its draws, the layers it draws and their revisions, the extent and the texture
+        // generation. Once a frame matches the one before it, its draws are recorded into a secondary command
+        // buffer per frame in flight, reading a device local copy of its instances, and frames with that hash
+        // execute those instead of building and recording anything. Not used while GPU culling.
+        void setFrameReplay(bool enabled) { m_frameReplay = enabled; }
+        [[nodiscard]] bool isFrameReplay() const { return m_frameReplay; }
+
+        [[nodiscard]] const FrameStats& getFrameStats() const { return m_frameStats; }
+
         [[nodiscard]] VkPipelineLayout getPipelineLayout() const { return m_pipelineLayout; }
         [[nodiscard]] const std::vector<VkDescriptorSet>& getDescriptorSets() const { return m_textureDescriptorSets; }
 
-        TextureHandle createTexture(const std::string& filepath);
+        // Not safe to call while other threads are drawing. With the texture atlas enabled, textures up to
+        // ATLAS_MAX_TEXTURE_SIZE on both sides are packed into a shared page; the handle works the same,
+        // but sampling outside the source rect doesn't wrap. A mipmapped texture gets a full mip chain, generated
+        // on the GPU, for sprites drawn smaller than the file; it is never packed into the atlas. A .ktx2 file
+        // written by TextureEncoder is uploaded block compressed with its stored levels, mipmapped is ignored.
+        TextureHandle createTexture(const std::string& filepath, bool mipmapped = false);
+        // Returns without decoding anything. The file is decoded on a worker thread, submitted to the upload
+        // queue by a later render() and bound once the copy has finished; until then the handle draws a placeholder.
+        // The size is read from the file header up front. Sprite layers, tilemaps and particle emitters resolve
+        // a texture when it is set, so set them once isTextureReady. Never packed into the texture atlas.
+        // Not safe to call while other threads are drawing. mipmapped works like createTexture's.
+        TextureHandle createTextureAsync(const std::string& filepath, bool mipmapped = false);
+        // False while a createTextureAsync handle still draws the placeholder, and for unknown textures
+        [[nodiscard]] bool isTextureReady(TextureHandle texture) const;
+        // Loads a container written by AtlasBuilder. Its pages are copied from the mapped file into staging
+        // memory as they are, without decoding anything. Not safe to call while other threads are drawing.
+        void loadAtlas(const std::string& filepath);
+        // Handle of a sprite from a loaded atlas by its path inside the packed directory, 0 when there is none
+        [[nodiscard]] TextureHandle findTexture(std::string_view name) const;
+        // Zero for unknown textures
+        [[nodiscard]] glm::vec2 getTextureSize(TextureHandle texture) const;
+
+        // Loads a BMFont text file describing a pre-baked SDF or MSDF atlas and the atlas page it names, see FontFile.
+        // Not safe to call while other threads are drawing.
+        FontHandle loadFont(const std::string& filepath);
+
+        [[nodiscard]] bool isBindless() const { return m_bindless; }
 
         void waitIdle() const;
     private:
+        friend class SpriteLayer;
+        friend class Tilemap;
+        friend class ParticleEmitter;
+
+        // Per frame in flight output of cull.comp, the indirect draws live in the frame ring
+        struct CullingFrame {
+            std::unique_ptr<Buffer> visibleInstances{};
+            std::unique_ptr<Buffer> scanScratch{};      // A uint per instance and per workgroup of cull.comp
+        };
+
+        // Draws of an unchanged frame, recorded once per frame in flight and executed by every frame with the same hash
+        struct ReplayFrame {
+            VkCommandBuffer commandBuffer{};
+            uint64_t hash{};
+            bool recorded{false};
+            std::unique_ptr<Buffer> data{};     // FrameUniforms, then the instances, quads, glyphs and clip rects the commands read
+            std::vector<std::shared_ptr<Buffer>> layerBuffers{};
+            FrameStats stats{};
+        };
+
+        static constexpr VkDeviceSize INDIRECT_DRAWS_OFFSET = 16;   // uint drawCount + pad, then VkDrawIndirectCommand per batch
+        static constexpr uint32_t CULL_WORKGROUP_SIZE = 256;        // local_size_x of cull.comp
+        static constexpr VkDeviceSize REPLAY_DATA_ALIGNMENT = 256;
+        static constexpr VkDeviceSize PARTICLE_STRIDE = 32;     // Particle in particles.comp
+        static constexpr VkDeviceSize TEXTURE_UPLOAD_BUDGET = 32 * 1024 * 1024;  // Staging bytes per frame, past it uploads wait a frame
+        static constexpr const char* PLACEHOLDER_TEXTURE_PATH = "resources/TextureNotFound.png";
+
+        // Output of a createTextureAsync worker, pixels are null when neither the file nor the placeholder decoded.
+        // A .ktx2 file is mapped instead of decoded, its blocks are copied straight into staging memory.
+        struct DecodedTexture {
+            TextureHandle handle{};
+            glm::ivec2 size{};
+            bool mipmapped{};
+            std::unique_ptr<uint8_t, void (*)(void*)> pixels{nullptr, nullptr};
+            std::unique_ptr<Ktx2File> compressed{};
+        };
+
+        // Decoded textures whose copies are running on the upload queue, bound once they are done
+        struct TextureUpload {
+            std::unique_ptr<UploadBatch> batch;
+            std::vector<TextureHandle> handles{};
+            std::vector<std::unique_ptr<Image>> images{};
+        };
+
+        struct Font {
+            std::unique_ptr<FontFile> file;
+            TextureHandle texture;
+        };
+
+        // Hashed into the frame as is, the layout it draws is in m_textDrawLayouts at the same index
+        struct TextDraw {
+            uint64_t key;       // Text hashed with the font as seed, the layout cache key
+            FontHandle font;
+            float size;
+            glm::vec2 position;
+            glm::vec4 color;
+            glm::vec4 clip;     // min xy, max xy, UnclippedRect() when unclipped
+        };
+
+        // Handle to draw with and UVs to sample for a source rect of a texture, atlased textures resolve to their page
+        [[nodiscard]] std::pair<TextureHandle, glm::vec4> resolveSource(TextureHandle texture, const WP_Rect& srcRect) const;
+        // textureIndex the shaders sample a handle with, SHAPE_TEXTURE for handles without a texture
+        [[nodiscard]] uint32_t getTextureSlot(TextureHandle texture) const;
+
+        // Sprite pipeline variant, created the first time a mode is drawn
+        [[nodiscard]] const Pipeline& getSpritePipeline(BlendMode blendMode, bool pretransformed) const;
+
+        uint32_t buildBatches();
+        FrameAllocation transformQuads(uint32_t instanceCount);
+        void recordSprites(VkCommandBuffer commandBuffer, uint32_t firstInstance, uint32_t endInstance, bool culling, const SpritePushConstants& push) const;
+
+        void prepareLayer(VkCommandBuffer commandBuffer, int frameIndex, SpriteLayer& layer);
+        void rebuildLayerBatches(SpriteLayer& layer) const;
+        void recordLayers(VkCommandBuffer commandBuffer, const std::vector<SpriteLayer*>& layers, VkDeviceAddress frameUniforms) const;
+
+        [[nodiscard]] uint64_t hashFrame() const;
+        // Copies the frame's data out of the ring and records its draws into the replay frame, the caller executes it
+        void recordReplay(VkCommandBuffer commandBuffer, int frameIndex, uint64_t hash, const FrameUniforms& frameUniforms, uint32_t instanceCount, const FrameAllocation& quads, uint32_t glyphCount);
+        [[nodiscard]] VkCommandBufferInheritanceRenderingInfo getInheritanceRenderingInfo() const;
+
+        void prepareTilemap(VkCommandBuffer commandBuffer, int frameIndex, Tilemap& tilemap);
+        void recordTilemaps(VkCommandBuffer commandBuffer, const std::vector<Tilemap*>& tilemaps, VkDeviceAddress frameUniforms) const;
+
+        void simulateParticles(VkCommandBuffer commandBuffer, int frameIndex, ParticleEmitter& emitter);
+        void recordParticles(VkCommandBuffer commandBuffer, const std::vector<ParticleEmitter*>& emitters, VkDeviceAddress frameUniforms) const;
+
+        // Writes the glyphs of every text draw into the frame ring, batched by descriptor set
+        uint32_t buildTextBatches();
+        // Unclipped rect, the draws' clip rects and the text's, indexed by the instances' clipIndex
+        FrameAllocation writeClipRects();
+        void recordText(VkCommandBuffer commandBuffer, VkDeviceAddress glyphs, VkDeviceAddress frameUniforms) const;
+
+        void ensureCullingCapacity(int frameIndex, size_t instanceCount);
+        void recordCulling(VkCommandBuffer commandBuffer, int frameIndex, uint32_t instanceCount);
+        void recordIndirectDraws(VkCommandBuffer commandBuffer, uint32_t firstBatch, uint32_t batchCount) const;
+
+        // Gives image a handle and a descriptor set or bindless slot. owned is null for atlas pages, which the atlas keeps.
+        TextureHandle registerImage(Image& image, std::unique_ptr<Image> owned);
+        // Handle with a bindless slot of its own, for an image bound now or once it is uploaded
+        TextureHandle allocateHandle();
+        void bindImage(TextureHandle handle, Image& image, std::unique_ptr<Image> owned);
+        // Loaded on first use and uploaded right away, every pending handle draws it
+        TextureHandle getPlaceholderTexture();
+        // Binds uploads that have finished copying and submits the next decoded textures
+        void uploadDecodedTextures(int frameIndex);
+        std::optional<TextureHandle> createAtlasTexture(const std::string& filepath);
+        // Handle for a sub-rect of an atlas page, in texels
+        TextureHandle addAtlasTexture(uint32_t page, glm::ivec2 offset, glm::ivec2 size);
+        void ensureTextureTables(TextureHandle handle);
+
         Device* m_device;
         std::unique_ptr<Renderer> m_renderer;
 
@@ -70,21 +372,100 @@ namespace womp {
         std::unique_ptr<DescriptorSetLayout> m_textureDescriptorSetLayout{};
         std::unique_ptr<Image> m_dummyImage{};
 
-        std::vector<VkDescriptorSet> m_screenSizeDescriptorSets{};
-        std::unique_ptr<DescriptorSetLayout> m_screenSizeDescriptorSetLayout{};
-        std::vector<std::unique_ptr<Buffer>> m_screenSizeUniformBuffers{};
+        bool m_bindless{false};
+        std::unique_ptr<DescriptorPool> m_bindlessDescriptorPool{};
+        std::unique_ptr<DescriptorSetLayout> m_bindlessDescriptorSetLayout{};
+        VkDescriptorSet m_bindlessDescriptorSet{};
 
+        VkFormat m_colorFormat{};
+        std::unique_ptr<PipelineCache> m_pipelineCache{};
         VkPipelineLayout m_pipelineLayout{};
-        std::unique_ptr<Pipeline> m_pipeline;
+        PipelineKey m_spritePipelineKey{};
+        PipelineKey m_pretransformedPipelineKey{};
+        VkPipelineLayout m_tilemapPipelineLayout{};
+        const Pipeline* m_tilemapPipeline{};    // Owned by m_pipelineCache, like m_textPipeline
+        VkPipelineLayout m_particlePipelineLayout{};
+        std::unique_ptr<ComputePipeline> m_particlePipeline{};
+        const Pipeline* m_textPipeline{};
+
+        std::unique_ptr<FrameRingAllocator> m_frameRing{};
+        FrameAllocation m_instanceAllocation{};
+        FrameAllocation m_indirectAllocation{};
+        std::vector<SpriteBatch> m_batches{};
+
+        std::unique_ptr<ParallelRecorder> m_parallelRecorder{};
+
+        std::vector<SpriteLayer*> m_backgroundLayers{};
+        std::vector<SpriteLayer*> m_overlayLayers{};
+        std::vector<Tilemap*> m_backgroundTilemaps{};
+        std::vector<Tilemap*> m_overlayTilemaps{};
+        std::vector<ParticleEmitter*> m_backgroundEmitters{};
+        std::vector<ParticleEmitter*> m_overlayEmitters{};
+        // Layer, tilemap and particle buffers read by each frame in flight, released once that frame index comes around again
+        std::array<std::vector<std::shared_ptr<Buffer>>, Swapchain::MAX_FRAMES_IN_FLIGHT> m_frameLayerBuffers{};
 
-        std::unique_ptr<Buffer> m_vertexBuffer{};
-        std::unique_ptr<Buffer> m_indexBuffer{};
+        std::vector<Font> m_fonts{};     // Indexed by FontHandle - 1
+        TextLayoutCache m_textLayouts{};
+        std::vector<TextDraw> m_textDraws{};
+        std::vector<const TextLayout*> m_textDrawLayouts{};
+        FrameAllocation m_glyphAllocation{};
+        std::vector<SpriteBatch> m_textBatches{};
+        std::vector<glm::vec4> m_textClipRects{};
+        FrameAllocation m_clipAllocation{};
 
+        bool m_gpuCulling{false};
+        VkPipelineLayout m_cullPipelineLayout{};
+        std::unique_ptr<ComputePipeline> m_cullPipeline{};
+        std::vector<CullingFrame> m_cullingFrames{};
 
-        std::vector<DrawCommand> m_pendingDrawCommands;
+        bool m_cpuTransform{false};
+        std::vector<glm::vec4> m_sortedRects{};     // dstRects and rotations in sorted order, input of WP_TransformQuads
+        std::vector<float> m_sortedRotations{};
+
+        DrawQueue m_drawQueue{};
+        DrawStreams m_pendingDraws{};
+
+        bool m_sortedSubmission{false};
+        std::vector<SortItem> m_sortItems{};
+        std::vector<SortItem> m_sortScratch{};
+        std::vector<uint32_t> m_drawGroups{};
+        std::vector<DrawGroup> m_drawGroupScratch{};
+
+        FrameStats m_frameStats{};
+
+        bool m_frameReplay{false};
+        uint64_t m_previousFrameHash{};
+        VkCommandPool m_replayCommandPool{};
+        std::array<ReplayFrame, Swapchain::MAX_FRAMES_IN_FLIGHT> m_replayFrames{};
 
         std::unordered_map<TextureHandle, Texture> m_textures;
+        std::vector<glm::vec2> m_textureSizes{};        // Zero for handles without a texture
+        std::vector<VkDescriptorSet> m_textureSets{};
+        std::vector<TextureRegion> m_textureRegions{};
+        std::vector<uint32_t> m_textureSlots{};         // Bindless array index, the handle itself without bindless
         TextureHandle m_nextHandle = 1;
+        uint32_t m_nextTextureSlot = 1;     // Atlased textures share their page's slot, so handles can outnumber slots
+        uint64_t m_textureGeneration{};     // Bumped whenever a handle is added, part of the frame hash
+
+        // Sprites of a loaded atlas have consecutive handles in hash slot order
+        struct LoadedAtlas {
+            std::unique_ptr<AtlasFile> file;
+            TextureHandle firstSprite;
+        };
+
+        bool m_packTextures{false};
+        std::unique_ptr<TextureAtlas> m_atlas{};
+        std::vector<TextureHandle> m_atlasPageTextures{};   // Handle of each atlas page
+        std::vector<LoadedAtlas> m_loadedAtlases{};
+
+        uint32_t m_textureLoadThreads{};
+        std::unique_ptr<TaskQueue> m_textureLoader{};
+        std::mutex m_decodedTexturesMutex;
+        std::deque<DecodedTexture> m_decodedTextures{};     // Filled by the workers, emptied by render()
+        std::unordered_set<TextureHandle> m_pendingTextures{};
+        std::deque<TextureUpload> m_textureUploads{};       // Oldest first
+        std::array<std::vector<std::unique_ptr<UploadBatch>>, Swapchain::MAX_FRAMES_IN_FLIGHT> m_frameUploadBatches{};
+        TextureHandle m_placeholderTexture{};
     };
 }
 
@@ -1,36 +1,86 @@
 #version 450
+#extension GL_EXT_buffer_reference : require
 
-layout(location = 0) in vec3 inPosition;
-layout(location = 1) in vec2 inTexCoord;
+// Matches SpriteInstance
+struct SpriteInstance {
+    vec4 srcRect;   // xy = UV offset, zw = UV size
+    vec4 dstRect;   // xy = screen position (pixels), zw = half size (pixels)
+    vec4 color;
+    float rotation;
+    uint textureIndex;
+    uint batchIndex;
+    uint clipIndex;
+};
+
+layout(buffer_reference, std430, buffer_reference_align = 16) readonly buffer SpriteInstances {
+    SpriteInstance instances[];
+};
 
-layout(set = 0, binding = 0) uniform screenUniforms {
+layout(buffer_reference, std430, buffer_reference_align = 16) readonly buffer ClipRects {
+    vec4 rects[];   // min xy, max xy in screen pixels, rect 0 is unclipped
+};
+
+// Matches FrameUniforms
+layout(buffer_reference, std430, buffer_reference_align = 16) readonly buffer FrameUniforms {
     vec2 screenSize;
-} ubo;
+    ClipRects clipRects;
+};
 
-layout(push_constant) uniform PushConstants {
-    vec4 srcRect;   // xy = UV offset, zw = UV size
-    vec4 dstRect;   // xy = screen position (pixels), zw = size (pixels)
-    float rotation;
-    vec4 color;
-} push;
+layout(push_constant) uniform SpriteParams {
+    SpriteInstances sprites;
+    FrameUniforms frame;
+} params;
 
 layout(location = 0) out vec2 fragTexCoord;
+layout(location = 1) out vec4 fragColor;
+layout(location = 2) flat out uint fragTextureIndex;
+layout(location = 3) flat out vec3 fragShape;   // Half size and corner radius of a shape, in pixels
+
+// The clip rect is applied by the rasterizer, which cuts the quad at its edges
+out float gl_ClipDistance[4];
+
+// Matches SHAPE_TEXTURE
+const uint SHAPE_TEXTURE = 0;
+
+// Two triangles per quad, generated from gl_VertexIndex instead of a vertex buffer
+const vec2 CORNERS[4] = vec2[](
+    vec2(-1.0, -1.0),
+    vec2( 1.0, -1.0),
+    vec2( 1.0,  1.0),
+    vec2(-1.0,  1.0)
+);
+const uint INDICES[6] = uint[](0, 1, 2, 2, 3, 0);
 
 void main() {
-    vec2 localPos = inPosition.xy * push.dstRect.zw;
+    SpriteInstance sprite = params.sprites.instances[gl_InstanceIndex];
+    vec2 corner = CORNERS[INDICES[gl_VertexIndex]];
+
+    // Shapes get a pixel of margin for the antialiased edge, their coordinates are pixels from the center
+    bool shape = sprite.textureIndex == SHAPE_TEXTURE;
+    vec2 halfSize = abs(sprite.dstRect.zw);
+    vec2 localPos = shape ? corner * (halfSize + 1.0) : corner * sprite.dstRect.zw;
 
-    float c = cos(push.rotation);
-    float s = sin(push.rotation);
+    float c = cos(sprite.rotation);
+    float s = sin(sprite.rotation);
     mat2 rot = mat2(c, -s, s, c);
     vec2 rotatedPos = rot * localPos;
 
-    vec2 screenPos = push.dstRect.xy + rotatedPos;
+    vec2 screenPos = sprite.dstRect.xy + rotatedPos;
 
     // Normalize to NDC
-    vec2 clipPos = (screenPos / ubo.screenSize) * 2.0 - 1.0;
+    vec2 clipPos = (screenPos / params.frame.screenSize) * 2.0 - 1.0;
     clipPos.y = -clipPos.y; // Flip Y for Vulkan
 
     gl_Position = vec4(clipPos, 0.0, 1.0);
 
-    fragTexCoord = push.srcRect.xy + inTexCoord * push.srcRect.zw;
+    vec4 clip = params.frame.clipRects.rects[sprite.clipIndex];
+    gl_ClipDistance[0] = screenPos.x - clip.x;
+    gl_ClipDistance[1] = screenPos.y - clip.y;
+    gl_ClipDistance[2] = clip.z - screenPos.x;
+    gl_ClipDistance[3] = clip.w - screenPos.y;
+
+    fragTexCoord = shape ? localPos : sprite.srcRect.xy + (corner * 0.5 + 0.5) * sprite.srcRect.zw;
+    fragShape = vec3(halfSize, sprite.srcRect.x);
+    fragColor = sprite.color;
+    fragTextureIndex = sprite.textureIndex;
 }
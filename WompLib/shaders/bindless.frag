@@ -0,0 +1,45 @@
+#version 450
+#extension GL_EXT_nonuniform_qualifier : require
+
+// Every texture lives in one partially bound array, indexed by its slot, atlased textures share their page's
+layout(set = 0, binding = 0) uniform sampler2D textures[];
+
+layout(location = 0) in vec2 fragTexCoord;
+layout(location = 1) in vec4 fragColor;
+layout(location = 2) flat in uint fragTextureIndex;
+layout(location = 3) flat in vec3 fragShape;
+layout(location = 0) out vec4 outColor;
+
+// Matches SHAPE_TEXTURE
+const uint SHAPE_TEXTURE = 0;
+
+// The pipeline variant's BlendMode, set by PipelineCache
+layout(constant_id = 0) const uint BLEND_MODE = 0;
+const uint BLEND_MODE_MULTIPLY = 3;   // BlendMode::Multiply
+
+// Multiply blends as dst * src, fading the color to white by alpha makes a transparent texel leave dst as it was
+vec4 ApplyBlendMode(vec4 color) {
+    if (BLEND_MODE == BLEND_MODE_MULTIPLY) {
+        color.rgb = mix(vec3(1.0), color.rgb, color.a);
+    }
+    return color;
+}
+
+void main() {
+    if (fragTextureIndex == SHAPE_TEXTURE) {
+        // Signed distance to a rounded box in pixels, the edge ramps over the pixel around it
+        vec2 q = abs(fragTexCoord) - fragShape.xy + fragShape.z;
+        float distance = length(max(q, 0.0)) + min(max(q.x, q.y), 0.0) - fragShape.z;
+        float coverage = clamp(0.5 - distance, 0.0, 1.0);
+        if (coverage <= 0.0) {
+            discard;
+        }
+        outColor = ApplyBlendMode(vec4(fragColor.rgb, fragColor.a * coverage));
+        return;
+    }
+
+    // Vulkan textures typically have origin at top-left, so flip Y if needed
+    vec2 flippedUV = vec2(fragTexCoord.x, 1.0 - fragTexCoord.y);
+
+    outColor = ApplyBlendMode(texture(textures[nonuniformEXT(fragTextureIndex)], flippedUV) * fragColor);
+}
@@ -0,0 +1,83 @@
+#version 450
+#extension GL_EXT_buffer_reference : require
+
+// Matches SpriteInstance
+struct SpriteInstance {
+    vec4 srcRect;   // xy = UV offset, zw = UV size
+    vec4 dstRect;   // Already applied to the quads, only the half size of shapes is read
+    vec4 color;
+    float rotation;
+    uint textureIndex;
+    uint batchIndex;
+    uint clipIndex;
+};
+
+layout(buffer_reference, std430, buffer_reference_align = 16) readonly buffer SpriteInstances {
+    SpriteInstance instances[];
+};
+
+layout(buffer_reference, std430, buffer_reference_align = 16) readonly buffer ClipRects {
+    vec4 rects[];   // min xy, max xy in screen pixels, rect 0 is unclipped
+};
+
+// Matches FrameUniforms
+layout(buffer_reference, std430, buffer_reference_align = 16) readonly buffer FrameUniforms {
+    vec2 screenSize;
+    ClipRects clipRects;
+};
+
+// Matches WP_Quad, four clip space corners per sprite
+layout(buffer_reference, std430, buffer_reference_align = 8) readonly buffer SpriteQuads {
+    vec2 corners[];
+};
+
+layout(push_constant) uniform SpriteParams {
+    SpriteInstances sprites;
+    FrameUniforms frame;
+    SpriteQuads quads;
+} params;
+
+layout(location = 0) out vec2 fragTexCoord;
+layout(location = 1) out vec4 fragColor;
+layout(location = 2) flat out uint fragTextureIndex;
+layout(location = 3) flat out vec3 fragShape;
+
+// The clip rect is applied by the rasterizer, which cuts the quad at its edges
+out float gl_ClipDistance[4];
+
+// Matches SHAPE_TEXTURE
+const uint SHAPE_TEXTURE = 0;
+
+// Same corner order as basic.vert and WP_TransformQuads
+const vec2 CORNERS[4] = vec2[](
+    vec2(-1.0, -1.0),
+    vec2( 1.0, -1.0),
+    vec2( 1.0,  1.0),
+    vec2(-1.0,  1.0)
+);
+const uint INDICES[6] = uint[](0, 1, 2, 2, 3, 0);
+
+void main() {
+    SpriteInstance sprite = params.sprites.instances[gl_InstanceIndex];
+    uint cornerIndex = INDICES[gl_VertexIndex];
+
+    // Rotation and the NDC mapping were done on the CPU by WP_TransformQuads
+    gl_Position = vec4(params.quads.corners[gl_InstanceIndex * 4 + cornerIndex], 0.0, 1.0);
+
+    // Back from clip space to the screen pixels the clip rects are in
+    vec2 screenPos = vec2(gl_Position.x + 1.0, 1.0 - gl_Position.y) * 0.5 * params.frame.screenSize;
+    vec4 clip = params.frame.clipRects.rects[sprite.clipIndex];
+    gl_ClipDistance[0] = screenPos.x - clip.x;
+    gl_ClipDistance[1] = screenPos.y - clip.y;
+    gl_ClipDistance[2] = clip.z - screenPos.x;
+    gl_ClipDistance[3] = clip.w - screenPos.y;
+
+    // The quads have no margin for shapes, so their edges keep only the inner half of the antialiasing
+    vec2 halfSize = abs(sprite.dstRect.zw);
+    fragTexCoord = sprite.textureIndex == SHAPE_TEXTURE
+        ? CORNERS[cornerIndex] * halfSize
+        : sprite.srcRect.xy + (CORNERS[cornerIndex] * 0.5 + 0.5) * sprite.srcRect.zw;
+    fragShape = vec3(halfSize, sprite.srcRect.x);
+    fragColor = sprite.color;
+    fragTextureIndex = sprite.textureIndex;
+}
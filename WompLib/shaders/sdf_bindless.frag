@@ -0,0 +1,25 @@
+#version 450
+#extension GL_EXT_nonuniform_qualifier : require
+
+layout(set = 0, binding = 0) uniform sampler2D textures[];
+
+layout(location = 0) in vec2 fragTexCoord;
+layout(location = 1) in vec4 fragColor;
+layout(location = 2) flat in uint fragTextureIndex;
+layout(location = 3) flat in float fragScreenPxRange;
+layout(location = 4) flat in uint fragMsdf;
+layout(location = 0) out vec4 outColor;
+
+float median(float r, float g, float b) {
+    return max(min(r, g), min(max(r, g), b));
+}
+
+void main() {
+    vec4 distances = texture(textures[nonuniformEXT(fragTextureIndex)], vec2(fragTexCoord.x, 1.0 - fragTexCoord.y));
+
+    // 0.5 is the glyph's edge, the range maps the distance to screen pixels for a one pixel wide ramp
+    float distance = fragMsdf != 0 ? median(distances.r, distances.g, distances.b) : distances.a;
+    float opacity = clamp(max(fragScreenPxRange, 1.0) * (distance - 0.5) + 0.5, 0.0, 1.0);
+
+    outColor = vec4(fragColor.rgb, fragColor.a * opacity);
+}
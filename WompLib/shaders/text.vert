@@ -0,0 +1,75 @@
+#version 450
+#extension GL_EXT_buffer_reference : require
+
+// Matches GlyphInstance
+struct GlyphInstance {
+    vec4 srcRect;   // xy = UV offset, zw = UV size
+    vec4 dstRect;   // xy = screen position (pixels), zw = half size (pixels)
+    vec4 color;
+    float screenPxRange;
+    uint textureIndex;
+    uint msdf;
+    uint clipIndex;
+};
+
+layout(buffer_reference, std430, buffer_reference_align = 16) readonly buffer GlyphInstances {
+    GlyphInstance glyphs[];
+};
+
+layout(buffer_reference, std430, buffer_reference_align = 16) readonly buffer ClipRects {
+    vec4 rects[];   // min xy, max xy in screen pixels, rect 0 is unclipped
+};
+
+// Matches FrameUniforms
+layout(buffer_reference, std430, buffer_reference_align = 16) readonly buffer FrameUniforms {
+    vec2 screenSize;
+    ClipRects clipRects;
+};
+
+// Matches SpritePushConstants
+layout(push_constant) uniform TextParams {
+    GlyphInstances glyphs;
+    FrameUniforms frame;
+} params;
+
+layout(location = 0) out vec2 fragTexCoord;
+layout(location = 1) out vec4 fragColor;
+layout(location = 2) flat out uint fragTextureIndex;
+layout(location = 3) flat out float fragScreenPxRange;
+layout(location = 4) flat out uint fragMsdf;
+
+// The clip rect is applied by the rasterizer, which cuts the quad at its edges
+out float gl_ClipDistance[4];
+
+const vec2 CORNERS[4] = vec2[](
+    vec2(-1.0, -1.0),
+    vec2( 1.0, -1.0),
+    vec2( 1.0,  1.0),
+    vec2(-1.0,  1.0)
+);
+const uint INDICES[6] = uint[](0, 1, 2, 2, 3, 0);
+
+void main() {
+    GlyphInstance glyph = params.glyphs.glyphs[gl_InstanceIndex];
+    vec2 corner = CORNERS[INDICES[gl_VertexIndex]];
+
+    // Glyphs are never rotated
+    vec2 screenPos = glyph.dstRect.xy + corner * glyph.dstRect.zw;
+
+    vec2 clipPos = (screenPos / params.frame.screenSize) * 2.0 - 1.0;
+    clipPos.y = -clipPos.y; // Flip Y for Vulkan
+
+    gl_Position = vec4(clipPos, 0.0, 1.0);
+
+    vec4 clip = params.frame.clipRects.rects[glyph.clipIndex];
+    gl_ClipDistance[0] = screenPos.x - clip.x;
+    gl_ClipDistance[1] = screenPos.y - clip.y;
+    gl_ClipDistance[2] = clip.z - screenPos.x;
+    gl_ClipDistance[3] = clip.w - screenPos.y;
+
+    fragTexCoord = glyph.srcRect.xy + (corner * 0.5 + 0.5) * glyph.srcRect.zw;
+    fragColor = glyph.color;
+    fragTextureIndex = glyph.textureIndex;
+    fragScreenPxRange = glyph.screenPxRange;
+    fragMsdf = glyph.msdf;
+}
@@ -0,0 +1,69 @@
+#version 450
+#extension GL_EXT_buffer_reference : require
+
+// Matches Tilemap::CHUNK_SIZE and EMPTY_TILE
+const uint CHUNK_SIZE = 32;
+const uint EMPTY_TILE = 0xFFFFFFFFu;
+
+layout(buffer_reference, std430, buffer_reference_align = 4) readonly buffer TileIndices {
+    uint tiles[];   // One chunk, row major
+};
+
+layout(buffer_reference, std430, buffer_reference_align = 16) readonly buffer TileUVs {
+    vec4 uvs[];     // xy = UV offset, zw = UV size, per tile of the tileset
+};
+
+// Matches FrameUniforms
+layout(buffer_reference, std430, buffer_reference_align = 16) readonly buffer FrameUniforms {
+    vec2 screenSize;
+};
+
+// Matches TilemapPushConstants
+layout(push_constant) uniform TilemapParams {
+    TileIndices chunk;
+    TileUVs tileset;
+    FrameUniforms frame;
+    vec2 origin;        // Screen position of the chunk's lower left corner
+    vec4 color;
+    vec2 tileSize;
+    uint textureIndex;
+} params;
+
+layout(location = 0) out vec2 fragTexCoord;
+layout(location = 1) out vec4 fragColor;
+layout(location = 2) flat out uint fragTextureIndex;
+layout(location = 3) flat out vec3 fragShape;   // Tiles are never shapes
+
+// Same corners as basic.vert
+const vec2 CORNERS[4] = vec2[](
+    vec2(-1.0, -1.0),
+    vec2( 1.0, -1.0),
+    vec2( 1.0,  1.0),
+    vec2(-1.0,  1.0)
+);
+const uint INDICES[6] = uint[](0, 1, 2, 2, 3, 0);
+
+void main() {
+    uint cellIndex = uint(gl_InstanceIndex);
+    uint tile = params.chunk.tiles[cellIndex];
+    if (tile == EMPTY_TILE) {
+        // Every vertex in the same spot, the quad has no area and rasterizes nothing
+        gl_Position = vec4(0.0);
+        return;
+    }
+
+    vec2 corner = CORNERS[INDICES[gl_VertexIndex]] * 0.5 + 0.5;
+    vec2 cell = vec2(cellIndex % CHUNK_SIZE, cellIndex / CHUNK_SIZE);
+    vec2 screenPos = params.origin + (cell + corner) * params.tileSize;
+
+    vec2 clipPos = (screenPos / params.frame.screenSize) * 2.0 - 1.0;
+    clipPos.y = -clipPos.y; // Flip Y for Vulkan
+
+    gl_Position = vec4(clipPos, 0.0, 1.0);
+
+    vec4 uv = params.tileset.uvs[tile];
+    fragTexCoord = uv.xy + corner * uv.zw;
+    fragColor = params.color;
+    fragTextureIndex = params.textureIndex;
+    fragShape = vec3(0.0);
+}
@@ -0,0 +1,82 @@
+#include "AtlasFile.h"
+
+#include <stdexcept>
+
+namespace womp {
+    AtlasFile::AtlasFile(const std::string& path): m_file{std::make_unique<MappedFile>(path)} {
+        const uint8_t* data = m_file->data();
+        const uint64_t size = m_file->size();
+
+        if (size < sizeof(AtlasFileHeader)) {
+            throw std::runtime_error("Not an atlas file: " + path);
+        }
+        std::memcpy(&m_header, data, sizeof(AtlasFileHeader));
+
+        if (std::memcmp(m_header.magic, ATLAS_FILE_MAGIC, sizeof(ATLAS_FILE_MAGIC)) != 0) {
+            throw std::runtime_error("Not an atlas file: " + path);
+        }
+        if (m_header.version != ATLAS_FILE_VERSION) {
+            throw std::runtime_error("Unsupported atlas file version " + std::to_string(m_header.version) + ": " + path);
+        }
+
+        // Every table has to lie inside the file before anything points into it. Sizes are compared by dividing,
+        // so no product of header fields can wrap around.
+        const auto fits = [size](uint64_t offset, uint64_t bytes) {
+            return offset <= size && bytes <= size - offset;
+        };
+        const auto fitsArray = [size](uint64_t offset, uint64_t count, uint64_t elementBytes) {
+            return offset <= size && (elementBytes == 0 || count <= (size - offset) / elementBytes);
+        };
+        const uint64_t pageSize = m_header.pageSize;
+        if (pageSize != 0 && pageSize > size / pageSize / 4) {
+            throw std::runtime_error("Truncated atlas file: " + path);
+        }
+        const uint64_t pageBytes = pageSize * pageSize * 4;
+        if (!fitsArray(m_header.pagesOffset, m_header.pageCount, pageBytes) ||
+            !fits(m_header.spritesOffset, static_cast<uint64_t>(m_header.spriteCount) * sizeof(AtlasFileSprite)) ||
+            !fits(m_header.seedsOffset, static_cast<uint64_t>(m_header.spriteCount) * sizeof(int32_t)) ||
+            m_header.spritesOffset % alignof(AtlasFileSprite) != 0 || m_header.seedsOffset % alignof(int32_t) != 0 ||
+            m_header.namesOffset > size) {
+            throw std::runtime_error("Truncated atlas file: " + path);
+        }
+
+        m_sprites = reinterpret_cast<const AtlasFileSprite*>(data + m_header.spritesOffset);
+        m_seeds = reinterpret_cast<const int32_t*>(data + m_header.seedsOffset);
+        m_names = reinterpret_cast<const char*>(data + m_header.namesOffset);
+
+        for (uint32_t i = 0; i < m_header.spriteCount; ++i) {
+            const AtlasFileSprite& sprite = m_sprites[i];
+            if (sprite.page >= m_header.pageCount || static_cast<uint64_t>(sprite.x) + sprite.width > pageSize ||
+                static_cast<uint64_t>(sprite.y) + sprite.height > pageSize ||
+                !fits(m_header.namesOffset + sprite.nameOffset, sprite.nameLength)) {
+                throw std::runtime_error("Corrupt sprite table in atlas file: " + path);
+            }
+        }
+    }
+
+    const uint8_t* AtlasFile::getPagePixels(uint32_t page) const {
+        return m_file->data() + m_header.pagesOffset + static_cast<uint64_t>(page) * m_header.pageSize * m_header.pageSize * 4;
+    }
+
+    std::string_view AtlasFile::getSpriteName(uint32_t slot) const {
+        return {m_names + m_sprites[slot].nameOffset, m_sprites[slot].nameLength};
+    }
+
+    std::optional<uint32_t> AtlasFile::find(std::string_view name) const {
+        const uint32_t count = m_header.spriteCount;
+        if (count == 0) {
+            return std::nullopt;
+        }
+
+        // Buckets holding one name store its slot directly as -slot - 1, others a seed that spreads them out.
+        // ~seed is -seed - 1 without overflowing on a corrupt INT32_MIN.
+        const int32_t seed = m_seeds[AtlasNameHash(name, 0) % count];
+        const uint32_t slot = seed < 0 ? static_cast<uint32_t>(~seed) : AtlasNameHash(name, static_cast<uint32_t>(seed)) % count;
+
+        // Names that were never packed still hash to some slot
+        if (slot >= count || getSpriteName(slot) != name) {
+            return std::nullopt;
+        }
+        return slot;
+    }
+}
@@ -0,0 +1,110 @@
+#ifndef ATLASFILE_H
+#define ATLASFILE_H
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include <glm/glm.hpp>
+
+#include "MappedFile.h"
+
+namespace womp {
+    // Container written by AtlasBuilder, read in place from a mapped file. Little endian, laid out as
+    // header, pages, sprites, seeds, names. Offsets are from the start of the file.
+    constexpr char ATLAS_FILE_MAGIC[4] = {'W', 'A', 'T', 'L'};
+    constexpr uint32_t ATLAS_FILE_VERSION = 1;
+    constexpr uint64_t ATLAS_FILE_PAGE_ALIGNMENT = 4096;
+    // Border texels repeating the edge of every sprite, so linear filtering never reaches a neighbour
+    constexpr int ATLAS_SPRITE_PADDING = 1;
+
+    struct AtlasFileHeader {
+        char magic[4];
+        uint32_t version;
+        uint32_t pageSize;      // Pages are square, tightly packed RGBA8 sRGB
+        uint32_t pageCount;
+        uint32_t spriteCount;
+        uint32_t reserved;
+        uint64_t pagesOffset;   // Aligned to ATLAS_FILE_PAGE_ALIGNMENT
+        uint64_t spritesOffset; // AtlasFileSprite[spriteCount], indexed by perfect hash slot
+        uint64_t seedsOffset;   // int32_t[spriteCount], per hash bucket, see AtlasFile::find
+        uint64_t namesOffset;   // Sprite names, not terminated
+    };
+    static_assert(sizeof(AtlasFileHeader) == 56);
+
+    struct AtlasFileSprite {
+        uint32_t page;
+        uint32_t nameOffset;    // From namesOffset
+        uint32_t nameLength;
+        uint32_t x;             // Texel rect of the sprite inside its padding
+        uint32_t y;
+        uint32_t width;
+        uint32_t height;
+    };
+    static_assert(sizeof(AtlasFileSprite) == 28);
+
+    // FNV-1a with the basis perturbed by seed, shared by AtlasBuilder and the lookup. The murmur
+    // finalizer mixes the high bits down, plain FNV low bits barely depend on the seed.
+    inline uint32_t AtlasNameHash(std::string_view name, uint32_t seed) {
+        uint32_t hash = 0x811C9DC5u ^ (seed * 0x9E3779B9u);
+        for (const char c: name) {
+            hash = (hash ^ static_cast<uint8_t>(c)) * 0x01000193u;
+        }
+        hash ^= hash >> 16;
+        hash *= 0x85EBCA6Bu;
+        hash ^= hash >> 13;
+        hash *= 0xC2B2AE35u;
+        hash ^= hash >> 16;
+        return hash;
+    }
+
+    // Copies tightly packed RGBA8 pixels into destination with a border of padding texels that
+    // repeat the nearest edge texel. destination points at the top left of the border.
+    inline void CopyWithBorder(const uint8_t* pixels, glm::ivec2 size, int padding, uint8_t* destination, size_t destinationStride) {
+        for (int y = 0; y < size.y + padding * 2; ++y) {
+            const int sourceY = y < padding ? 0 : (y - padding >= size.y ? size.y - 1 : y - padding);
+            const uint8_t* sourceRow = pixels + static_cast<size_t>(sourceY) * size.x * 4;
+            uint8_t* row = destination + static_cast<size_t>(y) * destinationStride;
+
+            for (int x = 0; x < padding; ++x) {
+                std::memcpy(row + x * 4, sourceRow, 4);
+                std::memcpy(row + (padding + size.x + x) * 4, sourceRow + (size.x - 1) * 4, 4);
+            }
+            std::memcpy(row + padding * 4, sourceRow, static_cast<size_t>(size.x) * 4);
+        }
+    }
+
+    // Maps an atlas container and validates its tables, the pixels are only touched when read
+    class AtlasFile {
+    public:
+        explicit AtlasFile(const std::string& path);
+
+        AtlasFile(const AtlasFile& other) = delete;
+        AtlasFile(AtlasFile&& other) noexcept = delete;
+        AtlasFile& operator=(const AtlasFile& other) = delete;
+        AtlasFile& operator=(AtlasFile&& other) noexcept = delete;
+
+        [[nodiscard]] uint32_t getPageSize() const { return m_header.pageSize; }
+        [[nodiscard]] uint32_t getPageCount() const { return m_header.pageCount; }
+        [[nodiscard]] const uint8_t* getPagePixels(uint32_t page) const;
+
+        [[nodiscard]] uint32_t getSpriteCount() const { return m_header.spriteCount; }
+        [[nodiscard]] const AtlasFileSprite& getSprite(uint32_t slot) const { return m_sprites[slot]; }
+        [[nodiscard]] std::string_view getSpriteName(uint32_t slot) const;
+
+        // Slot of the sprite with this name, one hash to find the bucket seed and one to find the slot
+        [[nodiscard]] std::optional<uint32_t> find(std::string_view name) const;
+
+    private:
+        std::unique_ptr<MappedFile> m_file;
+        AtlasFileHeader m_header{};
+        const AtlasFileSprite* m_sprites{};
+        const int32_t* m_seeds{};
+        const char* m_names{};
+    };
+}
+
+#endif //ATLASFILE_H
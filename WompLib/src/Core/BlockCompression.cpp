@@ -0,0 +1,445 @@
+#include "BlockCompression.h"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <string>
+
+namespace {
+    constexpr int BLOCK_SIZE = 4;
+    constexpr int BLOCK_TEXELS = BLOCK_SIZE * BLOCK_SIZE;
+
+    // vkFormat values, the Core files don't pull in Vulkan
+    constexpr uint32_t FORMAT_BC1_RGBA_UNORM = 133;
+    constexpr uint32_t FORMAT_BC1_RGBA_SRGB = 134;
+    constexpr uint32_t FORMAT_BC3_UNORM = 137;
+    constexpr uint32_t FORMAT_BC3_SRGB = 138;
+    constexpr uint32_t FORMAT_BC7_UNORM = 145;
+    constexpr uint32_t FORMAT_BC7_SRGB = 146;
+
+    constexpr std::array<int, 16> BC7_WEIGHTS{0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+    glm::vec4 Texel(const uint8_t* texels, int i) {
+        return glm::vec4(texels[i * 4], texels[i * 4 + 1], texels[i * 4 + 2], texels[i * 4 + 3]);
+    }
+
+    float DistanceSquared(glm::vec4 a, glm::vec4 b) {
+        const glm::vec4 d = a - b;
+        return glm::dot(d, d);
+    }
+
+    // Ends of the line through the texels' mean along their principal axis, over the channels in mask.
+    // Texels whose bit in skip is set are left out.
+    void FitEndpoints(const uint8_t* texels, glm::vec4 mask, uint32_t skip, glm::vec4& low, glm::vec4& high) {
+        glm::vec4 mean(0.0f);
+        glm::vec4 minimum(255.0f);
+        glm::vec4 maximum(0.0f);
+        int count = 0;
+        for (int i = 0; i < BLOCK_TEXELS; ++i) {
+            if (skip & (1u << i)) continue;
+            const glm::vec4 texel = Texel(texels, i) * mask;
+            mean += texel;
+            minimum = glm::min(minimum, texel);
+            maximum = glm::max(maximum, texel);
+            ++count;
+        }
+        if (count == 0) {
+            low = high = glm::vec4(0.0f);
+            return;
+        }
+        mean /= static_cast<float>(count);
+
+        glm::mat4 covariance(0.0f);
+        for (int i = 0; i < BLOCK_TEXELS; ++i) {
+            if (skip & (1u << i)) continue;
+            const glm::vec4 d = Texel(texels, i) * mask - mean;
+            covariance += glm::outerProduct(d, d);
+        }
+
+        // Power iteration from the bounding box diagonal, which is close already for most blocks
+        glm::vec4 axis = maximum - minimum;
+        for (int iteration = 0; iteration < 8 && glm::dot(axis, axis) > 0.0f; ++iteration) {
+            axis = covariance * axis;
+            const float length = glm::length(axis);
+            if (length < 1e-6f) break;
+            axis /= length;
+        }
+        if (glm::dot(axis, axis) < 1e-12f) {
+            low = high = mean;
+            return;
+        }
+        axis = glm::normalize(axis);
+
+        float lowProjection = 0.0f;
+        float highProjection = 0.0f;
+        for (int i = 0; i < BLOCK_TEXELS; ++i) {
+            if (skip & (1u << i)) continue;
+            const float projection = glm::dot(Texel(texels, i) * mask - mean, axis);
+            lowProjection = std::min(lowProjection, projection);
+            highProjection = std::max(highProjection, projection);
+        }
+        low = glm::clamp(mean + axis * lowProjection, glm::vec4(0.0f), glm::vec4(255.0f));
+        high = glm::clamp(mean + axis * highProjection, glm::vec4(0.0f), glm::vec4(255.0f));
+    }
+
+    uint16_t To565(glm::vec4 color) {
+        const auto r = static_cast<uint16_t>(std::lround(color.r * 31.0f / 255.0f));
+        const auto g = static_cast<uint16_t>(std::lround(color.g * 63.0f / 255.0f));
+        const auto b = static_cast<uint16_t>(std::lround(color.b * 31.0f / 255.0f));
+        return static_cast<uint16_t>(r << 11 | g << 5 | b);
+    }
+
+    glm::vec4 From565(uint16_t color) {
+        const uint32_t r = color >> 11 & 31;
+        const uint32_t g = color >> 5 & 63;
+        const uint32_t b = color & 31;
+        return glm::vec4(r << 3 | r >> 2, g << 2 | g >> 4, b << 3 | b >> 2, 0.0f);
+    }
+
+    // The BC1 layout, also the color half of BC3. Without allowTransparent the block always decodes
+    // in four color mode, which BC3 requires.
+    void EncodeColorBlock(const uint8_t* texels, uint8_t* block, bool allowTransparent) {
+        const glm::vec4 RGB(1.0f, 1.0f, 1.0f, 0.0f);
+
+        uint32_t transparent = 0;
+        if (allowTransparent) {
+            for (int i = 0; i < BLOCK_TEXELS; ++i) {
+                if (texels[i * 4 + 3] < 128) transparent |= 1u << i;
+            }
+        }
+
+        glm::vec4 low, high;
+        FitEndpoints(texels, RGB, transparent, low, high);
+        uint16_t color0 = To565(high);
+        uint16_t color1 = To565(low);
+
+        // color0 > color1 selects four colors, color0 <= color1 three and transparent black
+        const bool threeColor = transparent != 0;
+        if (threeColor ? color0 > color1 : color0 < color1) {
+            std::swap(color0, color1);
+        }
+
+        std::array<glm::vec4, 4> palette{From565(color0), From565(color1)};
+        int paletteSize = 4;
+        if (threeColor) {
+            palette[2] = (palette[0] + palette[1]) / 2.0f;
+            paletteSize = 3;
+        } else {
+            palette[2] = (palette[0] * 2.0f + palette[1]) / 3.0f;
+            palette[3] = (palette[0] + palette[1] * 2.0f) / 3.0f;
+        }
+
+        uint32_t indices = 0;
+        for (int i = 0; i < BLOCK_TEXELS; ++i) {
+            uint32_t best = 3;
+            if (!(transparent & (1u << i))) {
+                const glm::vec4 texel = Texel(texels, i) * RGB;
+                float bestDistance = DistanceSquared(texel, palette[0]);
+                best = 0;
+                for (int entry = 1; entry < paletteSize; ++entry) {
+                    const float distance = DistanceSquared(texel, palette[entry]);
+                    if (distance < bestDistance) {
+                        bestDistance = distance;
+                        best = entry;
+                    }
+                }
+            }
+            indices |= best << (i * 2);
+        }
+
+        std::memcpy(block, &color0, 2);
+        std::memcpy(block + 2, &color1, 2);
+        std::memcpy(block + 4, &indices, 4);
+    }
+
+    void EncodeAlphaBlock(const uint8_t* texels, uint8_t* block) {
+        uint8_t minimum = 255;
+        uint8_t maximum = 0;
+        for (int i = 0; i < BLOCK_TEXELS; ++i) {
+            minimum = std::min(minimum, texels[i * 4 + 3]);
+            maximum = std::max(maximum, texels[i * 4 + 3]);
+        }
+
+        // alpha0 > alpha1 selects six interpolated values between them
+        std::array<int, 8> palette{maximum, minimum};
+        for (int i = 1; i < 7; ++i) {
+            palette[i + 1] = ((7 - i) * maximum + i * minimum) / 7;
+        }
+
+        uint64_t indices = 0;
+        if (maximum != minimum) {
+            for (int i = 0; i < BLOCK_TEXELS; ++i) {
+                const int alpha = texels[i * 4 + 3];
+                uint64_t best = 0;
+                for (uint64_t entry = 1; entry < palette.size(); ++entry) {
+                    if (std::abs(alpha - palette[entry]) < std::abs(alpha - palette[best])) {
+                        best = entry;
+                    }
+                }
+                indices |= best << (i * 3);
+            }
+        }
+
+        block[0] = maximum;
+        block[1] = minimum;
+        for (int i = 0; i < 6; ++i) {
+            block[2 + i] = static_cast<uint8_t>(indices >> (i * 8));
+        }
+    }
+
+    // Appends fields from the least significant bit of the block up, the order BC7 is laid out in
+    class BitWriter {
+    public:
+        explicit BitWriter(uint8_t* block): m_block{block} {
+            std::memset(block, 0, 16);
+        }
+
+        void write(uint32_t value, int bits) {
+            for (int i = 0; i < bits; ++i, ++m_position) {
+                m_block[m_position / 8] |= static_cast<uint8_t>((value >> i & 1) << (m_position % 8));
+            }
+        }
+
+    private:
+        uint8_t* m_block;
+        int m_position{0};
+    };
+
+    // Best 7 bit value and shared bit for an endpoint, the decoded channel is value << 1 | bit.
+    // An opaque endpoint keeps the set bit, 254 alpha would make opaque sprites blend.
+    void QuantizeBC7Endpoint(glm::vec4 endpoint, std::array<uint32_t, 4>& value, uint32_t& bit) {
+        float bestError = std::numeric_limits<float>::max();
+        for (uint32_t candidate = endpoint.a >= 254.5f ? 1 : 0; candidate < 2; ++candidate) {
+            std::array<uint32_t, 4> quantized{};
+            float error = 0.0f;
+            for (int c = 0; c < 4; ++c) {
+                quantized[c] = static_cast<uint32_t>(std::clamp(std::lround((endpoint[c] - static_cast<float>(candidate)) / 2.0f), 0l, 127l));
+                const float decoded = static_cast<float>(quantized[c] << 1 | candidate);
+                error += (decoded - endpoint[c]) * (decoded - endpoint[c]);
+            }
+            if (error < bestError) {
+                bestError = error;
+                value = quantized;
+                bit = candidate;
+            }
+        }
+    }
+
+    float SrgbToLinear(uint8_t value) {
+        const float c = static_cast<float>(value) / 255.0f;
+        return c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+    }
+
+    uint8_t LinearToSrgb(float value) {
+        const float c = value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+        return static_cast<uint8_t>(std::clamp(std::lround(c * 255.0f), 0l, 255l));
+    }
+}
+
+namespace womp {
+    uint32_t GetBlockBytes(BlockFormat format) {
+        return format == BlockFormat::BC1 ? 8 : 16;
+    }
+
+    uint64_t GetCompressedSize(BlockFormat format, glm::ivec2 size) {
+        const uint64_t blocksX = (static_cast<uint64_t>(size.x) + BLOCK_SIZE - 1) / BLOCK_SIZE;
+        const uint64_t blocksY = (static_cast<uint64_t>(size.y) + BLOCK_SIZE - 1) / BLOCK_SIZE;
+        return blocksX * blocksY * GetBlockBytes(format);
+    }
+
+    uint32_t GetVkFormat(BlockFormat format) {
+        switch (format) {
+            case BlockFormat::BC1: return FORMAT_BC1_RGBA_SRGB;
+            case BlockFormat::BC3: return FORMAT_BC3_SRGB;
+            case BlockFormat::BC7: return FORMAT_BC7_SRGB;
+        }
+        return 0;
+    }
+
+    std::optional<BlockFormat> GetBlockFormat(uint32_t vkFormat) {
+        switch (vkFormat) {
+            case FORMAT_BC1_RGBA_UNORM:
+            case FORMAT_BC1_RGBA_SRGB:
+                return BlockFormat::BC1;
+            case FORMAT_BC3_UNORM:
+            case FORMAT_BC3_SRGB:
+                return BlockFormat::BC3;
+            case FORMAT_BC7_UNORM:
+            case FORMAT_BC7_SRGB:
+                return BlockFormat::BC7;
+            default:
+                return std::nullopt;
+        }
+    }
+
+    std::optional<BlockFormat> ParseBlockFormat(std::string_view name) {
+        if (name == "bc1") return BlockFormat::BC1;
+        if (name == "bc3") return BlockFormat::BC3;
+        if (name == "bc7") return BlockFormat::BC7;
+        return std::nullopt;
+    }
+
+    BlockFormat ChooseBlockFormat(const uint8_t* pixels, glm::ivec2 size) {
+        const size_t count = static_cast<size_t>(size.x) * size.y;
+        for (size_t i = 0; i < count; ++i) {
+            if (pixels[i * 4 + 3] != 255) {
+                return BlockFormat::BC7;
+            }
+        }
+        return BlockFormat::BC1;
+    }
+
+    void EncodeBC1Block(const uint8_t* texels, uint8_t* block) {
+        EncodeColorBlock(texels, block, true);
+    }
+
+    void EncodeBC3Block(const uint8_t* texels, uint8_t* block) {
+        EncodeAlphaBlock(texels, block);
+        EncodeColorBlock(texels, block + 8, false);
+    }
+
+    void EncodeBC7Block(const uint8_t* texels, uint8_t* block) {
+        glm::vec4 low, high;
+        FitEndpoints(texels, glm::vec4(1.0f), 0, low, high);
+
+        std::array<std::array<uint32_t, 4>, 2> endpoints{};
+        std::array<uint32_t, 2> bits{};
+        QuantizeBC7Endpoint(low, endpoints[0], bits[0]);
+        QuantizeBC7Endpoint(high, endpoints[1], bits[1]);
+
+        std::array<glm::vec4, 16> palette{};
+        for (size_t entry = 0; entry < palette.size(); ++entry) {
+            for (int c = 0; c < 4; ++c) {
+                const int e0 = static_cast<int>(endpoints[0][c] << 1 | bits[0]);
+                const int e1 = static_cast<int>(endpoints[1][c] << 1 | bits[1]);
+                palette[entry][c] = static_cast<float>(((64 - BC7_WEIGHTS[entry]) * e0 + BC7_WEIGHTS[entry] * e1 + 32) >> 6);
+            }
+        }
+
+        std::array<uint32_t, BLOCK_TEXELS> indices{};
+        for (int i = 0; i < BLOCK_TEXELS; ++i) {
+            const glm::vec4 texel = Texel(texels, i);
+            float bestDistance = DistanceSquared(texel, palette[0]);
+            for (uint32_t entry = 1; entry < palette.size(); ++entry) {
+                const float distance = DistanceSquared(texel, palette[entry]);
+                if (distance < bestDistance) {
+                    bestDistance = distance;
+                    indices[i] = entry;
+                }
+            }
+        }
+
+        // The first index is stored without its top bit, swapping the endpoints clears it
+        if (indices[0] >= 8) {
+            std::swap(endpoints[0], endpoints[1]);
+            std::swap(bits[0], bits[1]);
+            for (uint32_t& index: indices) {
+                index = 15 - index;
+            }
+        }
+
+        BitWriter writer(block);
+        writer.write(1u << 6, 7);
+        for (int c = 0; c < 4; ++c) {
+            writer.write(endpoints[0][c], 7);
+            writer.write(endpoints[1][c], 7);
+        }
+        writer.write(bits[0], 1);
+        writer.write(bits[1], 1);
+        writer.write(indices[0], 3);
+        for (int i = 1; i < BLOCK_TEXELS; ++i) {
+            writer.write(indices[i], 4);
+        }
+    }
+
+    std::vector<uint8_t> CompressImage(const uint8_t* pixels, glm::ivec2 size, BlockFormat format) {
+        const int blocksX = (size.x + BLOCK_SIZE - 1) / BLOCK_SIZE;
+        const int blocksY = (size.y + BLOCK_SIZE - 1) / BLOCK_SIZE;
+        const uint32_t blockBytes = GetBlockBytes(format);
+
+        std::vector<uint8_t> blocks(GetCompressedSize(format, size));
+        std::array<uint8_t, BLOCK_TEXELS * 4> texels{};
+        for (int blockY = 0; blockY < blocksY; ++blockY) {
+            for (int blockX = 0; blockX < blocksX; ++blockX) {
+                for (int y = 0; y < BLOCK_SIZE; ++y) {
+                    const int sourceY = std::min(blockY * BLOCK_SIZE + y, size.y - 1);
+                    for (int x = 0; x < BLOCK_SIZE; ++x) {
+                        const int sourceX = std::min(blockX * BLOCK_SIZE + x, size.x - 1);
+                        std::memcpy(&texels[(y * BLOCK_SIZE + x) * 4], pixels + (static_cast<size_t>(sourceY) * size.x + sourceX) * 4, 4);
+                    }
+                }
+
+                uint8_t* block = blocks.data() + (static_cast<size_t>(blockY) * blocksX + blockX) * blockBytes;
+                switch (format) {
+                    case BlockFormat::BC1: EncodeBC1Block(texels.data(), block); break;
+                    case BlockFormat::BC3: EncodeBC3Block(texels.data(), block); break;
+                    case BlockFormat::BC7: EncodeBC7Block(texels.data(), block); break;
+                }
+            }
+        }
+        return blocks;
+    }
+
+    std::vector<uint8_t> DownsampleImage(const uint8_t* pixels, glm::ivec2 size) {
+        static const std::array<float, 256> TO_LINEAR = [] {
+            std::array<float, 256> table{};
+            for (int i = 0; i < 256; ++i) {
+                table[i] = SrgbToLinear(static_cast<uint8_t>(i));
+            }
+            return table;
+        }();
+
+        const glm::ivec2 nextSize = glm::max(size / 2, glm::ivec2(1));
+        std::vector<uint8_t> next(static_cast<size_t>(nextSize.x) * nextSize.y * 4);
+
+        for (int y = 0; y < nextSize.y; ++y) {
+            for (int x = 0; x < nextSize.x; ++x) {
+                // Odd sizes drop the last row or column, clamping keeps 1 texel wide levels in bounds
+                const std::array<glm::ivec2, 4> corners{
+                    glm::ivec2(x * 2, y * 2),
+                    glm::ivec2(std::min(x * 2 + 1, size.x - 1), y * 2),
+                    glm::ivec2(x * 2, std::min(y * 2 + 1, size.y - 1)),
+                    glm::ivec2(std::min(x * 2 + 1, size.x - 1), std::min(y * 2 + 1, size.y - 1))
+                };
+
+                glm::vec4 sum(0.0f);
+                for (const glm::ivec2 corner: corners) {
+                    const uint8_t* texel = pixels + (static_cast<size_t>(corner.y) * size.x + corner.x) * 4;
+                    sum += glm::vec4(TO_LINEAR[texel[0]], TO_LINEAR[texel[1]], TO_LINEAR[texel[2]], static_cast<float>(texel[3]));
+                }
+                sum /= 4.0f;
+
+                uint8_t* destination = next.data() + (static_cast<size_t>(y) * nextSize.x + x) * 4;
+                destination[0] = LinearToSrgb(sum.r);
+                destination[1] = LinearToSrgb(sum.g);
+                destination[2] = LinearToSrgb(sum.b);
+                destination[3] = static_cast<uint8_t>(std::lround(sum.a));
+            }
+        }
+        return next;
+    }
+
+    CompressedImage CompressMipChain(const uint8_t* pixels, glm::ivec2 size, BlockFormat format, bool mipmaps) {
+        CompressedImage image;
+        std::vector<uint8_t> level(pixels, pixels + static_cast<size_t>(size.x) * size.y * 4);
+        glm::ivec2 levelSize = size;
+        while (true) {
+            image.levels.push_back(CompressImage(level.data(), levelSize, format));
+            image.uncompressedBytes += level.size();
+
+            if (!mipmaps || (levelSize.x == 1 && levelSize.y == 1)) break;
+            level = DownsampleImage(level.data(), levelSize);
+            levelSize = glm::max(levelSize / 2, glm::ivec2(1));
+        }
+        return image;
+    }
+
+    bool IsSourceImagePath(const std::filesystem::path& path) {
+        std::string extension = path.extension().string();
+        std::ranges::transform(extension, extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return extension == ".png" || extension == ".jpg" || extension == ".jpeg" || extension == ".tga" || extension == ".bmp";
+    }
+}
@@ -0,0 +1,54 @@
+#ifndef BLOCKCOMPRESSION_H
+#define BLOCKCOMPRESSION_H
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace womp {
+    // Block compressed formats TextureEncoder writes and Image uploads as they are. Every format stores
+    // 4x4 texel blocks, edge blocks of sizes that are not a multiple of 4 repeat the last row and column.
+    enum class BlockFormat : uint8_t {
+        BC1,    // 4 bpp, RGB with 1 bit alpha
+        BC3,    // 8 bpp, RGB with interpolated alpha
+        BC7     // 8 bpp, RGBA, best quality of the three
+    };
+
+    [[nodiscard]] uint32_t GetBlockBytes(BlockFormat format);
+    [[nodiscard]] uint64_t GetCompressedSize(BlockFormat format, glm::ivec2 size);
+    // vkFormat of the sRGB variant, the value a KTX2 file stores
+    [[nodiscard]] uint32_t GetVkFormat(BlockFormat format);
+    [[nodiscard]] std::optional<BlockFormat> GetBlockFormat(uint32_t vkFormat);
+    [[nodiscard]] std::optional<BlockFormat> ParseBlockFormat(std::string_view name);
+    // BC1 when every texel is opaque, BC7 otherwise
+    [[nodiscard]] BlockFormat ChooseBlockFormat(const uint8_t* pixels, glm::ivec2 size);
+
+    // texels are 16 RGBA8 texels in row order, block receives GetBlockBytes bytes
+    void EncodeBC1Block(const uint8_t* texels, uint8_t* block);
+    void EncodeBC3Block(const uint8_t* texels, uint8_t* block);
+    // Mode 6 only: one RGBA subset with 7 bit endpoints, a shared bit each and 4 bit indices
+    void EncodeBC7Block(const uint8_t* texels, uint8_t* block);
+
+    // Tightly packed RGBA8 sRGB pixels to tightly packed blocks, in row order
+    [[nodiscard]] std::vector<uint8_t> CompressImage(const uint8_t* pixels, glm::ivec2 size, BlockFormat format);
+    // Next level of a mip chain, a 2x2 box averaged in linear space like mipmap.comp
+    [[nodiscard]] std::vector<uint8_t> DownsampleImage(const uint8_t* pixels, glm::ivec2 size);
+
+    struct CompressedImage {
+        std::vector<std::vector<uint8_t>> levels;  // Blocks of each level, largest first
+        uint64_t uncompressedBytes{};              // The same levels as RGBA8
+    };
+
+    // Level 0 and, with mipmaps, every level down to 1x1. Each level is downsampled from the uncompressed
+    // one above it, so no level inherits the block errors of another.
+    [[nodiscard]] CompressedImage CompressMipChain(const uint8_t* pixels, glm::ivec2 size, BlockFormat format, bool mipmaps = true);
+
+    // Extensions TextureEncoder reads with stb_image, in any case
+    [[nodiscard]] bool IsSourceImagePath(const std::filesystem::path& path);
+}
+
+#endif //BLOCKCOMPRESSION_H
@@ -0,0 +1,116 @@
+#include "FontFile.h"
+
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string_view>
+
+namespace womp {
+    namespace {
+        // key=value pairs of one line after its tag, values may be quoted
+        std::unordered_map<std::string, std::string> ParseAttributes(std::string_view line) {
+            std::unordered_map<std::string, std::string> attributes;
+
+            size_t i = 0;
+            while (i < line.size()) {
+                while (i < line.size() && line[i] == ' ') ++i;
+                const size_t keyStart = i;
+                while (i < line.size() && line[i] != '=' && line[i] != ' ') ++i;
+                if (i >= line.size() || line[i] != '=') continue;
+
+                const std::string key(line.substr(keyStart, i - keyStart));
+                ++i;
+
+                std::string value;
+                if (i < line.size() && line[i] == '"') {
+                    const size_t end = line.find('"', i + 1);
+                    value = std::string(line.substr(i + 1, end == std::string_view::npos ? std::string_view::npos : end - i - 1));
+                    i = end == std::string_view::npos ? line.size() : end + 1;
+                } else {
+                    const size_t valueStart = i;
+                    while (i < line.size() && line[i] != ' ') ++i;
+                    value = std::string(line.substr(valueStart, i - valueStart));
+                }
+                attributes[key] = std::move(value);
+            }
+            return attributes;
+        }
+
+        float GetFloat(const std::unordered_map<std::string, std::string>& attributes, const std::string& key, float fallback = 0.0f) {
+            const auto it = attributes.find(key);
+            return it != attributes.end() ? std::stof(it->second) : fallback;
+        }
+    }
+
+    FontFile::FontFile(const std::string& filepath) {
+        std::ifstream file(filepath);
+        if (!file) {
+            throw std::runtime_error("Could not open font " + filepath);
+        }
+
+        std::string line;
+        while (std::getline(file, line)) {
+            if (!line.empty() && line.back() == '\r') {
+                line.pop_back();
+            }
+
+            const size_t tagEnd = line.find(' ');
+            const std::string_view tag = std::string_view(line).substr(0, tagEnd);
+            const auto attributes = ParseAttributes(tagEnd == std::string::npos ? std::string_view{} : std::string_view(line).substr(tagEnd + 1));
+
+            if (tag == "info") {
+                // Some tools write the size negated to mean it's in pixels rather than points
+                m_size = std::abs(GetFloat(attributes, "size"));
+            } else if (tag == "common") {
+                m_lineHeight = GetFloat(attributes, "lineHeight");
+                m_base = GetFloat(attributes, "base");
+                m_atlasSize = glm::vec2(GetFloat(attributes, "scaleW"), GetFloat(attributes, "scaleH"));
+                if (GetFloat(attributes, "pages", 1.0f) > 1.0f) {
+                    throw std::runtime_error("Font " + filepath + " has more than one page");
+                }
+            } else if (tag == "page") {
+                const auto it = attributes.find("file");
+                if (it != attributes.end()) {
+                    m_pagePath = (std::filesystem::path(filepath).parent_path() / it->second).string();
+                }
+            } else if (tag == "distanceField") {
+                const auto it = attributes.find("fieldType");
+                m_msdf = it != attributes.end() && (it->second == "msdf" || it->second == "mtsdf");
+                m_distanceRange = GetFloat(attributes, "distanceRange", DEFAULT_DISTANCE_RANGE);
+            } else if (tag == "char") {
+                const auto codepoint = static_cast<uint32_t>(GetFloat(attributes, "id"));
+                m_glyphs[codepoint] = FontGlyph{
+                    .atlasPosition = glm::vec2(GetFloat(attributes, "x"), GetFloat(attributes, "y")),
+                    .size = glm::vec2(GetFloat(attributes, "width"), GetFloat(attributes, "height")),
+                    .offset = glm::vec2(GetFloat(attributes, "xoffset"), GetFloat(attributes, "yoffset")),
+                    .advance = GetFloat(attributes, "xadvance")
+                };
+            } else if (tag == "kerning") {
+                const auto first = static_cast<uint64_t>(GetFloat(attributes, "first"));
+                const auto second = static_cast<uint64_t>(GetFloat(attributes, "second"));
+                m_kerning[first << 32 | second] = GetFloat(attributes, "amount");
+            }
+        }
+
+        if (m_glyphs.empty() || m_atlasSize.x <= 0.0f || m_atlasSize.y <= 0.0f || m_pagePath.empty()) {
+            throw std::runtime_error("Font " + filepath + " is not a BMFont text file");
+        }
+        if (m_size <= 0.0f) {
+            m_size = m_lineHeight;
+        }
+    }
+
+    const FontGlyph* FontFile::findGlyph(uint32_t codepoint) const {
+        const auto it = m_glyphs.find(codepoint);
+        return it != m_glyphs.end() ? &it->second : nullptr;
+    }
+
+    float FontFile::getKerning(uint32_t first, uint32_t second) const {
+        if (m_kerning.empty()) {
+            return 0.0f;
+        }
+        const auto it = m_kerning.find(static_cast<uint64_t>(first) << 32 | second);
+        return it != m_kerning.end() ? it->second : 0.0f;
+    }
+}
@@ -0,0 +1,53 @@
+#ifndef FONTFILE_H
+#define FONTFILE_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+#include <glm/glm.hpp>
+
+namespace womp {
+    struct FontGlyph {
+        glm::vec2 atlasPosition{};  // Top left texel in the atlas
+        glm::vec2 size{};
+        glm::vec2 offset{};         // From the pen on the top of the line to the glyph's top left, y pointing down
+        float advance{};
+    };
+
+    // Metrics of a pre-baked distance field font in the BMFont text format, as written by msdf-bmfont,
+    // msdf-atlas-gen and Hiero. A "distanceField fieldType=msdf distanceRange=N" line marks an MSDF atlas,
+    // without one the distance is read from alpha with a range of DEFAULT_DISTANCE_RANGE. One page only.
+    class FontFile {
+    public:
+        static constexpr float DEFAULT_DISTANCE_RANGE = 4.0f;
+
+        explicit FontFile(const std::string& filepath);
+
+        [[nodiscard]] float getSize() const { return m_size; }                 // Em size the atlas was baked at, in texels
+        [[nodiscard]] float getLineHeight() const { return m_lineHeight; }
+        [[nodiscard]] float getBase() const { return m_base; }                 // Top of the line to the baseline
+        [[nodiscard]] glm::vec2 getAtlasSize() const { return m_atlasSize; }
+        [[nodiscard]] float getDistanceRange() const { return m_distanceRange; }
+        [[nodiscard]] bool isMsdf() const { return m_msdf; }
+        [[nodiscard]] const std::string& getPagePath() const { return m_pagePath; }   // Relative to the working directory
+
+        // Null for code points the font doesn't have
+        [[nodiscard]] const FontGlyph* findGlyph(uint32_t codepoint) const;
+        [[nodiscard]] float getKerning(uint32_t first, uint32_t second) const;
+
+    private:
+        float m_size{};
+        float m_lineHeight{};
+        float m_base{};
+        glm::vec2 m_atlasSize{};
+        float m_distanceRange{DEFAULT_DISTANCE_RANGE};
+        bool m_msdf{false};
+        std::string m_pagePath{};
+
+        std::unordered_map<uint32_t, FontGlyph> m_glyphs{};
+        std::unordered_map<uint64_t, float> m_kerning{};    // first << 32 | second
+    };
+}
+
+#endif //FONTFILE_H
@@ -0,0 +1,97 @@
+#include "Hash.h"
+
+#include <atomic>
+#include <bit>
+#include <cstring>
+
+namespace womp {
+    namespace {
+        constexpr uint64_t PRIME1 = 0x9E3779B185EBCA87ull;
+        constexpr uint64_t PRIME2 = 0xC2B2AE3D27D4EB4Full;
+        constexpr uint64_t PRIME3 = 0x165667B19E3779F9ull;
+        constexpr uint64_t PRIME4 = 0x85EBCA77C2B2AE63ull;
+        constexpr uint64_t PRIME5 = 0x27D4EB2F165667C5ull;
+
+        uint64_t Read64(const uint8_t* p) {
+            uint64_t value;
+            std::memcpy(&value, p, sizeof(value));
+            return value;
+        }
+
+        uint32_t Read32(const uint8_t* p) {
+            uint32_t value;
+            std::memcpy(&value, p, sizeof(value));
+            return value;
+        }
+
+        uint64_t Round(uint64_t accumulator, uint64_t input) {
+            accumulator += input * PRIME2;
+            accumulator = std::rotl(accumulator, 31);
+            return accumulator * PRIME1;
+        }
+
+        uint64_t MergeRound(uint64_t hash, uint64_t accumulator) {
+            hash ^= Round(0, accumulator);
+            return hash * PRIME1 + PRIME4;
+        }
+    }
+
+    uint64_t HashBytes(const void* data, size_t size, uint64_t seed) {
+        const auto* p = static_cast<const uint8_t*>(data);
+        const uint8_t* const end = p + size;
+
+        uint64_t hash;
+        if (size >= 32) {
+            // Four independent lanes keep the multiplies from waiting on each other
+            uint64_t v1 = seed + PRIME1 + PRIME2;
+            uint64_t v2 = seed + PRIME2;
+            uint64_t v3 = seed;
+            uint64_t v4 = seed - PRIME1;
+
+            const uint8_t* const limit = end - 32;
+            do {
+                v1 = Round(v1, Read64(p));
+                v2 = Round(v2, Read64(p + 8));
+                v3 = Round(v3, Read64(p + 16));
+                v4 = Round(v4, Read64(p + 24));
+                p += 32;
+            } while (p <= limit);
+
+            hash = std::rotl(v1, 1) + std::rotl(v2, 7) + std::rotl(v3, 12) + std::rotl(v4, 18);
+            hash = MergeRound(hash, v1);
+            hash = MergeRound(hash, v2);
+            hash = MergeRound(hash, v3);
+            hash = MergeRound(hash, v4);
+        } else {
+            hash = seed + PRIME5;
+        }
+
+        hash += size;
+
+        for (; p + 8 <= end; p += 8) {
+            hash ^= Round(0, Read64(p));
+            hash = std::rotl(hash, 27) * PRIME1 + PRIME4;
+        }
+        if (p + 4 <= end) {
+            hash ^= static_cast<uint64_t>(Read32(p)) * PRIME1;
+            hash = std::rotl(hash, 23) * PRIME2 + PRIME3;
+            p += 4;
+        }
+        for (; p < end; ++p) {
+            hash ^= *p * PRIME5;
+            hash = std::rotl(hash, 11) * PRIME1;
+        }
+
+        hash ^= hash >> 33;
+        hash *= PRIME2;
+        hash ^= hash >> 29;
+        hash *= PRIME3;
+        hash ^= hash >> 32;
+        return hash;
+    }
+
+    uint64_t NextRevision() {
+        static std::atomic<uint64_t> next{1};
+        return next.fetch_add(1, std::memory_order_relaxed);
+    }
+}
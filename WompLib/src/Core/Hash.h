@@ -0,0 +1,28 @@
+#ifndef HASH_H
+#define HASH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace womp {
+    // 64-bit XXH64 of a byte range. Fast enough to run over every pending draw each frame, not meant to be secure.
+    uint64_t HashBytes(const void* data, size_t size, uint64_t seed = 0);
+
+    // Chains the bytes of trivially copyable values onto a running hash
+    template<typename T>
+    uint64_t HashValue(const T& value, uint64_t seed) {
+        return HashBytes(&value, sizeof(T), seed);
+    }
+
+    template<typename T>
+    uint64_t HashValues(const std::vector<T>& values, uint64_t seed) {
+        return HashBytes(values.data(), values.size() * sizeof(T), seed);
+    }
+
+    // Process-wide and never repeats, so a revision taken from it names one state of one object. Objects hashed by
+    // revision can't be mistaken for an earlier one that lived at the same address.
+    uint64_t NextRevision();
+}
+
+#endif //HASH_H
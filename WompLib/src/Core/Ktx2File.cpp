@@ -0,0 +1,191 @@
+#include "Ktx2File.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace {
+    // Data format descriptor values, see the Khronos Data Format Specification
+    constexpr uint32_t DFD_VERSION = 2;
+    constexpr uint32_t DFD_PRIMARIES_BT709 = 1;
+    constexpr uint32_t DFD_TRANSFER_SRGB = 2;
+    constexpr uint32_t DFD_CHANNEL_COLOR = 0;
+    constexpr uint32_t DFD_CHANNEL_BC1A_ALPHA_PRESENT = 1;
+    constexpr uint32_t DFD_CHANNEL_ALPHA = 15;
+    constexpr uint32_t DFD_SAMPLE_LINEAR = 1 << 4;
+
+    struct DfdSample {
+        uint32_t bitOffset;
+        uint32_t bitLength;
+        uint32_t channel;
+    };
+
+    uint32_t GetColorModel(womp::BlockFormat format) {
+        switch (format) {
+            case womp::BlockFormat::BC1: return 128;
+            case womp::BlockFormat::BC3: return 130;
+            case womp::BlockFormat::BC7: return 134;
+        }
+        return 0;
+    }
+
+    // One basic descriptor block for an sRGB 4x4 block format
+    std::vector<uint32_t> BuildDfd(womp::BlockFormat format) {
+        std::vector<DfdSample> samples;
+        switch (format) {
+            case womp::BlockFormat::BC1:
+                samples.push_back({0, 64, DFD_CHANNEL_BC1A_ALPHA_PRESENT});
+                break;
+            case womp::BlockFormat::BC3:
+                samples.push_back({0, 64, DFD_CHANNEL_ALPHA | DFD_SAMPLE_LINEAR});
+                samples.push_back({64, 64, DFD_CHANNEL_COLOR});
+                break;
+            case womp::BlockFormat::BC7:
+                samples.push_back({0, 128, DFD_CHANNEL_COLOR});
+                break;
+        }
+
+        const auto blockSize = static_cast<uint32_t>(24 + samples.size() * 16);
+        std::vector<uint32_t> dfd{
+            4 + blockSize,
+            0,  // Khronos vendor, basic descriptor type
+            DFD_VERSION | blockSize << 16,
+            GetColorModel(format) | DFD_PRIMARIES_BT709 << 8 | DFD_TRANSFER_SRGB << 16,
+            3 | 3 << 8,  // Block dimensions minus one
+            womp::GetBlockBytes(format),
+            0
+        };
+        for (const DfdSample& sample: samples) {
+            dfd.push_back(sample.bitOffset | (sample.bitLength - 1) << 16 | sample.channel << 24);
+            dfd.push_back(0);
+            dfd.push_back(0);
+            dfd.push_back(0xFFFFFFFF);
+        }
+        return dfd;
+    }
+
+    uint64_t AlignUp(uint64_t value, uint64_t alignment) {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    glm::ivec2 GetLevelSize(glm::ivec2 size, uint32_t level) {
+        return glm::max(glm::ivec2(size.x >> level, size.y >> level), glm::ivec2(1));
+    }
+}
+
+namespace womp {
+    Ktx2File::Ktx2File(const std::string& path): m_file{std::make_unique<MappedFile>(path)} {
+        const uint8_t* data = m_file->data();
+        const uint64_t size = m_file->size();
+
+        if (size < sizeof(Ktx2Header)) {
+            throw std::runtime_error("Not a KTX2 file: " + path);
+        }
+        std::memcpy(&m_header, data, sizeof(Ktx2Header));
+
+        if (std::memcmp(m_header.identifier, KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER)) != 0) {
+            throw std::runtime_error("Not a KTX2 file: " + path);
+        }
+
+        const std::optional<BlockFormat> format = GetBlockFormat(m_header.vkFormat);
+        if (!format) {
+            throw std::runtime_error("Unsupported KTX2 format " + std::to_string(m_header.vkFormat) + ", only BC1, BC3 and BC7 are: " + path);
+        }
+        m_format = *format;
+
+        // Generating levels at load would mean decoding, a file without them is rejected too
+        const uint32_t maxLevels = static_cast<uint32_t>(std::bit_width(std::max(m_header.pixelWidth, m_header.pixelHeight)));
+        if (m_header.pixelWidth == 0 || m_header.pixelHeight == 0 || m_header.pixelDepth != 0 || m_header.layerCount > 1 ||
+            m_header.faceCount != 1 || m_header.levelCount == 0 || m_header.levelCount > maxLevels || m_header.supercompressionScheme != 0) {
+            throw std::runtime_error("Unsupported KTX2 file, only plain 2D images with stored levels are: " + path);
+        }
+
+        // Every level has to lie inside the file and hold exactly its blocks before anything reads it
+        const auto fits = [size](uint64_t offset, uint64_t bytes) {
+            return offset <= size && bytes <= size - offset;
+        };
+        if (!fits(sizeof(Ktx2Header), static_cast<uint64_t>(m_header.levelCount) * sizeof(Ktx2Level))) {
+            throw std::runtime_error("Truncated KTX2 file: " + path);
+        }
+        m_levels.resize(m_header.levelCount);
+        std::memcpy(m_levels.data(), data + sizeof(Ktx2Header), m_levels.size() * sizeof(Ktx2Level));
+
+        for (uint32_t level = 0; level < m_header.levelCount; ++level) {
+            const Ktx2Level& entry = m_levels[level];
+            if (!fits(entry.byteOffset, entry.byteLength) || entry.byteLength != GetCompressedSize(m_format, GetLevelSize(getSize(), level))) {
+                throw std::runtime_error("Corrupt level index in KTX2 file: " + path);
+            }
+        }
+    }
+
+    std::optional<glm::ivec2> Ktx2File::ReadSize(const std::string& path) {
+        std::ifstream file(path, std::ios::binary);
+        Ktx2Header header{};
+        if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+            std::memcmp(header.identifier, KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER)) != 0) {
+            return std::nullopt;
+        }
+        return glm::ivec2(header.pixelWidth, header.pixelHeight);
+    }
+
+    void Ktx2File::Write(const std::filesystem::path& path, BlockFormat format, glm::ivec2 size, const std::vector<std::vector<uint8_t>>& levels) {
+        const std::vector<uint32_t> dfd = BuildDfd(format);
+        const auto levelCount = static_cast<uint32_t>(levels.size());
+
+        Ktx2Header header{};
+        std::copy_n(KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER), header.identifier);
+        header.vkFormat = GetVkFormat(format);
+        header.typeSize = 1;
+        header.pixelWidth = static_cast<uint32_t>(size.x);
+        header.pixelHeight = static_cast<uint32_t>(size.y);
+        header.faceCount = 1;
+        header.levelCount = levelCount;
+        header.dfdByteOffset = static_cast<uint32_t>(sizeof(Ktx2Header) + levelCount * sizeof(Ktx2Level));
+        header.dfdByteLength = static_cast<uint32_t>(dfd.size() * sizeof(uint32_t));
+
+        // Smallest level first, each aligned to its block size
+        std::vector<Ktx2Level> index(levelCount);
+        uint64_t offset = header.dfdByteOffset + header.dfdByteLength;
+        for (uint32_t level = levelCount; level-- > 0;) {
+            offset = AlignUp(offset, GetBlockBytes(format));
+            index[level] = Ktx2Level{offset, levels[level].size(), levels[level].size()};
+            offset += levels[level].size();
+        }
+
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            throw std::runtime_error("Could not open " + path.string() + " for writing");
+        }
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(index.data()), static_cast<std::streamsize>(index.size() * sizeof(Ktx2Level)));
+        file.write(reinterpret_cast<const char*>(dfd.data()), static_cast<std::streamsize>(dfd.size() * sizeof(uint32_t)));
+
+        const std::array<char, 16> padding{};
+        uint64_t written = header.dfdByteOffset + header.dfdByteLength;
+        for (uint32_t level = levelCount; level-- > 0;) {
+            file.write(padding.data(), static_cast<std::streamsize>(index[level].byteOffset - written));
+            file.write(reinterpret_cast<const char*>(levels[level].data()), static_cast<std::streamsize>(levels[level].size()));
+            written = index[level].byteOffset + index[level].byteLength;
+        }
+
+        if (!file) {
+            throw std::runtime_error("Could not write " + path.string());
+        }
+    }
+
+    std::span<const uint8_t> Ktx2File::getLevel(uint32_t level) const {
+        return {m_file->data() + m_levels[level].byteOffset, m_levels[level].byteLength};
+    }
+
+    uint64_t Ktx2File::getDataSize() const {
+        uint64_t size = 0;
+        for (const Ktx2Level& level: m_levels) {
+            size += level.byteLength;
+        }
+        return size;
+    }
+}
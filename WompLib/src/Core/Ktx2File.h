@@ -0,0 +1,87 @@
+#ifndef KTX2FILE_H
+#define KTX2FILE_H
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "BlockCompression.h"
+#include "MappedFile.h"
+
+namespace womp {
+    // The subset of KTX 2.0 TextureEncoder writes: one 2D image of a BlockFormat with its mip levels
+    // stored, no supercompression. Little endian, levels are stored smallest first and indexed from the
+    // largest. Offsets are from the start of the file.
+    constexpr uint8_t KTX2_IDENTIFIER[12] = {0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'};
+
+    struct Ktx2Header {
+        uint8_t identifier[12];
+        uint32_t vkFormat;
+        uint32_t typeSize;              // 1 for block compressed formats
+        uint32_t pixelWidth;
+        uint32_t pixelHeight;
+        uint32_t pixelDepth;            // 0 for 2D images
+        uint32_t layerCount;            // 0 when not an array
+        uint32_t faceCount;
+        uint32_t levelCount;
+        uint32_t supercompressionScheme;
+        uint32_t dfdByteOffset;         // Data format descriptor, required but never read here
+        uint32_t dfdByteLength;
+        uint32_t kvdByteOffset;
+        uint32_t kvdByteLength;
+        uint64_t sgdByteOffset;
+        uint64_t sgdByteLength;
+    };
+    static_assert(sizeof(Ktx2Header) == 80);
+
+    // Follows the header, one per level
+    struct Ktx2Level {
+        uint64_t byteOffset;
+        uint64_t byteLength;
+        uint64_t uncompressedByteLength;
+    };
+    static_assert(sizeof(Ktx2Level) == 24);
+
+    inline bool IsKtx2Path(const std::filesystem::path& path) {
+        return path.extension() == ".ktx2" || path.extension() == ".KTX2";
+    }
+
+    // Maps a KTX2 file and validates its level index, the blocks are only touched when read
+    class Ktx2File {
+    public:
+        explicit Ktx2File(const std::string& path);
+
+        Ktx2File(const Ktx2File& other) = delete;
+        Ktx2File(Ktx2File&& other) noexcept = delete;
+        Ktx2File& operator=(const Ktx2File& other) = delete;
+        Ktx2File& operator=(Ktx2File&& other) noexcept = delete;
+
+        // Only reads the header, like stbi_info
+        [[nodiscard]] static std::optional<glm::ivec2> ReadSize(const std::string& path);
+        // levels are tightly packed blocks, the largest first
+        static void Write(const std::filesystem::path& path, BlockFormat format, glm::ivec2 size, const std::vector<std::vector<uint8_t>>& levels);
+
+        [[nodiscard]] uint32_t getVkFormat() const { return m_header.vkFormat; }
+        [[nodiscard]] BlockFormat getBlockFormat() const { return m_format; }
+        [[nodiscard]] glm::ivec2 getSize() const { return glm::ivec2(m_header.pixelWidth, m_header.pixelHeight); }
+        [[nodiscard]] uint32_t getLevelCount() const { return m_header.levelCount; }
+        // Level 0 is the full size image
+        [[nodiscard]] std::span<const uint8_t> getLevel(uint32_t level) const;
+        // Bytes of all levels together, what the image takes in device memory
+        [[nodiscard]] uint64_t getDataSize() const;
+
+    private:
+        std::unique_ptr<MappedFile> m_file;
+        Ktx2Header m_header{};
+        BlockFormat m_format{};
+        std::vector<Ktx2Level> m_levels{};
+    };
+}
+
+#endif //KTX2FILE_H
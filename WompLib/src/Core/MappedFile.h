@@ -0,0 +1,33 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace womp {
+    // Read-only view of a whole file mapped into memory, pages are read in by the OS on first touch
+    class MappedFile {
+    public:
+        explicit MappedFile(const std::string& path);
+        ~MappedFile();
+
+        MappedFile(const MappedFile& other) = delete;
+        MappedFile(MappedFile&& other) noexcept = delete;
+        MappedFile& operator=(const MappedFile& other) = delete;
+        MappedFile& operator=(MappedFile&& other) noexcept = delete;
+
+        [[nodiscard]] const uint8_t* data() const { return m_data; }
+        [[nodiscard]] size_t size() const { return m_size; }
+
+    private:
+        const uint8_t* m_data{};
+        size_t m_size{};
+#ifdef _WIN32
+        void* m_file{};
+        void* m_mapping{};
+#endif
+    };
+}
+
+#endif //MAPPEDFILE_H
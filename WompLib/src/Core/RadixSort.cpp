@@ -0,0 +1,56 @@
+#include "RadixSort.h"
+
+#include <array>
+#include <cstddef>
+#include <utility>
+
+namespace womp {
+    void RadixSort(std::vector<SortItem>& items, std::vector<SortItem>& scratch) {
+        constexpr int DIGIT_BITS = 8;
+        constexpr int DIGIT_COUNT = 64 / DIGIT_BITS;
+        constexpr size_t BUCKET_COUNT = 1 << DIGIT_BITS;
+
+        const size_t count = items.size();
+        if (count < 2) {
+            return;
+        }
+        scratch.resize(count);
+
+        std::array<std::array<uint32_t, BUCKET_COUNT>, DIGIT_COUNT> histograms{};
+        for (const auto& item: items) {
+            for (int digit = 0; digit < DIGIT_COUNT; ++digit) {
+                histograms[digit][(item.key >> (digit * DIGIT_BITS)) & (BUCKET_COUNT - 1)]++;
+            }
+        }
+
+        SortItem* src = items.data();
+        SortItem* dst = scratch.data();
+
+        for (int digit = 0; digit < DIGIT_COUNT; ++digit) {
+            auto& histogram = histograms[digit];
+            const int shift = digit * DIGIT_BITS;
+
+            // Every key shares this digit, the pass would be a plain copy
+            if (histogram[(src[0].key >> shift) & (BUCKET_COUNT - 1)] == count) {
+                continue;
+            }
+
+            uint32_t offset = 0;
+            for (auto& bucket: histogram) {
+                const uint32_t bucketSize = bucket;
+                bucket = offset;
+                offset += bucketSize;
+            }
+
+            for (size_t i = 0; i < count; ++i) {
+                dst[histogram[(src[i].key >> shift) & (BUCKET_COUNT - 1)]++] = src[i];
+            }
+
+            std::swap(src, dst);
+        }
+
+        if (src != items.data()) {
+            items.swap(scratch);
+        }
+    }
+}
@@ -0,0 +1,18 @@
+#ifndef RADIXSORT_H
+#define RADIXSORT_H
+
+#include <cstdint>
+#include <vector>
+
+namespace womp {
+    struct SortItem {
+        uint64_t key;
+        uint32_t index;
+    };
+
+    // Stable LSD radix sort over 8-bit digits, all digit histograms are gathered in one pass
+    // and digits that are identical for every key are skipped. scratch is reused between calls.
+    void RadixSort(std::vector<SortItem>& items, std::vector<SortItem>& scratch);
+}
+
+#endif //RADIXSORT_H
@@ -0,0 +1,97 @@
+#include "SkylinePacker.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace womp {
+    SkylinePacker::SkylinePacker(int width, int height): m_width{width}, m_height{height} {
+        reset();
+    }
+
+    std::optional<glm::ivec2> SkylinePacker::insert(glm::ivec2 size) {
+        if (size.x <= 0 || size.y <= 0) {
+            return std::nullopt;
+        }
+
+        // Lowest resulting top edge wins, the narrower segment breaks ties so wide gaps stay open
+        size_t bestSegment = m_skyline.size();
+        int bestTop = std::numeric_limits<int>::max();
+        int bestWidth = std::numeric_limits<int>::max();
+        int bestY = 0;
+
+        for (size_t i = 0; i < m_skyline.size(); ++i) {
+            const int y = restingHeight(i, size);
+            if (y < 0) continue;
+
+            const int top = y + size.y;
+            if (top < bestTop || (top == bestTop && m_skyline[i].width < bestWidth)) {
+                bestSegment = i;
+                bestTop = top;
+                bestWidth = m_skyline[i].width;
+                bestY = y;
+            }
+        }
+
+        if (bestSegment == m_skyline.size()) {
+            return std::nullopt;
+        }
+
+        const glm::ivec2 position{m_skyline[bestSegment].x, bestY};
+        m_skyline.insert(m_skyline.begin() + static_cast<ptrdiff_t>(bestSegment), Segment{position.x, bestTop, size.x});
+
+        // Segments now covered by the rect shrink from the left or go away
+        const int right = position.x + size.x;
+        size_t next = bestSegment + 1;
+        while (next < m_skyline.size() && m_skyline[next].x < right) {
+            Segment& segment = m_skyline[next];
+            const int segmentRight = segment.x + segment.width;
+            if (segmentRight <= right) {
+                m_skyline.erase(m_skyline.begin() + static_cast<ptrdiff_t>(next));
+                continue;
+            }
+            segment.width = segmentRight - right;
+            segment.x = right;
+            break;
+        }
+
+        // Neighbours at the same height become one segment
+        for (size_t i = 0; i + 1 < m_skyline.size();) {
+            if (m_skyline[i].y == m_skyline[i + 1].y) {
+                m_skyline[i].width += m_skyline[i + 1].width;
+                m_skyline.erase(m_skyline.begin() + static_cast<ptrdiff_t>(i) + 1);
+            } else {
+                ++i;
+            }
+        }
+
+        m_usedArea += static_cast<int64_t>(size.x) * size.y;
+        return position;
+    }
+
+    void SkylinePacker::reset() {
+        m_skyline.assign(1, Segment{0, 0, m_width});
+        m_usedArea = 0;
+    }
+
+    float SkylinePacker::getOccupancy() const {
+        return static_cast<float>(static_cast<double>(m_usedArea) / (static_cast<double>(m_width) * m_height));
+    }
+
+    int SkylinePacker::restingHeight(size_t segment, glm::ivec2 size) const {
+        if (m_skyline[segment].x + size.x > m_width) {
+            return -1;
+        }
+
+        // The rect rests on the highest segment below its span
+        int y = 0;
+        int remaining = size.x;
+        for (size_t i = segment; remaining > 0; ++i) {
+            y = std::max(y, m_skyline[i].y);
+            if (y + size.y > m_height) {
+                return -1;
+            }
+            remaining -= m_skyline[i].width;
+        }
+        return y;
+    }
+}
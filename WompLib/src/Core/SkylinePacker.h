@@ -0,0 +1,42 @@
+#ifndef SKYLINEPACKER_H
+#define SKYLINEPACKER_H
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace womp {
+    // Bottom-left skyline rectangle packer. Tracks the top edge of everything placed so far as a
+    // list of horizontal segments and puts each rect where its top ends up lowest.
+    class SkylinePacker {
+    public:
+        SkylinePacker(int width, int height);
+
+        // Top left corner of the placed rect, nothing when it doesn't fit anymore
+        std::optional<glm::ivec2> insert(glm::ivec2 size);
+        void reset();
+
+        [[nodiscard]] glm::ivec2 getSize() const { return {m_width, m_height}; }
+        // Fraction of the area covered by placed rects
+        [[nodiscard]] float getOccupancy() const;
+
+    private:
+        struct Segment {
+            int x;
+            int y;
+            int width;
+        };
+
+        // Height the rect would rest at when its left edge is on the segment, -1 if it sticks out
+        [[nodiscard]] int restingHeight(size_t segment, glm::ivec2 size) const;
+
+        int m_width;
+        int m_height;
+        int64_t m_usedArea{};
+        std::vector<Segment> m_skyline{};
+    };
+}
+
+#endif //SKYLINEPACKER_H
@@ -0,0 +1,44 @@
+#include "TaskQueue.h"
+
+namespace womp {
+    TaskQueue::TaskQueue(uint32_t workerCount) {
+        m_workers.reserve(workerCount);
+        for (uint32_t i = 0; i < workerCount; ++i) {
+            m_workers.emplace_back([this] { workerLoop(); });
+        }
+    }
+
+    TaskQueue::~TaskQueue() {
+        {
+            std::lock_guard lock{m_mutex};
+            m_stopping = true;
+            m_tasks.clear();
+        }
+        m_wakeCondition.notify_all();
+        m_workers.clear();
+    }
+
+    void TaskQueue::push(std::function<void()> task) {
+        {
+            std::lock_guard lock{m_mutex};
+            m_tasks.push_back(std::move(task));
+        }
+        m_wakeCondition.notify_one();
+    }
+
+    void TaskQueue::workerLoop() {
+        while (true) {
+            std::function<void()> task;
+            {
+                std::unique_lock lock{m_mutex};
+                m_wakeCondition.wait(lock, [this] { return m_stopping || !m_tasks.empty(); });
+                if (m_stopping) {
+                    return;
+                }
+                task = std::move(m_tasks.front());
+                m_tasks.pop_front();
+            }
+            task();
+        }
+    }
+}
@@ -0,0 +1,41 @@
+#ifndef TASKQUEUE_H
+#define TASKQUEUE_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace womp {
+    // Worker threads running fire and forget tasks in push order, for background work like decoding that
+    // nobody waits on. Unlike ThreadPool, the pushing thread never takes part or blocks.
+    class TaskQueue {
+    public:
+        explicit TaskQueue(uint32_t workerCount);
+        // Tasks that haven't started are dropped, running ones are finished
+        ~TaskQueue();
+
+        TaskQueue(const TaskQueue& other) = delete;
+        TaskQueue(TaskQueue&& other) noexcept = delete;
+        TaskQueue& operator=(const TaskQueue& other) = delete;
+        TaskQueue& operator=(TaskQueue&& other) noexcept = delete;
+
+        // Tasks must not throw, there is no one to rethrow to
+        void push(std::function<void()> task);
+
+    private:
+        void workerLoop();
+
+        std::vector<std::jthread> m_workers{};
+
+        std::mutex m_mutex;
+        std::condition_variable m_wakeCondition;
+        std::deque<std::function<void()>> m_tasks{};
+        bool m_stopping{false};
+    };
+}
+
+#endif //TASKQUEUE_H
@@ -0,0 +1,83 @@
+#include "ThreadPool.h"
+
+#include <utility>
+
+namespace womp {
+    ThreadPool::ThreadPool(uint32_t workerCount) {
+        m_workers.reserve(workerCount);
+        for (uint32_t i = 0; i < workerCount; ++i) {
+            m_workers.emplace_back([this, i] { workerLoop(i); });
+        }
+    }
+
+    ThreadPool::~ThreadPool() {
+        {
+            std::lock_guard lock{m_mutex};
+            m_stopping = true;
+        }
+        m_wakeCondition.notify_all();
+        m_workers.clear();
+    }
+
+    void ThreadPool::run(uint32_t count, const std::function<void(uint32_t, uint32_t)>& job) {
+        if (count == 0) {
+            return;
+        }
+
+        {
+            std::lock_guard lock{m_mutex};
+            m_job = &job;
+            m_jobCount = count;
+            m_nextJob.store(0, std::memory_order_relaxed);
+            m_activeWorkers = static_cast<uint32_t>(m_workers.size());
+            ++m_generation;
+        }
+        m_wakeCondition.notify_all();
+
+        drain(static_cast<uint32_t>(m_workers.size()));
+
+        // Workers still hold a pointer to job until they report back
+        std::unique_lock lock{m_mutex};
+        m_doneCondition.wait(lock, [this] { return m_activeWorkers == 0; });
+        m_job = nullptr;
+
+        if (m_exception) {
+            std::rethrow_exception(std::exchange(m_exception, nullptr));
+        }
+    }
+
+    void ThreadPool::workerLoop(uint32_t threadIndex) {
+        uint64_t seenGeneration = 0;
+        while (true) {
+            {
+                std::unique_lock lock{m_mutex};
+                m_wakeCondition.wait(lock, [this, seenGeneration] { return m_stopping || m_generation != seenGeneration; });
+                if (m_stopping) {
+                    return;
+                }
+                seenGeneration = m_generation;
+            }
+
+            drain(threadIndex);
+
+            {
+                std::lock_guard lock{m_mutex};
+                --m_activeWorkers;
+            }
+            m_doneCondition.notify_one();
+        }
+    }
+
+    void ThreadPool::drain(uint32_t threadIndex) {
+        for (uint32_t index = m_nextJob.fetch_add(1, std::memory_order_relaxed); index < m_jobCount; index = m_nextJob.fetch_add(1, std::memory_order_relaxed)) {
+            try {
+                (*m_job)(index, threadIndex);
+            } catch (...) {
+                std::lock_guard lock{m_mutex};
+                if (!m_exception) {
+                    m_exception = std::current_exception();
+                }
+            }
+        }
+    }
+}
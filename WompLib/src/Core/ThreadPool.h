@@ -0,0 +1,54 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace womp {
+    // Fixed set of worker threads for fork/join style jobs
+    class ThreadPool {
+    public:
+        explicit ThreadPool(uint32_t workerCount);
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool& other) = delete;
+        ThreadPool(ThreadPool&& other) noexcept = delete;
+        ThreadPool& operator=(const ThreadPool& other) = delete;
+        ThreadPool& operator=(ThreadPool&& other) noexcept = delete;
+
+        // Workers plus the thread calling run()
+        [[nodiscard]] uint32_t getThreadCount() const { return static_cast<uint32_t>(m_workers.size()) + 1; }
+
+        // Calls job(index, threadIndex) for every index in [0, count) and blocks until all of them are done.
+        // threadIndex is below getThreadCount() and unique among the jobs running at the same time,
+        // the calling thread takes part as the last thread index. The first exception a job throws is
+        // rethrown here once every job has finished. Not reentrant.
+        void run(uint32_t count, const std::function<void(uint32_t, uint32_t)>& job);
+
+    private:
+        void workerLoop(uint32_t threadIndex);
+        void drain(uint32_t threadIndex);
+
+        std::vector<std::jthread> m_workers{};
+
+        std::mutex m_mutex;
+        std::condition_variable m_wakeCondition;
+        std::condition_variable m_doneCondition;
+        uint64_t m_generation{0};
+        bool m_stopping{false};
+
+        const std::function<void(uint32_t, uint32_t)>* m_job{nullptr};
+        uint32_t m_jobCount{0};
+        std::atomic<uint32_t> m_nextJob{0};
+        uint32_t m_activeWorkers{0};
+        std::exception_ptr m_exception{};
+    };
+}
+
+#endif //THREADPOOL_H
@@ -1 +1,302 @@
 #include <womp/WompMath.h>
+
+#include <algorithm>
+#include <cmath>
+
+// SSE2 is part of the x86-64 baseline, so only AVX2 needs a runtime check
+#if defined(__x86_64__) || defined(_M_X64)
+#define WOMP_MATH_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+// GCC and Clang only emit AVX2 for functions that ask for it, MSVC emits whatever intrinsics are used
+#if defined(WOMP_MATH_X86) && (defined(__GNUC__) || defined(__clang__))
+#define WOMP_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#else
+#define WOMP_TARGET_AVX2
+#endif
+
+namespace {
+    // Reference path, also finishes the tails the SIMD loops leave
+    void TransformQuadsScalar(const glm::vec4* rects, const float* rotations, size_t count, glm::vec2 scale, WP_Quad* quads) {
+        for (size_t i = 0; i < count; ++i) {
+            const glm::vec4& rect = rects[i];
+            const float c = std::cos(rotations[i]);
+            const float s = std::sin(rotations[i]);
+
+            // basic.vert: clip = (center + rot * (corner * halfSize)) / screenSize * 2 - 1, with y flipped
+            const float x0 = rect.x * scale.x - 1.0f;
+            const float y0 = 1.0f - rect.y * scale.y;
+            const float ax = c * rect.z * scale.x;
+            const float bx = s * rect.w * scale.x;
+            const float ay = s * rect.z * scale.y;
+            const float by = -c * rect.w * scale.y;
+
+            WP_Quad& quad = quads[i];
+            quad.corners[0] = glm::vec2(x0 - ax - bx, y0 - ay - by);
+            quad.corners[1] = glm::vec2(x0 + ax - bx, y0 + ay - by);
+            quad.corners[2] = glm::vec2(x0 + ax + bx, y0 + ay + by);
+            quad.corners[3] = glm::vec2(x0 - ax + bx, y0 - ay + by);
+        }
+    }
+
+#if defined(WOMP_MATH_X86)
+    // Cephes style sin/cos: reduce to [-pi/4, pi/4] around the nearest multiple of pi/2, evaluate
+    // both minimax polynomials and pick/negate them by quadrant
+    constexpr float TWO_OVER_PI = 0.636619772367581343f;
+    constexpr float PI_OVER_2_HI = 1.5703125f;
+    constexpr float PI_OVER_2_MID = 4.837512969970703125e-4f;
+    constexpr float PI_OVER_2_LO = 7.54978995489188216e-8f;
+    constexpr float SIN_C0 = -1.9515295891e-4f;
+    constexpr float SIN_C1 = 8.3321608736e-3f;
+    constexpr float SIN_C2 = -1.6666654611e-1f;
+    constexpr float COS_C0 = 2.443315711809948e-5f;
+    constexpr float COS_C1 = -1.388731625493765e-3f;
+    constexpr float COS_C2 = 4.166664568298827e-2f;
+
+    void SinCosSSE2(__m128 x, __m128& sinOut, __m128& cosOut) {
+        const __m128i quadrant = _mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(TWO_OVER_PI)));
+        const __m128 q = _mm_cvtepi32_ps(quadrant);
+
+        __m128 r = _mm_sub_ps(x, _mm_mul_ps(q, _mm_set1_ps(PI_OVER_2_HI)));
+        r = _mm_sub_ps(r, _mm_mul_ps(q, _mm_set1_ps(PI_OVER_2_MID)));
+        r = _mm_sub_ps(r, _mm_mul_ps(q, _mm_set1_ps(PI_OVER_2_LO)));
+        const __m128 z = _mm_mul_ps(r, r);
+
+        __m128 sinPoly = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(SIN_C0), z), _mm_set1_ps(SIN_C1));
+        sinPoly = _mm_add_ps(_mm_mul_ps(sinPoly, z), _mm_set1_ps(SIN_C2));
+        sinPoly = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(sinPoly, z), r), r);
+
+        __m128 cosPoly = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(COS_C0), z), _mm_set1_ps(COS_C1));
+        cosPoly = _mm_add_ps(_mm_mul_ps(cosPoly, z), _mm_set1_ps(COS_C2));
+        cosPoly = _mm_mul_ps(_mm_mul_ps(cosPoly, z), z);
+        cosPoly = _mm_add_ps(_mm_sub_ps(cosPoly, _mm_mul_ps(z, _mm_set1_ps(0.5f))), _mm_set1_ps(1.0f));
+
+        // Odd quadrants swap sin and cos, quadrants 2-3 negate sin, 1-2 negate cos
+        const __m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(quadrant, _mm_set1_epi32(1)), _mm_set1_epi32(1)));
+        const __m128 sinSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(quadrant, _mm_set1_epi32(2)), 30));
+        const __m128 cosSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(quadrant, _mm_set1_epi32(1)), _mm_set1_epi32(2)), 30));
+
+        const __m128 s = _mm_or_ps(_mm_and_ps(swap, cosPoly), _mm_andnot_ps(swap, sinPoly));
+        const __m128 c = _mm_or_ps(_mm_and_ps(swap, sinPoly), _mm_andnot_ps(swap, cosPoly));
+        sinOut = _mm_xor_ps(s, sinSign);
+        cosOut = _mm_xor_ps(c, cosSign);
+    }
+
+    void TransformQuadsSSE2(const glm::vec4* rects, const float* rotations, size_t count, glm::vec2 scale, WP_Quad* quads) {
+        const __m128 scaleX = _mm_set1_ps(scale.x);
+        const __m128 scaleY = _mm_set1_ps(scale.y);
+        const __m128 one = _mm_set1_ps(1.0f);
+
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            // Four rects to x, y, halfWidth, halfHeight registers
+            __m128 x = _mm_loadu_ps(&rects[i].x);
+            __m128 y = _mm_loadu_ps(&rects[i + 1].x);
+            __m128 hw = _mm_loadu_ps(&rects[i + 2].x);
+            __m128 hh = _mm_loadu_ps(&rects[i + 3].x);
+            _MM_TRANSPOSE4_PS(x, y, hw, hh);
+
+            __m128 s, c;
+            SinCosSSE2(_mm_loadu_ps(rotations + i), s, c);
+
+            const __m128 x0 = _mm_sub_ps(_mm_mul_ps(x, scaleX), one);
+            const __m128 y0 = _mm_sub_ps(one, _mm_mul_ps(y, scaleY));
+            const __m128 hwX = _mm_mul_ps(hw, scaleX);
+            const __m128 hhX = _mm_mul_ps(hh, scaleX);
+            const __m128 hwY = _mm_mul_ps(hw, scaleY);
+            const __m128 hhY = _mm_mul_ps(hh, scaleY);
+
+            const __m128 ax = _mm_mul_ps(c, hwX);
+            const __m128 bx = _mm_mul_ps(s, hhX);
+            const __m128 ay = _mm_mul_ps(s, hwY);
+            const __m128 by = _mm_sub_ps(_mm_setzero_ps(), _mm_mul_ps(c, hhY));
+
+            const __m128 px = _mm_add_ps(ax, bx);
+            const __m128 mx = _mm_sub_ps(ax, bx);
+            const __m128 py = _mm_add_ps(ay, by);
+            const __m128 my = _mm_sub_ps(ay, by);
+
+            __m128 c0x = _mm_sub_ps(x0, px), c0y = _mm_sub_ps(y0, py);
+            __m128 c1x = _mm_add_ps(x0, mx), c1y = _mm_add_ps(y0, my);
+            __m128 c2x = _mm_add_ps(x0, px), c2y = _mm_add_ps(y0, py);
+            __m128 c3x = _mm_sub_ps(x0, mx), c3y = _mm_sub_ps(y0, my);
+
+            // Back to one 32 byte quad per sprite
+            _MM_TRANSPOSE4_PS(c0x, c0y, c1x, c1y);
+            _MM_TRANSPOSE4_PS(c2x, c2y, c3x, c3y);
+
+            auto* out = reinterpret_cast<float*>(quads + i);
+            _mm_storeu_ps(out + 0, c0x);
+            _mm_storeu_ps(out + 4, c2x);
+            _mm_storeu_ps(out + 8, c0y);
+            _mm_storeu_ps(out + 12, c2y);
+            _mm_storeu_ps(out + 16, c1x);
+            _mm_storeu_ps(out + 20, c3x);
+            _mm_storeu_ps(out + 24, c1y);
+            _mm_storeu_ps(out + 28, c3y);
+        }
+
+        TransformQuadsScalar(rects + i, rotations + i, count - i, scale, quads + i);
+    }
+
+    WOMP_TARGET_AVX2 void SinCosAVX2(__m256 x, __m256& sinOut, __m256& cosOut) {
+        const __m256i quadrant = _mm256_cvtps_epi32(_mm256_mul_ps(x, _mm256_set1_ps(TWO_OVER_PI)));
+        const __m256 q = _mm256_cvtepi32_ps(quadrant);
+
+        __m256 r = _mm256_fnmadd_ps(q, _mm256_set1_ps(PI_OVER_2_HI), x);
+        r = _mm256_fnmadd_ps(q, _mm256_set1_ps(PI_OVER_2_MID), r);
+        r = _mm256_fnmadd_ps(q, _mm256_set1_ps(PI_OVER_2_LO), r);
+        const __m256 z = _mm256_mul_ps(r, r);
+
+        __m256 sinPoly = _mm256_fmadd_ps(_mm256_set1_ps(SIN_C0), z, _mm256_set1_ps(SIN_C1));
+        sinPoly = _mm256_fmadd_ps(sinPoly, z, _mm256_set1_ps(SIN_C2));
+        sinPoly = _mm256_fmadd_ps(_mm256_mul_ps(sinPoly, z), r, r);
+
+        __m256 cosPoly = _mm256_fmadd_ps(_mm256_set1_ps(COS_C0), z, _mm256_set1_ps(COS_C1));
+        cosPoly = _mm256_fmadd_ps(cosPoly, z, _mm256_set1_ps(COS_C2));
+        cosPoly = _mm256_mul_ps(_mm256_mul_ps(cosPoly, z), z);
+        cosPoly = _mm256_add_ps(_mm256_fnmadd_ps(z, _mm256_set1_ps(0.5f), cosPoly), _mm256_set1_ps(1.0f));
+
+        const __m256 swap = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(quadrant, _mm256_set1_epi32(1)), _mm256_set1_epi32(1)));
+        const __m256 sinSign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(quadrant, _mm256_set1_epi32(2)), 30));
+        const __m256 cosSign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(_mm256_add_epi32(quadrant, _mm256_set1_epi32(1)), _mm256_set1_epi32(2)), 30));
+
+        sinOut = _mm256_xor_ps(_mm256_blendv_ps(sinPoly, cosPoly, swap), sinSign);
+        cosOut = _mm256_xor_ps(_mm256_blendv_ps(cosPoly, sinPoly, swap), cosSign);
+    }
+
+    WOMP_TARGET_AVX2 void TransformQuadsAVX2(const glm::vec4* rects, const float* rotations, size_t count, glm::vec2 scale, WP_Quad* quads) {
+        const __m256 scaleX = _mm256_set1_ps(scale.x);
+        const __m256 scaleY = _mm256_set1_ps(scale.y);
+        const __m256 one = _mm256_set1_ps(1.0f);
+
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            // Rect n in the low lane, n + 4 in the high lane, so an in-lane transpose yields x, y, hw, hh
+            const float* in = &rects[i].x;
+            const __m256 r0 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(in + 0)), _mm_loadu_ps(in + 16), 1);
+            const __m256 r1 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(in + 4)), _mm_loadu_ps(in + 20), 1);
+            const __m256 r2 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(in + 8)), _mm_loadu_ps(in + 24), 1);
+            const __m256 r3 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(in + 12)), _mm_loadu_ps(in + 28), 1);
+
+            const __m256 t0 = _mm256_unpacklo_ps(r0, r1);
+            const __m256 t1 = _mm256_unpackhi_ps(r0, r1);
+            const __m256 t2 = _mm256_unpacklo_ps(r2, r3);
+            const __m256 t3 = _mm256_unpackhi_ps(r2, r3);
+            const __m256 x = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+            const __m256 y = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+            const __m256 hw = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+            const __m256 hh = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+
+            // Lane order above is sprites 0-3 | 4-7, which the rotations load already matches
+            __m256 s, c;
+            SinCosAVX2(_mm256_loadu_ps(rotations + i), s, c);
+
+            const __m256 x0 = _mm256_fmsub_ps(x, scaleX, one);
+            const __m256 y0 = _mm256_fnmadd_ps(y, scaleY, one);
+            const __m256 ax = _mm256_mul_ps(c, _mm256_mul_ps(hw, scaleX));
+            const __m256 bx = _mm256_mul_ps(s, _mm256_mul_ps(hh, scaleX));
+            const __m256 ay = _mm256_mul_ps(s, _mm256_mul_ps(hw, scaleY));
+            const __m256 by = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_mul_ps(c, _mm256_mul_ps(hh, scaleY)));
+
+            const __m256 px = _mm256_add_ps(ax, bx);
+            const __m256 mx = _mm256_sub_ps(ax, bx);
+            const __m256 py = _mm256_add_ps(ay, by);
+            const __m256 my = _mm256_sub_ps(ay, by);
+
+            const __m256 c0x = _mm256_sub_ps(x0, px), c0y = _mm256_sub_ps(y0, py);
+            const __m256 c1x = _mm256_add_ps(x0, mx), c1y = _mm256_add_ps(y0, my);
+            const __m256 c2x = _mm256_add_ps(x0, px), c2y = _mm256_add_ps(y0, py);
+            const __m256 c3x = _mm256_sub_ps(x0, mx), c3y = _mm256_sub_ps(y0, my);
+
+            // 8x8 transpose, row n becomes the quad of sprite n
+            const __m256 u0 = _mm256_unpacklo_ps(c0x, c0y);
+            const __m256 u1 = _mm256_unpackhi_ps(c0x, c0y);
+            const __m256 u2 = _mm256_unpacklo_ps(c1x, c1y);
+            const __m256 u3 = _mm256_unpackhi_ps(c1x, c1y);
+            const __m256 u4 = _mm256_unpacklo_ps(c2x, c2y);
+            const __m256 u5 = _mm256_unpackhi_ps(c2x, c2y);
+            const __m256 u6 = _mm256_unpacklo_ps(c3x, c3y);
+            const __m256 u7 = _mm256_unpackhi_ps(c3x, c3y);
+
+            const __m256 v0 = _mm256_shuffle_ps(u0, u2, _MM_SHUFFLE(1, 0, 1, 0));
+            const __m256 v1 = _mm256_shuffle_ps(u0, u2, _MM_SHUFFLE(3, 2, 3, 2));
+            const __m256 v2 = _mm256_shuffle_ps(u1, u3, _MM_SHUFFLE(1, 0, 1, 0));
+            const __m256 v3 = _mm256_shuffle_ps(u1, u3, _MM_SHUFFLE(3, 2, 3, 2));
+            const __m256 v4 = _mm256_shuffle_ps(u4, u6, _MM_SHUFFLE(1, 0, 1, 0));
+            const __m256 v5 = _mm256_shuffle_ps(u4, u6, _MM_SHUFFLE(3, 2, 3, 2));
+            const __m256 v6 = _mm256_shuffle_ps(u5, u7, _MM_SHUFFLE(1, 0, 1, 0));
+            const __m256 v7 = _mm256_shuffle_ps(u5, u7, _MM_SHUFFLE(3, 2, 3, 2));
+
+            auto* out = reinterpret_cast<float*>(quads + i);
+            _mm256_storeu_ps(out + 0, _mm256_permute2f128_ps(v0, v4, 0x20));
+            _mm256_storeu_ps(out + 8, _mm256_permute2f128_ps(v1, v5, 0x20));
+            _mm256_storeu_ps(out + 16, _mm256_permute2f128_ps(v2, v6, 0x20));
+            _mm256_storeu_ps(out + 24, _mm256_permute2f128_ps(v3, v7, 0x20));
+            _mm256_storeu_ps(out + 32, _mm256_permute2f128_ps(v0, v4, 0x31));
+            _mm256_storeu_ps(out + 40, _mm256_permute2f128_ps(v1, v5, 0x31));
+            _mm256_storeu_ps(out + 48, _mm256_permute2f128_ps(v2, v6, 0x31));
+            _mm256_storeu_ps(out + 56, _mm256_permute2f128_ps(v3, v7, 0x31));
+        }
+
+        TransformQuadsSSE2(rects + i, rotations + i, count - i, scale, quads + i);
+    }
+
+    WP_SimdLevel DetectSimdLevel() {
+#if defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] < 7) {
+            return WP_SimdLevel::SSE2;
+        }
+
+        __cpuid(info, 1);
+        const bool osxsave = (info[2] & (1 << 27)) != 0;
+        const bool fma = (info[2] & (1 << 12)) != 0;
+        // The OS has to save the YMM registers on context switches
+        const bool ymmEnabled = osxsave && (_xgetbv(0) & 0x6) == 0x6;
+
+        __cpuidex(info, 7, 0);
+        const bool avx2 = (info[1] & (1 << 5)) != 0;
+        return avx2 && fma && ymmEnabled ? WP_SimdLevel::AVX2 : WP_SimdLevel::SSE2;
+#else
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") ? WP_SimdLevel::AVX2 : WP_SimdLevel::SSE2;
+#endif
+    }
+#else
+    WP_SimdLevel DetectSimdLevel() {
+        return WP_SimdLevel::Scalar;
+    }
+#endif
+}
+
+WP_SimdLevel WP_GetSimdLevel() {
+    static const WP_SimdLevel level = DetectSimdLevel();
+    return level;
+}
+
+void WP_TransformQuads(const glm::vec4* rects, const float* rotations, size_t count, glm::vec2 screenSize, WP_Quad* quads) {
+    WP_TransformQuads(rects, rotations, count, screenSize, quads, WP_GetSimdLevel());
+}
+
+void WP_TransformQuads(const glm::vec4* rects, const float* rotations, size_t count, glm::vec2 screenSize, WP_Quad* quads, WP_SimdLevel level) {
+    const glm::vec2 scale(2.0f / screenSize.x, 2.0f / screenSize.y);
+
+    switch (std::min(level, WP_GetSimdLevel())) {
+#if defined(WOMP_MATH_X86)
+        case WP_SimdLevel::AVX2:
+            TransformQuadsAVX2(rects, rotations, count, scale, quads);
+            return;
+        case WP_SimdLevel::SSE2:
+            TransformQuadsSSE2(rects, rotations, count, scale, quads);
+            return;
+#endif
+        default:
+            TransformQuadsScalar(rects, rotations, count, scale, quads);
+    }
+}
@@ -15,17 +15,25 @@ namespace womp {
                 uint32_t binding,
                 VkDescriptorType type,
                 VkShaderStageFlags stageFlags,
-                uint32_t count = 1
+                uint32_t count = 1,
+                VkDescriptorBindingFlags bindingFlags = 0
             );
+            Builder& setLayoutFlags(VkDescriptorSetLayoutCreateFlags flags);
 
             std::unique_ptr<DescriptorSetLayout> build();
 
         private:
             Device& m_device;
             std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding> m_bindings{};
+            std::unordered_map<uint32_t, VkDescriptorBindingFlags> m_bindingFlags{};
+            VkDescriptorSetLayoutCreateFlags m_layoutFlags = 0;
         };
 
-        DescriptorSetLayout(Device& deviceRef, const std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding>& bindings);
+        DescriptorSetLayout(
+            Device& deviceRef,
+            const std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding>& bindings,
+            const std::unordered_map<uint32_t, VkDescriptorBindingFlags>& bindingFlags = {},
+            VkDescriptorSetLayoutCreateFlags layoutFlags = 0);
         ~DescriptorSetLayout();
         DescriptorSetLayout(const DescriptorSetLayout &) = delete;
         DescriptorSetLayout &operator=(const DescriptorSetLayout &) = delete;
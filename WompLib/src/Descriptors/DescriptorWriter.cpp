@@ -45,6 +45,25 @@ namespace womp {
         return *this;
     }
 
+    DescriptorWriter& DescriptorWriter::writeImage(uint32_t binding, uint32_t arrayElement, const VkDescriptorImageInfo* imageInfo) {
+        assert(m_setLayout.m_bindings.count(binding) == 1 && "Layout does not contain specified binding");
+
+        const auto &bindingDescription = m_setLayout.m_bindings[binding];
+
+        assert(arrayElement < bindingDescription.descriptorCount && "Array element out of range for binding");
+
+        VkWriteDescriptorSet write{};
+        write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        write.descriptorType = bindingDescription.descriptorType;
+        write.dstBinding = binding;
+        write.dstArrayElement = arrayElement;
+        write.pImageInfo = imageInfo;
+        write.descriptorCount = 1;
+
+        m_writes.push_back(write);
+        return *this;
+    }
+
     bool DescriptorWriter::build(VkDescriptorSet& set) {
         const bool success = m_pool.allocateDescriptor(m_setLayout.getDescriptorSetLayout(), set);
         if (!success) {
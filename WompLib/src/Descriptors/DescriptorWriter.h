@@ -12,6 +12,7 @@ namespace womp {
 
         DescriptorWriter& writeBuffer(uint32_t binding, const VkDescriptorBufferInfo* bufferInfo);
         DescriptorWriter& writeImage(uint32_t binding, const VkDescriptorImageInfo* imageInfo);
+        DescriptorWriter& writeImage(uint32_t binding, uint32_t arrayElement, const VkDescriptorImageInfo* imageInfo);
 
         bool build(VkDescriptorSet &set);
         void overwrite(const VkDescriptorSet &set);
@@ -0,0 +1,18 @@
+#ifndef BLENDMODE_H
+#define BLENDMODE_H
+
+#include <cstdint>
+
+namespace womp {
+    // How a draw's color is combined with what is below it, each mode is a pipeline variant
+    enum class BlendMode : uint8_t {
+        Alpha,          // Straight alpha, the default
+        Premultiplied,  // Color already multiplied by alpha
+        Additive,
+        Multiply,
+        Opaque,         // Overwrites, alpha is ignored
+        Count
+    };
+}
+
+#endif //BLENDMODE_H
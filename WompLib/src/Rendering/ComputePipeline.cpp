@@ -0,0 +1,44 @@
+#include "ComputePipeline.h"
+
+#include <stdexcept>
+
+namespace womp {
+    ComputePipeline::ComputePipeline(Device& device, const uint8_t* code, size_t size, VkPipelineLayout pipelineLayout,
+                                     VkPipelineCache pipelineCache)
+        : m_device(device) {
+        VkShaderModuleCreateInfo moduleInfo{};
+        moduleInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+        moduleInfo.codeSize = size;
+        moduleInfo.pCode = reinterpret_cast<const uint32_t*>(code);
+
+        if (vkCreateShaderModule(m_device.GetVkDevice(), &moduleInfo, nullptr, &m_shaderModule) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create shader module!");
+        }
+
+        VkPipelineShaderStageCreateInfo stageInfo{};
+        stageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        stageInfo.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+        stageInfo.module = m_shaderModule;
+        stageInfo.pName = "main";
+
+        VkComputePipelineCreateInfo pipelineInfo{};
+        pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        pipelineInfo.stage = stageInfo;
+        pipelineInfo.layout = pipelineLayout;
+        pipelineInfo.basePipelineIndex = -1;
+        pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+
+        if (vkCreateComputePipelines(m_device.GetVkDevice(), pipelineCache, 1, &pipelineInfo, nullptr, &m_computePipeline) != VK_SUCCESS) {
+            throw std::runtime_error("Can't make compute pipeline!");
+        }
+    }
+
+    ComputePipeline::~ComputePipeline() {
+        vkDestroyShaderModule(m_device.GetVkDevice(), m_shaderModule, nullptr);
+        vkDestroyPipeline(m_device.GetVkDevice(), m_computePipeline, nullptr);
+    }
+
+    void ComputePipeline::bind(VkCommandBuffer buffer) const {
+        vkCmdBindPipeline(buffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_computePipeline);
+    }
+}
@@ -0,0 +1,30 @@
+#ifndef COMPUTEPIPELINE_H
+#define COMPUTEPIPELINE_H
+
+#include <vector>
+
+#include "Rendering/Device.h"
+
+namespace womp {
+    class ComputePipeline {
+    public:
+        ComputePipeline(Device& device, const uint8_t* code, size_t size, VkPipelineLayout pipelineLayout,
+                        VkPipelineCache pipelineCache = VK_NULL_HANDLE);
+        ~ComputePipeline();
+
+        ComputePipeline(const ComputePipeline& other) = delete;
+        ComputePipeline(ComputePipeline&& other) noexcept = delete;
+        ComputePipeline& operator=(const ComputePipeline& other) = delete;
+        ComputePipeline& operator=(ComputePipeline&& other) noexcept = delete;
+
+        void bind(VkCommandBuffer buffer) const;
+
+    private:
+        Device& m_device;
+
+        VkPipeline m_computePipeline{VK_NULL_HANDLE};
+        VkShaderModule m_shaderModule{VK_NULL_HANDLE};
+    };
+}
+
+#endif //COMPUTEPIPELINE_H
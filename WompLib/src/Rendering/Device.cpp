@@ -1,5 +1,6 @@
 #include "Device.h"
 
+#include <algorithm>
 #include <iostream>
 
 #define VMA_IMPLEMENTATION
@@ -7,6 +8,7 @@
 #include <vma/vk_mem_alloc.h>
 
 #include "DebugLabel.h"
+#include "MipmapGenerator.h"
 
 namespace womp {
     PFN_vkCmdBeginRenderingKHR vkCmdBeginRenderingKHR = nullptr;
@@ -20,6 +22,8 @@ womp::Device::Device(womp::Window& window) : m_window(window) {
 }
 
 womp::Device::~Device() {
+    m_mipmapGenerator.reset();
+
     char* statsString;
     vmaBuildStatsString(m_allocator, &statsString, VK_TRUE);  // VK_TRUE = detailed
 
@@ -41,6 +45,20 @@ womp::Device::~Device() {
     vkb::destroy_instance(m_instance);
 }
 
+VkFormatProperties womp::Device::GetFormatProperties(VkFormat format) const {
+    VkFormatProperties props;
+    vkGetPhysicalDeviceFormatProperties(m_physicalDevice, format, &props);
+    return props;
+}
+
+womp::MipmapGenerator& womp::Device::GetMipmapGenerator() {
+    std::lock_guard lock{m_mipmapGeneratorMutex};
+    if (!m_mipmapGenerator) {
+        m_mipmapGenerator = std::make_unique<MipmapGenerator>(*this);
+    }
+    return *m_mipmapGenerator;
+}
+
 VkFormat womp::Device::FindSupportedFormat(const std::vector<VkFormat>& candidates, VkImageTiling tiling, VkFormatFeatureFlags features) const {
     for (const VkFormat format: candidates) {
         VkFormatProperties props;
@@ -56,66 +74,28 @@ VkFormat womp::Device::FindSupportedFormat(const std::vector<VkFormat>& candidat
     throw std::runtime_error("failed to find supported format!");
 }
 
-void womp::Device::TransitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout, uint32_t mipLevels) {
-    const VkCommandBuffer commandBuffer = beginSingleTimeCommands();
-    VkImageMemoryBarrier barrier{};
-    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-    barrier.oldLayout = oldLayout;
-    barrier.newLayout = newLayout;
-    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    barrier.image = image;
-    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-    barrier.subresourceRange.baseMipLevel = 0;
-    barrier.subresourceRange.levelCount = mipLevels;
-    barrier.subresourceRange.baseArrayLayer = 0;
-    barrier.subresourceRange.layerCount = 1;
-    barrier.srcAccessMask = 0;
-    barrier.dstAccessMask = 0;
-
-    vkCmdPipelineBarrier(
-        commandBuffer,
-        VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
-        VK_PIPELINE_STAGE_TRANSFER_BIT,
-        0,
-        0, nullptr,
-        0, nullptr,
-        1, &barrier
-    );
-
-    endSingleTimeCommands(commandBuffer);
+void womp::Device::SubmitGraphics(const VkSubmitInfo& submitInfo, VkFence fence) {
+    std::lock_guard lock{m_graphicsQueueMutex};
+    if (vkQueueSubmit(m_graphicsQueue, 1, &submitInfo, fence) != VK_SUCCESS) {
+        throw std::runtime_error("failed to submit to the graphics queue!");
+    }
 }
 
-VkCommandBuffer womp::Device::beginSingleTimeCommands() const {
-    VkCommandBufferAllocateInfo allocInfo{};
-    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-    allocInfo.commandPool = m_commandPool;
-    allocInfo.commandBufferCount = 1;
-
-    VkCommandBuffer commandBuffer;
-    vkAllocateCommandBuffers(m_device, &allocInfo, &commandBuffer);
-
-    VkCommandBufferBeginInfo beginInfo{};
-    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-
-    vkBeginCommandBuffer(commandBuffer, &beginInfo);
-    return commandBuffer;
+VkResult womp::Device::PresentGraphics(const VkPresentInfoKHR& presentInfo) {
+    std::lock_guard lock{m_graphicsQueueMutex};
+    return vkQueuePresentKHR(m_graphicsQueue, &presentInfo);
 }
 
-void womp::Device::endSingleTimeCommands(VkCommandBuffer commandBuffer) const {
-    vkEndCommandBuffer(commandBuffer);
-
-    VkSubmitInfo submitInfo{};
-    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    submitInfo.commandBufferCount = 1;
-    submitInfo.pCommandBuffers = &commandBuffer;
-
-    vkQueueSubmit(m_graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
-    vkQueueWaitIdle(m_graphicsQueue);
+void womp::Device::SubmitTransfer(const VkSubmitInfo& submitInfo, VkFence fence) {
+    if (!HasSeparateTransferQueue()) {
+        SubmitGraphics(submitInfo, fence);
+        return;
+    }
 
-    vkFreeCommandBuffers(m_device, m_commandPool, 1, &commandBuffer);
+    std::lock_guard lock{m_transferQueueMutex};
+    if (vkQueueSubmit(m_transferQueue, 1, &submitInfo, fence) != VK_SUCCESS) {
+        throw std::runtime_error("failed to submit to the transfer queue!");
+    }
 }
 
 void womp::Device::CreateDevice() {
@@ -140,6 +120,8 @@ void womp::Device::CreateDevice() {
 
     VkPhysicalDeviceFeatures device_features{};
     device_features.samplerAnisotropy = VK_TRUE;
+    // Clip rects are applied as clip distances by the sprite and text vertex shaders
+    device_features.shaderClipDistance = VK_TRUE;
 
     VkPhysicalDeviceDynamicRenderingFeaturesKHR dynamic_rendering_features{};
     dynamic_rendering_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES_KHR;
@@ -163,9 +145,66 @@ void womp::Device::CreateDevice() {
 
     m_physicalDevice = phys_ret.value();
 
-    vkb::DeviceBuilder device_builder{ phys_ret.value() };
+    // Descriptor indexing and indirect count are optional, WompRenderer falls back without them
+    VkPhysicalDeviceVulkan12Features supported_features_12{};
+    supported_features_12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+
+    VkPhysicalDeviceFeatures2 supported_features{};
+    supported_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    supported_features.pNext = &supported_features_12;
+    vkGetPhysicalDeviceFeatures2(m_physicalDevice, &supported_features);
+
+    m_bindlessSupported = supported_features_12.descriptorIndexing &&
+                          supported_features_12.runtimeDescriptorArray &&
+                          supported_features_12.descriptorBindingPartiallyBound &&
+                          supported_features_12.descriptorBindingSampledImageUpdateAfterBind &&
+                          supported_features_12.descriptorBindingUpdateUnusedWhilePending &&
+                          supported_features_12.shaderSampledImageArrayNonUniformIndexing;
+
+    VkPhysicalDeviceVulkan12Features features_12{};
+    features_12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+
+    if (m_bindlessSupported) {
+        features_12.descriptorIndexing = VK_TRUE;
+        features_12.runtimeDescriptorArray = VK_TRUE;
+        features_12.descriptorBindingPartiallyBound = VK_TRUE;
+        features_12.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+        features_12.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+        features_12.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+
+        VkPhysicalDeviceVulkan12Properties properties_12{};
+        properties_12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_PROPERTIES;
+
+        VkPhysicalDeviceProperties2 properties{};
+        properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+        properties.pNext = &properties_12;
+        vkGetPhysicalDeviceProperties2(m_physicalDevice, &properties);
+
+        m_maxBindlessTextures = std::min({
+            MAX_BINDLESS_TEXTURES,
+            properties_12.maxPerStageDescriptorUpdateAfterBindSamplers,
+            properties_12.maxPerStageDescriptorUpdateAfterBindSampledImages,
+            properties_12.maxDescriptorSetUpdateAfterBindSamplers,
+            properties_12.maxDescriptorSetUpdateAfterBindSampledImages
+        });
+    }
+
+    // Sprite data is pulled through buffer device addresses, there is no fallback for this one
+    if (!supported_features_12.bufferDeviceAddress) {
+        throw std::runtime_error("Selected device does not support bufferDeviceAddress");
+    }
+    features_12.bufferDeviceAddress = VK_TRUE;
+
+    m_drawIndirectCountSupported = supported_features_12.drawIndirectCount;
+    features_12.drawIndirectCount = supported_features_12.drawIndirectCount;
 
+    // KTX2 textures are block compressed, without it Image refuses them
+    VkPhysicalDeviceFeatures optional_features{};
+    optional_features.textureCompressionBC = VK_TRUE;
+    m_textureCompressionBCSupported = m_physicalDevice.enable_features_if_present(optional_features);
 
+    vkb::DeviceBuilder device_builder{ m_physicalDevice };
+    device_builder.add_pNext(&features_12);
 
     auto dev_ret = device_builder.build();
     if (!dev_ret) {
@@ -180,6 +219,19 @@ void womp::Device::CreateDevice() {
     }
     m_graphicsQueue = graphics_queue_ret.value();
 
+    // Uploads overlap rendering on a transfer only family, or any family other than graphics.
+    // vk-bootstrap creates a queue in every family, so there is nothing to request up front.
+    if (auto transfer_queue_ret = m_device.get_dedicated_queue(vkb::QueueType::transfer)) {
+        m_transferQueue = transfer_queue_ret.value();
+        m_transferQueueFamily = m_device.get_dedicated_queue_index(vkb::QueueType::transfer).value();
+    } else if (auto separate_queue_ret = m_device.get_queue(vkb::QueueType::transfer)) {
+        m_transferQueue = separate_queue_ret.value();
+        m_transferQueueFamily = m_device.get_queue_index(vkb::QueueType::transfer).value();
+    } else {
+        m_transferQueue = m_graphicsQueue;
+        m_transferQueueFamily = m_device.get_queue_index(vkb::QueueType::graphics).value();
+    }
+
     //
     //
     // vkCmdBeginRenderingKHR = reinterpret_cast<PFN_vkCmdBeginRenderingKHR>(vkGetDeviceProcAddr(m_device, "vkCmdBeginRenderingKHR"));
@@ -199,6 +251,7 @@ void womp::Device::CreateVma() {
     allocatorInfo.instance = m_instance;
     allocatorInfo.physicalDevice = m_device.physical_device;
     allocatorInfo.vulkanApiVersion = VK_API_VERSION_1_3;
+    allocatorInfo.flags = VMA_ALLOCATOR_CREATE_BUFFER_DEVICE_ADDRESS_BIT;
 
 
     if (vmaCreateAllocator(&allocatorInfo, &m_allocator) != VK_SUCCESS) {
@@ -1,6 +1,9 @@
 #ifndef DEVICE_H
 #define DEVICE_H
 
+#include <memory>
+#include <mutex>
+
 #include <womp/Window.h>
 #include "VkBootstrap.h"
 
@@ -12,25 +15,44 @@
 #include <vma/vk_mem_alloc.h>
 
 namespace womp {
+    class MipmapGenerator;
 
     class Device {
     public:
+        static constexpr uint32_t MAX_BINDLESS_TEXTURES = 4096;
+
         explicit Device(womp::Window& window);
         ~Device();
 
         vkb::Device& GetVkbDevice() { return m_device; }
         [[nodiscard]] VkDevice GetVkDevice() const { return m_device.device; }
 
+        [[nodiscard]] VkFormatProperties GetFormatProperties(VkFormat format) const;
         [[nodiscard]] VkFormat FindSupportedFormat(const std::vector<VkFormat>& candidates, VkImageTiling tiling, VkFormatFeatureFlags features) const;
 
+        [[nodiscard]] const VkPhysicalDeviceProperties& GetProperties() const { return m_physicalDevice.properties; }
+        [[nodiscard]] const VkPhysicalDeviceLimits& GetLimits() const { return m_physicalDevice.properties.limits; }
+
         [[nodiscard]] VkCommandPool getCommandPool() const { return m_commandPool; }
+        [[nodiscard]] uint32_t GetGraphicsQueueFamily() const { return m_device.get_queue_index(vkb::QueueType::graphics).value(); }
+        // The graphics family when there is no separate transfer family, as on lavapipe
+        [[nodiscard]] uint32_t GetTransferQueueFamily() const { return m_transferQueueFamily; }
+        [[nodiscard]] bool HasSeparateTransferQueue() const { return m_transferQueueFamily != GetGraphicsQueueFamily(); }
         [[nodiscard]] VmaAllocator getAllocator() const { return m_allocator; }
 
-        void TransitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout, uint32_t mipLevels);
+        [[nodiscard]] bool IsBindlessSupported() const { return m_bindlessSupported; }
+        [[nodiscard]] uint32_t GetMaxBindlessTextures() const { return m_maxBindlessTextures; }
+        [[nodiscard]] bool IsDrawIndirectCountSupported() const { return m_drawIndirectCountSupported; }
+        [[nodiscard]] bool IsTextureCompressionBCSupported() const { return m_textureCompressionBCSupported; }
 
-        VkCommandBuffer beginSingleTimeCommands() const;
+        // Created on first use, for formats that can't be mipmapped with blits
+        MipmapGenerator& GetMipmapGenerator();
 
-        void endSingleTimeCommands(VkCommandBuffer commandBuffer) const;
+        // The graphics queue is shared by frames and UploadBatches, which may submit from other threads
+        void SubmitGraphics(const VkSubmitInfo& submitInfo, VkFence fence);
+        VkResult PresentGraphics(const VkPresentInfoKHR& presentInfo);
+        // Same as SubmitGraphics without a separate transfer queue
+        void SubmitTransfer(const VkSubmitInfo& submitInfo, VkFence fence);
 
     private:
         void CreateDevice();
@@ -41,6 +63,10 @@ namespace womp {
         vkb::Device m_device{};
         vkb::PhysicalDevice m_physicalDevice{};
         VkQueue m_graphicsQueue{};
+        std::mutex m_graphicsQueueMutex{};
+        VkQueue m_transferQueue{};
+        uint32_t m_transferQueueFamily{};
+        std::mutex m_transferQueueMutex{};
 
         VkSurfaceKHR m_surface{};
 
@@ -48,6 +74,14 @@ namespace womp {
 
         VkCommandPool m_commandPool{};
 
+        bool m_bindlessSupported{false};
+        uint32_t m_maxBindlessTextures{0};
+        bool m_drawIndirectCountSupported{false};
+        bool m_textureCompressionBCSupported{false};
+
+        std::unique_ptr<MipmapGenerator> m_mipmapGenerator{};
+        std::mutex m_mipmapGeneratorMutex{};
+
         womp::Window& m_window;
     };
 }
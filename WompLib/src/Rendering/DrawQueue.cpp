@@ -0,0 +1,145 @@
+#include "DrawQueue.h"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+
+namespace womp {
+    std::atomic<uint64_t> DrawQueue::s_nextId{1};
+
+    DrawQueue::DrawQueue(): m_id{s_nextId.fetch_add(1, std::memory_order_relaxed)} {
+    }
+
+    void DrawQueue::submit(TextureHandle texture, const glm::vec4& srcRect, const glm::vec4& dstRect, float rotation, const glm::vec4& color) {
+        Chunk& chunk = localChunk();
+        // A clip rect is stored once for the run of draws under it
+        if (chunk.clip == PENDING_CLIP) {
+            chunk.commands.clipRects.push_back(chunk.clipStack.back());
+            chunk.clip = static_cast<uint32_t>(chunk.commands.clipRects.size());
+        }
+        chunk.commands.push(texture, chunk.layer, srcRect, dstRect, rotation, color, chunk.blendMode, chunk.clip);
+    }
+
+    void DrawQueue::setLayer(uint8_t layer) {
+        localChunk().layer = layer;
+    }
+
+    void DrawQueue::setBlendMode(BlendMode blendMode) {
+        localChunk().blendMode = blendMode;
+    }
+
+    void DrawQueue::pushClip(const glm::vec4& clipRect) {
+        Chunk& chunk = localChunk();
+        chunk.clipStack.push_back(chunk.clipStack.empty() ? clipRect : IntersectClipRects(chunk.clipStack.back(), clipRect));
+        chunk.clip = PENDING_CLIP;
+    }
+
+    void DrawQueue::popClip() {
+        Chunk& chunk = localChunk();
+        assert(!chunk.clipStack.empty() && "popClip without a matching pushClip");
+        if (chunk.clipStack.empty()) return;
+
+        chunk.clipStack.pop_back();
+        chunk.clip = chunk.clipStack.empty() ? 0 : PENDING_CLIP;
+    }
+
+    glm::vec4 DrawQueue::getClip() {
+        const Chunk& chunk = localChunk();
+        return chunk.clipStack.empty() ? UnclippedRect() : chunk.clipStack.back();
+    }
+
+    void DrawQueue::setSubmitOrder(uint32_t order) {
+        localChunk().order = order;
+    }
+
+    void DrawQueue::merge(DrawStreams& out) {
+        std::lock_guard lock{m_pool->mutex};
+
+        m_mergeOrder.clear();
+        size_t total = out.size();
+        for (const auto& chunk: m_pool->chunks) {
+            if (!chunk->commands.empty()) {
+                m_mergeOrder.push_back(chunk.get());
+                total += chunk->commands.size();
+            }
+        }
+
+        // The clip rects go with the commands, a clip still pushed is stored again by the next draw under it
+        for (Chunk* chunk: m_mergeOrder) {
+            chunk->clip = chunk->clipStack.empty() ? 0 : PENDING_CLIP;
+        }
+
+        if (m_mergeOrder.size() == 1 && out.empty()) {
+            // Single producer, hand the chunk's storage over instead of copying it
+            std::swap(out, m_mergeOrder.front()->commands);
+        } else {
+            std::sort(m_mergeOrder.begin(), m_mergeOrder.end(), [](const Chunk* a, const Chunk* b) {
+                return a->order != b->order ? a->order < b->order : a->registration < b->registration;
+            });
+
+            out.reserve(total);
+            for (Chunk* chunk: m_mergeOrder) {
+                out.append(chunk->commands);
+                chunk->commands.clear();
+            }
+        }
+
+        // Chunks of exited threads are empty now and can be handed out again
+        for (const auto& chunk: m_pool->chunks) {
+            if (chunk->state == ChunkState::Released) {
+                chunk->state = ChunkState::Free;
+                m_pool->free.push_back(chunk.get());
+            }
+        }
+    }
+
+    DrawQueue::Chunk& DrawQueue::localChunk() {
+        // Ids are never reused, so entries left behind by destroyed queues can't match
+        for (const ThreadChunk& entry: threadChunks()) {
+            if (entry.queueId == m_id) {
+                return *entry.chunk;
+            }
+        }
+        return registerThread();
+    }
+
+    DrawQueue::Chunk& DrawQueue::registerThread() {
+        // Entries of destroyed queues are dropped here, off the submit path
+        auto& entries = threadChunks();
+        std::erase_if(entries, [](const ThreadChunk& entry) { return entry.pool.expired(); });
+
+        std::lock_guard lock{m_pool->mutex};
+
+        Chunk* chunk;
+        if (!m_pool->free.empty()) {
+            chunk = m_pool->free.back();
+            m_pool->free.pop_back();
+            chunk->layer = 0;
+            chunk->blendMode = BlendMode::Alpha;
+            chunk->clipStack.clear();
+            chunk->clip = 0;
+        } else {
+            chunk = m_pool->chunks.emplace_back(std::make_unique<Chunk>()).get();
+        }
+        chunk->state = ChunkState::Owned;
+        chunk->order = std::numeric_limits<uint32_t>::max();
+        chunk->registration = m_pool->nextRegistration++;
+
+        entries.push_back(ThreadChunk{m_id, chunk, m_pool});
+        return *chunk;
+    }
+
+    DrawQueue::ThreadChunks::~ThreadChunks() {
+        for (const ThreadChunk& entry: entries) {
+            if (const auto pool = entry.pool.lock()) {
+                std::lock_guard lock{pool->mutex};
+                entry.chunk->state = ChunkState::Released;
+            }
+        }
+    }
+
+    std::vector<DrawQueue::ThreadChunk>& DrawQueue::threadChunks() {
+        thread_local ThreadChunks chunks;
+        return chunks.entries;
+    }
+}
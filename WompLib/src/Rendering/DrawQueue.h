@@ -0,0 +1,193 @@
+#ifndef DRAWQUEUE_H
+#define DRAWQUEUE_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include <womp/WompMath.h>
+
+#include "Rendering/BlendMode.h"
+
+namespace womp {
+    using TextureHandle = uint32_t;
+
+    // Clip rects are min xy, max xy in screen pixels. Unclipped draws use a rect far outside any screen.
+    inline glm::vec4 UnclippedRect() {
+        return glm::vec4(-1e30f, -1e30f, 1e30f, 1e30f);
+    }
+
+    inline glm::vec4 IntersectClipRects(const glm::vec4& a, const glm::vec4& b) {
+        const glm::vec2 min = glm::max(glm::vec2(a.x, a.y), glm::vec2(b.x, b.y));
+        // An empty intersection collapses to a point instead of inverting
+        return glm::vec4(min, glm::max(min, glm::min(glm::vec2(a.z, a.w), glm::vec2(b.z, b.w))));
+    }
+
+    // layer:8 | group:24 | sequence:32, most significant first. The group stands in for the pipeline and texture,
+    // see GroupDraws.
+    constexpr uint32_t MAX_DRAW_GROUP = 0xFFFFFF;
+
+    inline uint64_t MakeSortKey(uint8_t layer, uint32_t group, uint32_t sequence) {
+        return static_cast<uint64_t>(layer) << 56 |
+               static_cast<uint64_t>(group & MAX_DRAW_GROUP) << 32 |
+               sequence;
+    }
+
+    // Pending draws, one stream per field. Sorting and batching only read textures, layers and blend modes,
+    // the other streams are read once when the instances are written.
+    struct DrawStreams {
+        std::vector<TextureHandle> textures{};
+        std::vector<uint8_t> layers{};
+        std::vector<BlendMode> blendModes{};
+        std::vector<glm::vec4> srcRects{};  // Normalized UVs
+        std::vector<glm::vec4> dstRects{};
+        std::vector<glm::vec4> colors{};
+        std::vector<float> rotations{};
+        std::vector<uint32_t> clips{};      // 0 for unclipped draws, else one past their index in clipRects
+        std::vector<glm::vec4> clipRects{};
+
+        [[nodiscard]] size_t size() const { return textures.size(); }
+        [[nodiscard]] bool empty() const { return textures.empty(); }
+
+        void push(TextureHandle texture, uint8_t layer, const glm::vec4& srcRect, const glm::vec4& dstRect, float rotation, const glm::vec4& color,
+                  BlendMode blendMode = BlendMode::Alpha, uint32_t clip = 0) {
+            textures.push_back(texture);
+            layers.push_back(layer);
+            blendModes.push_back(blendMode);
+            srcRects.push_back(srcRect);
+            dstRects.push_back(dstRect);
+            colors.push_back(color);
+            rotations.push_back(rotation);
+            clips.push_back(clip);
+        }
+
+        void append(const DrawStreams& other) {
+            textures.insert(textures.end(), other.textures.begin(), other.textures.end());
+            layers.insert(layers.end(), other.layers.begin(), other.layers.end());
+            blendModes.insert(blendModes.end(), other.blendModes.begin(), other.blendModes.end());
+            srcRects.insert(srcRects.end(), other.srcRects.begin(), other.srcRects.end());
+            dstRects.insert(dstRects.end(), other.dstRects.begin(), other.dstRects.end());
+            colors.insert(colors.end(), other.colors.begin(), other.colors.end());
+            rotations.insert(rotations.end(), other.rotations.begin(), other.rotations.end());
+
+            // Clip indices move past the clip rects already here
+            const auto clipOffset = static_cast<uint32_t>(clipRects.size());
+            const size_t firstClip = clips.size();
+            clips.insert(clips.end(), other.clips.begin(), other.clips.end());
+            for (size_t i = firstClip; i < clips.size(); ++i) {
+                clips[i] += clips[i] != 0 ? clipOffset : 0;
+            }
+            clipRects.insert(clipRects.end(), other.clipRects.begin(), other.clipRects.end());
+        }
+
+        void reserve(size_t count) {
+            textures.reserve(count);
+            layers.reserve(count);
+            blendModes.reserve(count);
+            srcRects.reserve(count);
+            dstRects.reserve(count);
+            colors.reserve(count);
+            rotations.reserve(count);
+            clips.reserve(count);
+        }
+
+        void clear() {
+            textures.clear();
+            layers.clear();
+            blendModes.clear();
+            srcRects.clear();
+            dstRects.clear();
+            colors.clear();
+            rotations.clear();
+            clips.clear();
+            clipRects.clear();
+        }
+    };
+
+    // Draw commands submitted from any number of threads. Every thread appends to its own chunk,
+    // only the first submission of a thread takes a lock to register that chunk.
+    // merge() concatenates the chunks ordered by their submit order, then by registration, and must
+    // not run while other threads are still submitting. A thread's chunk is released when the thread
+    // exits and reused, with its capacity, by the next thread to register once its draws are merged.
+    class DrawQueue {
+    public:
+        DrawQueue();
+
+        DrawQueue(const DrawQueue& other) = delete;
+        DrawQueue(DrawQueue&& other) noexcept = delete;
+        DrawQueue& operator=(const DrawQueue& other) = delete;
+        DrawQueue& operator=(DrawQueue&& other) noexcept = delete;
+
+        // srcRect is expected in normalized UVs, the draw goes on the calling thread's current layer
+        void submit(TextureHandle texture, const glm::vec4& srcRect, const glm::vec4& dstRect, float rotation, const glm::vec4& color);
+
+        // Only affect the calling thread. A pushed clip rect is intersected with the current one and applies
+        // to the thread's draws until it is popped, across frames if it is never popped.
+        void setLayer(uint8_t layer);
+        void setBlendMode(BlendMode blendMode);
+        void pushClip(const glm::vec4& clipRect);
+        void popClip();
+        // Top of the calling thread's clip stack, UnclippedRect() when it is empty
+        [[nodiscard]] glm::vec4 getClip();
+        // Give producer threads distinct orders for the merged stream to be the same every run
+        void setSubmitOrder(uint32_t order);
+
+        // Appends every chunk to out and empties them, chunks keep their capacity
+        void merge(DrawStreams& out);
+
+    private:
+        static constexpr uint32_t PENDING_CLIP = ~0u;
+
+        enum class ChunkState : uint8_t {
+            Owned,      // A live thread submits to it
+            Released,   // Its thread exited, the draws still in it are merged before it is reused
+            Free
+        };
+
+        struct Chunk {
+            DrawStreams commands{};
+            uint32_t order{};
+            uint32_t registration{};
+            uint8_t layer{};
+            BlendMode blendMode{BlendMode::Alpha};
+            std::vector<glm::vec4> clipStack{};
+            uint32_t clip{};    // Clip index of the next draw, PENDING_CLIP until the top of the stack is in commands.clipRects
+            ChunkState state{ChunkState::Owned};
+        };
+
+        // Shared with the threads that hold a chunk, so a thread exiting after the queue is gone finds nothing to release
+        struct ChunkPool {
+            std::mutex mutex;
+            std::vector<std::unique_ptr<Chunk>> chunks{};
+            std::vector<Chunk*> free{};
+            uint32_t nextRegistration{};
+        };
+
+        struct ThreadChunk {
+            uint64_t queueId;
+            Chunk* chunk;
+            std::weak_ptr<ChunkPool> pool;
+        };
+
+        // Every chunk a thread holds, released to their queues when the thread exits
+        struct ThreadChunks {
+            std::vector<ThreadChunk> entries{};
+            ~ThreadChunks();
+        };
+
+        Chunk& localChunk();
+        Chunk& registerThread();
+        static std::vector<ThreadChunk>& threadChunks();
+
+        static std::atomic<uint64_t> s_nextId;
+        const uint64_t m_id;
+
+        std::shared_ptr<ChunkPool> m_pool{std::make_shared<ChunkPool>()};
+        std::vector<Chunk*> m_mergeOrder{};
+    };
+}
+
+#endif //DRAWQUEUE_H
@@ -0,0 +1,226 @@
+#include "MipmapGenerator.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <stdexcept>
+
+#include "Descriptors/DescriptorWriter.h"
+#include "Rendering/Resources/Image.h"
+
+#include "mipmap_comp_spv.h"
+
+namespace {
+    constexpr uint32_t WORKGROUP_SIZE = 8;
+
+    // mipmap.comp reads and writes rgba8, sRGB images are viewed as UNORM and converted in the shader
+    VkFormat GetStorageFormat(VkFormat format) {
+        switch (format) {
+            case VK_FORMAT_R8G8B8A8_SRGB:
+            case VK_FORMAT_R8G8B8A8_UNORM:
+                return VK_FORMAT_R8G8B8A8_UNORM;
+            default:
+                return VK_FORMAT_UNDEFINED;
+        }
+    }
+
+    VkImageMemoryBarrier LevelBarrier(VkImage image, uint32_t baseLevel, uint32_t levelCount, VkImageLayout oldLayout, VkImageLayout newLayout,
+                                      VkAccessFlags srcAccess, VkAccessFlags dstAccess) {
+        VkImageMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.oldLayout = oldLayout;
+        barrier.newLayout = newLayout;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image = image;
+        barrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, baseLevel, levelCount, 0, 1};
+        barrier.srcAccessMask = srcAccess;
+        barrier.dstAccessMask = dstAccess;
+        return barrier;
+    }
+}
+
+namespace womp {
+    MipmapGenerator::MipmapGenerator(Device& device): m_device{device} {
+        m_descriptorSetLayout = DescriptorSetLayout::Builder(device)
+                .addBinding(0, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT)
+                .addBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT)
+                .build();
+
+        VkPushConstantRange pushConstantRange{};
+        pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        pushConstantRange.offset = 0;
+        pushConstantRange.size = sizeof(PushConstants);
+
+        const VkDescriptorSetLayout setLayout = m_descriptorSetLayout->getDescriptorSetLayout();
+
+        VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+        pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        pipelineLayoutInfo.setLayoutCount = 1;
+        pipelineLayoutInfo.pSetLayouts = &setLayout;
+        pipelineLayoutInfo.pushConstantRangeCount = 1;
+        pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+        if (vkCreatePipelineLayout(device.GetVkDevice(), &pipelineLayoutInfo, nullptr, &m_pipelineLayout) != VK_SUCCESS) {
+            throw std::runtime_error("Could not make mipmap pipeline layout");
+        }
+
+        m_pipeline = std::make_unique<ComputePipeline>(
+            device,
+            reinterpret_cast<const uint8_t*>(mipmap_comp_spv),
+            mipmap_comp_spv_len,
+            m_pipelineLayout
+        );
+    }
+
+    MipmapGenerator::~MipmapGenerator() {
+        m_pipeline.reset();
+        vkDestroyPipelineLayout(m_device.GetVkDevice(), m_pipelineLayout, nullptr);
+        m_descriptorSetLayout.reset();
+    }
+
+    uint32_t MipmapGenerator::GetMipLevels(VkExtent2D size) {
+        return static_cast<uint32_t>(std::bit_width(std::max({size.width, size.height, 1u})));
+    }
+
+    bool MipmapGenerator::CanBlit(const Device& device, VkFormat format) {
+        constexpr VkFormatFeatureFlags required =
+                VK_FORMAT_FEATURE_BLIT_SRC_BIT |
+                VK_FORMAT_FEATURE_BLIT_DST_BIT |
+                VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+        return (device.GetFormatProperties(format).optimalTilingFeatures & required) == required;
+    }
+
+    void MipmapGenerator::GetImageRequirements(const Device& device, VkFormat format, VkImageUsageFlags& usage, VkImageCreateFlags& flags) {
+        usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+        if (CanBlit(device, format)) {
+            return;
+        }
+
+        const VkFormat storageFormat = GetStorageFormat(format);
+        if (storageFormat == VK_FORMAT_UNDEFINED || !(device.GetFormatProperties(storageFormat).optimalTilingFeatures & VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT)) {
+            throw std::runtime_error("Mipmaps can't be generated for this format, it can neither be blitted nor written by mipmap.comp");
+        }
+
+        usage |= VK_IMAGE_USAGE_STORAGE_BIT;
+        if (storageFormat != format) {
+            // Storage usage is only valid for the UNORM views
+            flags |= VK_IMAGE_CREATE_MUTABLE_FORMAT_BIT | VK_IMAGE_CREATE_EXTENDED_USAGE_BIT;
+        }
+    }
+
+    void MipmapGenerator::RecordBlits(VkCommandBuffer commandBuffer, const Image& image) {
+        const VkImage handle = image.getImage();
+        const uint32_t levels = image.GetMipLevels();
+
+        auto width = static_cast<int32_t>(image.GetExtent().width);
+        auto height = static_cast<int32_t>(image.GetExtent().height);
+
+        for (uint32_t level = 1; level < levels; ++level) {
+            // The level blitted from becomes a source, and the one blitted from before it is done.
+            // One barrier call per level.
+            std::array<VkImageMemoryBarrier, 2> barriers{};
+            uint32_t barrierCount = 0;
+            VkPipelineStageFlags dstStages = VK_PIPELINE_STAGE_TRANSFER_BIT;
+
+            barriers[barrierCount++] = LevelBarrier(handle, level - 1, 1, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                                                    VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT);
+            if (level > 1) {
+                barriers[barrierCount++] = LevelBarrier(handle, level - 2, 1, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                                        VK_ACCESS_TRANSFER_READ_BIT, VK_ACCESS_SHADER_READ_BIT);
+                dstStages |= VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+            }
+            vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, dstStages, 0, 0, nullptr, 0, nullptr, barrierCount, barriers.data());
+
+            const int32_t nextWidth = std::max(width / 2, 1);
+            const int32_t nextHeight = std::max(height / 2, 1);
+
+            VkImageBlit blit{};
+            blit.srcSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, level - 1, 0, 1};
+            blit.srcOffsets[1] = {width, height, 1};
+            blit.dstSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, level, 0, 1};
+            blit.dstOffsets[1] = {nextWidth, nextHeight, 1};
+            vkCmdBlitImage(commandBuffer, handle, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, handle, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit, VK_FILTER_LINEAR);
+
+            width = nextWidth;
+            height = nextHeight;
+        }
+
+        // The last source and the last level
+        std::array<VkImageMemoryBarrier, 2> barriers{};
+        uint32_t barrierCount = 0;
+        if (levels > 1) {
+            barriers[barrierCount++] = LevelBarrier(handle, levels - 2, 1, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                                    VK_ACCESS_TRANSFER_READ_BIT, VK_ACCESS_SHADER_READ_BIT);
+        }
+        barriers[barrierCount++] = LevelBarrier(handle, levels - 1, 1, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                                VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT);
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, barrierCount, barriers.data());
+    }
+
+    MipmapGenerator::Resources MipmapGenerator::recordDownsample(VkCommandBuffer commandBuffer, const Image& image) {
+        const VkImage handle = image.getImage();
+        const uint32_t levels = image.GetMipLevels();
+        const VkFormat storageFormat = GetStorageFormat(image.GetFormat());
+
+        Resources resources;
+        resources.descriptorPool = DescriptorPool::Builder(m_device)
+                .setMaxSets(std::max(levels - 1, 1u))
+                .addPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, std::max(levels - 1, 1u) * 2)
+                .build();
+        for (uint32_t level = 0; level < levels; ++level) {
+            resources.views.push_back(std::make_unique<ImageView>(m_device, handle, storageFormat, VK_IMAGE_ASPECT_COLOR_BIT, 1, level));
+        }
+
+        const VkImageMemoryBarrier toGeneral = LevelBarrier(handle, 0, levels, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_GENERAL,
+                                                            VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &toGeneral);
+
+        m_pipeline->bind(commandBuffer);
+
+        auto width = static_cast<int32_t>(image.GetExtent().width);
+        auto height = static_cast<int32_t>(image.GetExtent().height);
+
+        for (uint32_t level = 1; level < levels; ++level) {
+            const int32_t nextWidth = std::max(width / 2, 1);
+            const int32_t nextHeight = std::max(height / 2, 1);
+
+            const VkDescriptorImageInfo source{VK_NULL_HANDLE, resources.views[level - 1]->getHandle(), VK_IMAGE_LAYOUT_GENERAL};
+            const VkDescriptorImageInfo destination{VK_NULL_HANDLE, resources.views[level]->getHandle(), VK_IMAGE_LAYOUT_GENERAL};
+
+            VkDescriptorSet set;
+            DescriptorWriter(*m_descriptorSetLayout, *resources.descriptorPool)
+                    .writeImage(0, &source)
+                    .writeImage(1, &destination)
+                    .build(set);
+            vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_pipelineLayout, 0, 1, &set, 0, nullptr);
+
+            const PushConstants push{
+                .sourceSize = {width, height},
+                .destinationSize = {nextWidth, nextHeight},
+                .srgb = storageFormat != image.GetFormat() ? 1u : 0u
+            };
+            vkCmdPushConstants(commandBuffer, m_pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(PushConstants), &push);
+            vkCmdDispatch(
+                commandBuffer,
+                (static_cast<uint32_t>(nextWidth) + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE,
+                (static_cast<uint32_t>(nextHeight) + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE,
+                1
+            );
+
+            // The next level reads this one
+            const VkImageMemoryBarrier written = LevelBarrier(handle, level, 1, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_GENERAL,
+                                                              VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT);
+            vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &written);
+
+            width = nextWidth;
+            height = nextHeight;
+        }
+
+        const VkImageMemoryBarrier toShaderRead = LevelBarrier(handle, 0, levels, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                                               VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT);
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &toShaderRead);
+
+        return resources;
+    }
+}
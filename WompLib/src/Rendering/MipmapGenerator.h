@@ -0,0 +1,59 @@
+#ifndef MIPMAPGENERATOR_H
+#define MIPMAPGENERATOR_H
+
+#include <memory>
+#include <vector>
+
+#include "Rendering/ComputePipeline.h"
+#include "Rendering/Device.h"
+#include "Descriptors/DescriptorPool.h"
+#include "Descriptors/DescriptorSetLayout.h"
+#include "Rendering/Resources/ImageView.h"
+
+namespace womp {
+    class Image;
+
+    // Fills the levels of an image below the first one, each from the level above it. A vkCmdBlitImage
+    // cascade where the format allows linear blits, mipmap.comp otherwise. Both record on a queue with
+    // graphics support and leave every level shader readable.
+    class MipmapGenerator {
+    public:
+        // Views and descriptor sets a downsample recorded with, kept until its commands have completed
+        struct Resources {
+            std::unique_ptr<DescriptorPool> descriptorPool{};
+            std::vector<std::unique_ptr<ImageView>> views{};
+        };
+
+        explicit MipmapGenerator(Device& device);
+        ~MipmapGenerator();
+
+        MipmapGenerator(const MipmapGenerator& other) = delete;
+        MipmapGenerator(MipmapGenerator&& other) noexcept = delete;
+        MipmapGenerator& operator=(const MipmapGenerator& other) = delete;
+        MipmapGenerator& operator=(MipmapGenerator&& other) noexcept = delete;
+
+        [[nodiscard]] static uint32_t GetMipLevels(VkExtent2D size);
+        [[nodiscard]] static bool CanBlit(const Device& device, VkFormat format);
+        // Usage and create flags a mipmapped image of format needs on top of its own
+        static void GetImageRequirements(const Device& device, VkFormat format, VkImageUsageFlags& usage, VkImageCreateFlags& flags);
+
+        // Every level has to be in TRANSFER_DST_OPTIMAL with the first one written
+        static void RecordBlits(VkCommandBuffer commandBuffer, const Image& image);
+        // Same, through compute. The returned resources have to outlive the recorded commands.
+        [[nodiscard]] Resources recordDownsample(VkCommandBuffer commandBuffer, const Image& image);
+
+    private:
+        struct PushConstants {
+            int32_t sourceSize[2];
+            int32_t destinationSize[2];
+            uint32_t srgb;
+        };
+
+        Device& m_device;
+        std::unique_ptr<DescriptorSetLayout> m_descriptorSetLayout{};
+        VkPipelineLayout m_pipelineLayout{VK_NULL_HANDLE};
+        std::unique_ptr<ComputePipeline> m_pipeline{};
+    };
+}
+
+#endif //MIPMAPGENERATOR_H
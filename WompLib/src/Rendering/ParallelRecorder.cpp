@@ -0,0 +1,94 @@
+#include "ParallelRecorder.h"
+
+#include <stdexcept>
+#include <string>
+
+#include "DebugLabel.h"
+
+namespace womp {
+    ParallelRecorder::ParallelRecorder(Device& device, uint32_t workerCount): m_device{device}, m_threadPool{workerCount} {
+        VkCommandPoolCreateInfo poolInfo{};
+        poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        poolInfo.queueFamilyIndex = m_device.GetGraphicsQueueFamily();
+        poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+
+        for (auto& framePools: m_framePools) {
+            framePools.resize(m_threadPool.getThreadCount());
+            for (auto& pools: framePools) {
+                if (vkCreateCommandPool(m_device.GetVkDevice(), &poolInfo, nullptr, &pools.pool) != VK_SUCCESS) {
+                    throw std::runtime_error("failed to create secondary command pool!");
+                }
+            }
+        }
+    }
+
+    ParallelRecorder::~ParallelRecorder() {
+        for (auto& framePools: m_framePools) {
+            for (auto& pools: framePools) {
+                // Destroying the pool frees its command buffers
+                vkDestroyCommandPool(m_device.GetVkDevice(), pools.pool, nullptr);
+            }
+        }
+    }
+
+    const std::vector<VkCommandBuffer>& ParallelRecorder::record(
+        int frameIndex,
+        uint32_t jobCount,
+        const VkCommandBufferInheritanceRenderingInfo& renderingInfo,
+        const std::function<void(VkCommandBuffer, uint32_t)>& recordJob
+    ) {
+        auto& framePools = m_framePools[frameIndex];
+        for (auto& pools: framePools) {
+            vkResetCommandPool(m_device.GetVkDevice(), pools.pool, 0);
+            pools.used = 0;
+        }
+
+        m_recorded.assign(jobCount, VK_NULL_HANDLE);
+
+        m_threadPool.run(jobCount, [&](uint32_t job, uint32_t threadIndex) {
+            const VkCommandBuffer commandBuffer = acquireBuffer(framePools[threadIndex], threadIndex);
+
+            VkCommandBufferInheritanceInfo inheritanceInfo{};
+            inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+            inheritanceInfo.pNext = &renderingInfo;
+
+            VkCommandBufferBeginInfo beginInfo{};
+            beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+            beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+            beginInfo.pInheritanceInfo = &inheritanceInfo;
+
+            if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) {
+                throw std::runtime_error("failed to begin recording secondary command buffer!");
+            }
+
+            recordJob(commandBuffer, job);
+
+            if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
+                throw std::runtime_error("failed to record secondary command buffer!");
+            }
+
+            m_recorded[job] = commandBuffer;
+        });
+
+        return m_recorded;
+    }
+
+    VkCommandBuffer ParallelRecorder::acquireBuffer(ThreadPools& pools, uint32_t threadIndex) const {
+        if (pools.used == pools.buffers.size()) {
+            VkCommandBufferAllocateInfo allocInfo{};
+            allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+            allocInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+            allocInfo.commandPool = pools.pool;
+            allocInfo.commandBufferCount = 1;
+
+            VkCommandBuffer commandBuffer{};
+            if (vkAllocateCommandBuffers(m_device.GetVkDevice(), &allocInfo, &commandBuffer) != VK_SUCCESS) {
+                throw std::runtime_error("failed to allocate secondary command buffer!");
+            }
+            DebugLabel::NameCommandBuffer(commandBuffer, "Secondary CommandBuffer: " + std::to_string(threadIndex) + "/" + std::to_string(pools.buffers.size()));
+            pools.buffers.push_back(commandBuffer);
+        }
+
+        return pools.buffers[pools.used++];
+    }
+}
@@ -0,0 +1,54 @@
+#ifndef PARALLELRECORDER_H
+#define PARALLELRECORDER_H
+
+#include <array>
+#include <functional>
+#include <vector>
+
+#include "Core/ThreadPool.h"
+#include "Rendering/Device.h"
+#include "Rendering/Swapchain.h"
+
+namespace womp {
+    // Records secondary command buffers on a worker pool. Every thread has its own command pool per
+    // frame in flight, which is reset as a whole once that frame comes around again.
+    class ParallelRecorder {
+    public:
+        ParallelRecorder(Device& device, uint32_t workerCount);
+        ~ParallelRecorder();
+
+        ParallelRecorder(const ParallelRecorder& other) = delete;
+        ParallelRecorder(ParallelRecorder&& other) noexcept = delete;
+        ParallelRecorder& operator=(const ParallelRecorder& other) = delete;
+        ParallelRecorder& operator=(ParallelRecorder&& other) noexcept = delete;
+
+        [[nodiscard]] uint32_t getThreadCount() const { return m_threadPool.getThreadCount(); }
+
+        // Runs recordJob for every job on its own secondary command buffer, which continues the dynamic
+        // rendering described by renderingInfo. The buffers are returned in job order for vkCmdExecuteCommands.
+        // Only call after the frame's fence has been waited on.
+        const std::vector<VkCommandBuffer>& record(
+            int frameIndex,
+            uint32_t jobCount,
+            const VkCommandBufferInheritanceRenderingInfo& renderingInfo,
+            const std::function<void(VkCommandBuffer, uint32_t)>& recordJob
+        );
+
+    private:
+        struct ThreadPools {
+            VkCommandPool pool{};
+            std::vector<VkCommandBuffer> buffers{};
+            uint32_t used{};
+        };
+
+        VkCommandBuffer acquireBuffer(ThreadPools& pools, uint32_t threadIndex) const;
+
+        Device& m_device;
+        ThreadPool m_threadPool;
+
+        std::array<std::vector<ThreadPools>, Swapchain::MAX_FRAMES_IN_FLIGHT> m_framePools{};
+        std::vector<VkCommandBuffer> m_recorded{};
+    };
+}
+
+#endif //PARALLELRECORDER_H
@@ -0,0 +1,48 @@
+#include <womp/ParticleEmitter.h>
+
+#include <algorithm>
+#include <cassert>
+
+#include <womp/WompRenderer.h>
+
+namespace womp {
+    ParticleEmitter::ParticleEmitter(const WompRenderer& renderer, uint32_t capacity, const ParticleEmitterSettings& settings):
+        m_renderer{renderer}, m_capacity{capacity} {
+        assert(capacity > 0 && "Particle emitter needs room for at least one particle");
+        setSettings(settings);
+    }
+
+    void ParticleEmitter::update(float deltaTime) {
+        if (deltaTime <= 0.0f) {
+            return;
+        }
+
+        const float spawns = m_settings.spawnRate * deltaTime + m_spawnRemainder;
+        const auto wholeSpawns = static_cast<uint32_t>(spawns);
+        m_spawnRemainder = spawns - static_cast<float>(wholeSpawns);
+
+        m_pendingSpawns = std::min(m_pendingSpawns + wholeSpawns, m_capacity);
+        m_pendingTime += deltaTime;
+        m_revision = NextRevision();
+    }
+
+    void ParticleEmitter::burst(uint32_t count) {
+        m_pendingSpawns = std::min(m_pendingSpawns + std::min(count, m_capacity), m_capacity);
+        m_revision = NextRevision();
+    }
+
+    void ParticleEmitter::setSettings(const ParticleEmitterSettings& settings) {
+        m_settings = settings;
+
+        // Resolved once here, like a SpriteLayer sprite
+        const auto [texture, uv] = m_renderer.resolveSource(settings.texture, settings.srcRect);
+        m_texture = texture;
+        m_uvRect = uv;
+        m_revision = NextRevision();
+    }
+
+    void ParticleEmitter::setPosition(glm::vec2 position) {
+        m_settings.position = position;
+        m_revision = NextRevision();
+    }
+}
@@ -177,7 +177,7 @@ namespace womp {
             fragShaderStageInfo.module = m_fragShaderModule;
             fragShaderStageInfo.pName = "main";
             fragShaderStageInfo.flags = 0;
-            fragShaderStageInfo.pSpecializationInfo = nullptr;
+            fragShaderStageInfo.pSpecializationInfo = configInfo.fragmentSpecialization;
             fragShaderStageInfo.pNext = nullptr;
 
             shaderStages.push_back(fragShaderStageInfo);
@@ -222,7 +222,7 @@ namespace womp {
         pipelineInfo.basePipelineIndex = -1;
         pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
 
-        if (vkCreateGraphicsPipelines(m_device.GetVkDevice(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_graphicsPipeline) != VK_SUCCESS) {
+        if (vkCreateGraphicsPipelines(m_device.GetVkDevice(), configInfo.pipelineCache, 1, &pipelineInfo, nullptr, &m_graphicsPipeline) != VK_SUCCESS) {
             throw std::runtime_error("Can't make pipeline!");
         }
     }
@@ -256,6 +256,7 @@ namespace womp {
             fragShaderStageInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
             fragShaderStageInfo.module = m_fragShaderModule;
             fragShaderStageInfo.pName = "main";
+            fragShaderStageInfo.pSpecializationInfo = configInfo.fragmentSpecialization;
 
             shaderStages.push_back(fragShaderStageInfo);
         }
@@ -293,7 +294,7 @@ namespace womp {
         pipelineInfo.basePipelineIndex = -1;
         pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
 
-        if (vkCreateGraphicsPipelines(m_device.GetVkDevice(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_graphicsPipeline) != VK_SUCCESS) {
+        if (vkCreateGraphicsPipelines(m_device.GetVkDevice(), configInfo.pipelineCache, 1, &pipelineInfo, nullptr, &m_graphicsPipeline) != VK_SUCCESS) {
             throw std::runtime_error("Can't make pipeline!");
         }
     }
@@ -28,6 +28,8 @@ namespace womp {
         std::vector<VkVertexInputAttributeDescription> vertexAttributeDescriptions{};
 
         VkPipelineLayout pipelineLayout = nullptr;
+        VkPipelineCache pipelineCache = VK_NULL_HANDLE;
+        const VkSpecializationInfo* fragmentSpecialization = nullptr;  // Only read while the pipeline is created
     };
 
     struct Vertex {
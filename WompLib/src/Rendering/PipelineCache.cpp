@@ -0,0 +1,173 @@
+#include "PipelineCache.h"
+
+#include <array>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+#include "Core/Hash.h"
+
+namespace womp {
+    PipelineCache::PipelineCache(Device& device, const PipelineConfigInfo& baseConfig, std::string path)
+        : m_device(device), m_baseConfig(baseConfig), m_path(std::move(path)) {
+        const std::vector<char> data = loadCompatibleData();
+        m_warm = !data.empty();
+
+        VkPipelineCacheCreateInfo cacheInfo{};
+        cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+        cacheInfo.initialDataSize = data.size();
+        cacheInfo.pInitialData = data.empty() ? nullptr : data.data();
+
+        if (vkCreatePipelineCache(m_device.GetVkDevice(), &cacheInfo, nullptr, &m_pipelineCache) != VK_SUCCESS) {
+            throw std::runtime_error("Could not make pipeline cache");
+        }
+    }
+
+    PipelineCache::~PipelineCache() {
+        m_pipelines.clear();
+        vkDestroyPipelineCache(m_device.GetVkDevice(), m_pipelineCache, nullptr);
+    }
+
+    const Pipeline& PipelineCache::get(const PipelineKey& key) {
+        std::lock_guard lock(m_mutex);
+
+        auto& pipeline = m_pipelines[key];
+        if (!pipeline) {
+            PipelineConfigInfo config = m_baseConfig;
+            config.pipelineLayout = key.layout;
+            config.pipelineCache = m_pipelineCache;
+            config.inputAssemblyInfo.topology = key.topology;
+            ApplyBlendMode(config.colorBlendAttachment, key.blendMode);
+            // The copy still points at the base config's attachment and dynamic states
+            config.colorBlendInfo.pAttachments = &config.colorBlendAttachment;
+            config.dynamicStateInfo.pDynamicStates = config.dynamicStateEnables.data();
+
+            // Constant 0 of the fragment shader is the blend mode, shaders that don't declare it ignore it
+            const auto blendMode = static_cast<uint32_t>(key.blendMode);
+            const VkSpecializationMapEntry blendModeEntry{0, 0, sizeof(blendMode)};
+            const VkSpecializationInfo specialization{1, &blendModeEntry, sizeof(blendMode), &blendMode};
+            config.fragmentSpecialization = &specialization;
+
+            pipeline = std::make_unique<Pipeline>(m_device, key.vertex.code, key.vertex.size, key.fragment.code, key.fragment.size, config);
+        }
+        return *pipeline;
+    }
+
+    void PipelineCache::save() const {
+        if (m_path.empty()) {
+            return;
+        }
+
+        size_t size = 0;
+        if (vkGetPipelineCacheData(m_device.GetVkDevice(), m_pipelineCache, &size, nullptr) != VK_SUCCESS || size == 0) {
+            return;
+        }
+        std::vector<char> data(size);
+        if (vkGetPipelineCacheData(m_device.GetVkDevice(), m_pipelineCache, &size, data.data()) != VK_SUCCESS) {
+            return;
+        }
+
+        // A crash halfway through leaves the old file instead of a truncated one
+        const std::string temporaryPath = m_path + ".tmp";
+        {
+            std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+            file.write(data.data(), static_cast<std::streamsize>(size));
+            if (!file) {
+                std::cerr << "Could not write pipeline cache " << temporaryPath << std::endl;
+                return;
+            }
+        }
+
+        std::error_code error;
+        std::filesystem::rename(temporaryPath, m_path, error);
+        if (error) {
+            std::cerr << "Could not replace pipeline cache " << m_path << ": " << error.message() << std::endl;
+        }
+    }
+
+    void PipelineCache::ApplyBlendMode(VkPipelineColorBlendAttachmentState& attachment, BlendMode mode) {
+        attachment.blendEnable = mode != BlendMode::Opaque;
+        attachment.colorBlendOp = VK_BLEND_OP_ADD;
+        attachment.alphaBlendOp = VK_BLEND_OP_ADD;
+
+        switch (mode) {
+            case BlendMode::Alpha:
+                attachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+                attachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+                attachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+                attachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+                break;
+            case BlendMode::Premultiplied:
+                attachment.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
+                attachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+                attachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+                attachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+                break;
+            case BlendMode::Additive:
+                // Weighted by alpha, so fading a sprite out fades its light too
+                attachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+                attachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE;
+                attachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+                attachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+                break;
+            case BlendMode::Multiply:
+                // dst * src, the fragment shader fades src to white by its alpha
+                attachment.srcColorBlendFactor = VK_BLEND_FACTOR_DST_COLOR;
+                attachment.dstColorBlendFactor = VK_BLEND_FACTOR_ZERO;
+                attachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+                attachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+                break;
+            case BlendMode::Opaque:
+            case BlendMode::Count:
+                attachment.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
+                attachment.dstColorBlendFactor = VK_BLEND_FACTOR_ZERO;
+                attachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+                attachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+                break;
+        }
+    }
+
+    size_t PipelineCache::KeyHash::operator()(const PipelineKey& key) const {
+        const std::array<uint64_t, 4> fields{
+            reinterpret_cast<uintptr_t>(key.vertex.code),
+            reinterpret_cast<uintptr_t>(key.fragment.code),
+            reinterpret_cast<uint64_t>(key.layout),
+            static_cast<uint64_t>(key.blendMode) << 32 | static_cast<uint64_t>(key.topology)
+        };
+        return static_cast<size_t>(HashValue(fields, 0));
+    }
+
+    std::vector<char> PipelineCache::loadCompatibleData() const {
+        if (m_path.empty()) {
+            return {};
+        }
+
+        std::ifstream file(m_path, std::ios::ate | std::ios::binary);
+        if (!file.is_open()) {
+            return {};
+        }
+
+        const auto size = static_cast<size_t>(file.tellg());
+        std::vector<char> data(size);
+        file.seekg(0);
+        file.read(data.data(), static_cast<std::streamsize>(size));
+        if (!file || size < sizeof(VkPipelineCacheHeaderVersionOne)) {
+            return {};
+        }
+
+        // Some drivers don't validate the data they're given, a cache from another GPU or driver starts cold instead
+        VkPipelineCacheHeaderVersionOne header{};
+        std::memcpy(&header, data.data(), sizeof(header));
+        const VkPhysicalDeviceProperties& properties = m_device.GetProperties();
+        if (header.headerVersion != VK_PIPELINE_CACHE_HEADER_VERSION_ONE ||
+            header.headerSize < sizeof(header) || header.headerSize > size ||
+            header.vendorID != properties.vendorID ||
+            header.deviceID != properties.deviceID ||
+            std::memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) != 0) {
+            std::cout << "Pipeline cache " << m_path << " is from another driver, starting cold" << std::endl;
+            return {};
+        }
+        return data;
+    }
+}
@@ -0,0 +1,77 @@
+#ifndef PIPELINECACHE_H
+#define PIPELINECACHE_H
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "Rendering/BlendMode.h"
+#include "Rendering/Pipeline.h"
+
+namespace womp {
+    struct ShaderCode {
+        const uint8_t* code{};
+        size_t size{};
+    };
+
+    // Everything a graphics pipeline variant differs by, the rest comes from the cache's base config
+    struct PipelineKey {
+        ShaderCode vertex{};
+        ShaderCode fragment{};
+        VkPipelineLayout layout{};
+        BlendMode blendMode{BlendMode::Alpha};
+        VkPrimitiveTopology topology{VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST};
+
+        bool operator==(const PipelineKey& other) const {
+            return vertex.code == other.vertex.code && fragment.code == other.fragment.code && layout == other.layout &&
+                   blendMode == other.blendMode && topology == other.topology;
+        }
+    };
+
+    // Graphics pipelines created on first use per key, plus a VkPipelineCache that every pipeline, compute
+    // ones included, is created through. The VkPipelineCache is loaded from path when it was written by
+    // the same driver and device, and written back by save(), so a warm start skips shader compilation.
+    // get() may be called from any thread, pipelines live as long as the cache.
+    class PipelineCache {
+    public:
+        // baseConfig holds the attachment formats and fixed state every variant shares. An empty path keeps
+        // the VkPipelineCache in memory only.
+        PipelineCache(Device& device, const PipelineConfigInfo& baseConfig, std::string path);
+        ~PipelineCache();
+
+        PipelineCache(const PipelineCache& other) = delete;
+        PipelineCache(PipelineCache&& other) noexcept = delete;
+        PipelineCache& operator=(const PipelineCache& other) = delete;
+        PipelineCache& operator=(PipelineCache&& other) noexcept = delete;
+
+        const Pipeline& get(const PipelineKey& key);
+
+        // Writes the VkPipelineCache to the path, replacing the file only once the new one is complete
+        void save() const;
+
+        [[nodiscard]] VkPipelineCache getVkPipelineCache() const { return m_pipelineCache; }
+        [[nodiscard]] bool isWarm() const { return m_warm; }     // Started from a file written by this driver and device
+
+        static void ApplyBlendMode(VkPipelineColorBlendAttachmentState& attachment, BlendMode mode);
+
+    private:
+        struct KeyHash {
+            size_t operator()(const PipelineKey& key) const;
+        };
+
+        [[nodiscard]] std::vector<char> loadCompatibleData() const;
+
+        Device& m_device;
+        PipelineConfigInfo m_baseConfig;
+        std::string m_path;
+
+        VkPipelineCache m_pipelineCache{VK_NULL_HANDLE};
+        bool m_warm{false};
+
+        std::mutex m_mutex;
+        std::unordered_map<PipelineKey, std::unique_ptr<Pipeline>, KeyHash> m_pipelines{};
+    };
+}
+
+#endif //PIPELINECACHE_H
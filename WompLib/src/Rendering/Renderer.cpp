@@ -67,7 +67,7 @@ void womp::Renderer::endFrame() {
     m_currentFrameIndex = (m_currentFrameIndex + 1) % Swapchain::MAX_FRAMES_IN_FLIGHT;
 }
 
-void womp::Renderer::beginSwapChainRenderPass(VkCommandBuffer commandBuffer) const {
+void womp::Renderer::beginSwapChainRenderPass(VkCommandBuffer commandBuffer, VkRenderingFlags flags) const {
     assert(m_isFrameStarted && "Can't call beginSwapChainRenderPass if frame is not in progress");
     assert(
         commandBuffer == GetCurrentCommandBuffer() &&
@@ -108,6 +108,7 @@ void womp::Renderer::beginSwapChainRenderPass(VkCommandBuffer commandBuffer) con
 
     const VkRenderingInfoKHR render_info{
         .sType = VK_STRUCTURE_TYPE_RENDERING_INFO_KHR,
+        .flags = flags,
         .renderArea = {
             .offset = {0, 0},
             .extent = m_swapChain->GetSwapChainExtent(),
@@ -126,6 +127,12 @@ void womp::Renderer::beginSwapChainRenderPass(VkCommandBuffer commandBuffer) con
 
     vkCmdBeginRendering(commandBuffer, &render_info);
 
+    if (!(flags & VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT)) {
+        setViewportAndScissor(commandBuffer);
+    }
+}
+
+void womp::Renderer::setViewportAndScissor(VkCommandBuffer commandBuffer) const {
     VkViewport viewport{};
     viewport.x = 0.0f;
     viewport.y = 0.0f;
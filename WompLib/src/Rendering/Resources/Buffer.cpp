@@ -1,5 +1,7 @@
 #include "Buffer.h"
 
+#include "Rendering/UploadBatch.h"
+
 namespace womp {
     Buffer::Buffer(Device& deviceRef, VkDeviceSize size, VkBufferUsageFlags usageFlags, VmaMemoryUsage memoryUsage, bool mappable): m_device{deviceRef} {
         VmaAllocationCreateInfo allocInfo{};
@@ -55,14 +57,13 @@ namespace womp {
     }
 
     void Buffer::copyToBuffer(Buffer* dstBuffer, uint32_t size) {
-        const VkCommandBuffer commandBuffer = m_device.beginSingleTimeCommands();
-
         VkBufferCopy copyRegion{};
         copyRegion.size = size;
         copyRegion.srcOffset = 0;
-        vkCmdCopyBuffer(commandBuffer, m_buffer, dstBuffer->getBuffer(), 1, &copyRegion);
 
-        m_device.endSingleTimeCommands(commandBuffer);
+        UploadBatch batch(m_device, UploadQueue::Graphics);
+        batch.copyBuffer(m_buffer, dstBuffer->getBuffer(), copyRegion);
+        batch.submitAndWait();
     }
 
     void Buffer::createBuffer(VkDeviceSize size, VkBufferUsageFlags usageFlags, VmaMemoryUsage memoryUsage, bool mappable) {
@@ -97,5 +98,12 @@ namespace womp {
         if (mappable) {
             m_data = allocInfo.pMappedData;
         }
+
+        if (usageFlags & VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT) {
+            VkBufferDeviceAddressInfo addressInfo{};
+            addressInfo.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO;
+            addressInfo.buffer = m_buffer;
+            m_deviceAddress = vkGetBufferDeviceAddress(m_device.GetVkDevice(), &addressInfo);
+        }
     }
 }
@@ -25,6 +25,9 @@ namespace womp {
         [[nodiscard]] VmaAllocationInfo GetAllocationInfo() const { return m_allocationInfo; }
         [[nodiscard]] size_t GetSize() const { return m_size; }
         [[nodiscard]] bool isMapped() const { return m_data != nullptr; }
+        // Only valid for buffers created with VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT
+        [[nodiscard]] VkDeviceAddress getDeviceAddress() const { return m_deviceAddress; }
+        // Blocks until the copy is done, record into an UploadBatch to combine copies
         void copyToBuffer(Buffer* dstBuffer, uint32_t size);
 
     private:
@@ -38,6 +41,7 @@ namespace womp {
         bool m_mappedViaCreateFlag = false;
         void* m_data = nullptr;
         VkDeviceSize m_size = 0;
+        VkDeviceAddress m_deviceAddress = 0;
     };
 }
 
@@ -0,0 +1,81 @@
+#include "FrameRingAllocator.h"
+
+#include <algorithm>
+#include <cassert>
+
+#include "Rendering/DebugLabel.h"
+
+namespace womp {
+    FrameRingAllocator::FrameRingAllocator(Device& device, VkDeviceSize capacity): m_device{device} {
+        const VkPhysicalDeviceLimits& limits = device.GetLimits();
+        m_minAlignment = std::max<VkDeviceSize>({16, limits.minUniformBufferOffsetAlignment, limits.minStorageBufferOffsetAlignment});
+
+        grow(capacity);
+    }
+
+    void FrameRingAllocator::beginFrame(int frameIndex) {
+        assert(m_currentFrame == -1 && "FrameRingAllocator::beginFrame called twice without endFrame");
+        m_currentFrame = frameIndex;
+
+        // Frames retire in submission order, so everything up to this frame's last allocation is free again
+        m_tail = std::max(m_tail, m_frameEnds[frameIndex]);
+
+        std::erase_if(m_retiredBuffers, [frameIndex](const RetiredBuffer& retired) {
+            return retired.frameIndex == frameIndex;
+        });
+    }
+
+    void FrameRingAllocator::endFrame() {
+        assert(m_currentFrame != -1 && "FrameRingAllocator::endFrame called without beginFrame");
+        m_frameEnds[m_currentFrame] = m_head;
+        m_currentFrame = -1;
+    }
+
+    FrameAllocation FrameRingAllocator::allocate(VkDeviceSize size, VkDeviceSize alignment) {
+        assert(m_currentFrame != -1 && "Cannot allocate from the frame ring outside of a frame");
+        if (alignment == 0) {
+            alignment = m_minAlignment;
+        }
+
+        VkDeviceSize offset = (m_head % m_capacity + alignment - 1) / alignment * alignment;
+        VkDeviceSize start = m_head - m_head % m_capacity + offset;
+
+        // Allocations never straddle the end of the ring
+        if (offset + size > m_capacity) {
+            start = m_head - m_head % m_capacity + m_capacity;
+            offset = 0;
+        }
+
+        if (start + size - m_tail > m_capacity) {
+            grow(std::max(m_capacity * 2, size + alignment));
+            offset = 0;
+            start = 0;
+        }
+
+        m_head = start + size;
+
+        return FrameAllocation{
+            .data = m_data + offset,
+            .buffer = m_buffer->getBuffer(),
+            .offset = offset,
+            .size = size,
+            .deviceAddress = m_buffer->getDeviceAddress() + offset
+        };
+    }
+
+    void FrameRingAllocator::grow(VkDeviceSize minimumSize) {
+        // In flight frames may still read the old ring, the current frame is the last one to touch it
+        if (m_buffer) {
+            m_retiredBuffers.push_back(RetiredBuffer{std::move(m_buffer), m_currentFrame});
+        }
+
+        m_capacity = (minimumSize + m_minAlignment - 1) / m_minAlignment * m_minAlignment;
+        m_buffer = std::make_unique<Buffer>(m_device, m_capacity, USAGE, VMA_MEMORY_USAGE_CPU_TO_GPU, true);
+        m_data = static_cast<uint8_t*>(m_buffer->GetRawData());
+        DebugLabel::NameBuffer(m_buffer->getBuffer(), "Frame Ring: " + std::to_string(m_capacity));
+
+        m_head = 0;
+        m_tail = 0;
+        m_frameEnds.fill(0);
+    }
+}
@@ -0,0 +1,91 @@
+#ifndef FRAMERINGALLOCATOR_H
+#define FRAMERINGALLOCATOR_H
+
+#include <array>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "Rendering/Swapchain.h"
+#include "Rendering/Resources/Buffer.h"
+
+namespace womp {
+    // Sub-range of the ring, valid until the frame it was allocated in has finished on the GPU
+    struct FrameAllocation {
+        void* data{};
+        VkBuffer buffer{};
+        VkDeviceSize offset{};
+        VkDeviceSize size{};
+        VkDeviceAddress deviceAddress{};
+
+        [[nodiscard]] VkDescriptorBufferInfo descriptorInfo() const { return VkDescriptorBufferInfo{buffer, offset, size}; }
+    };
+
+    // Persistently mapped ring buffer for per-frame transient data. Each frame in flight owns the
+    // region it allocated from, which is reclaimed once beginFrame is called again for that frame
+    // index, after Swapchain has waited on its fence. Allocating is a pointer bump, when the ring
+    // runs out it is replaced by a bigger one and the old buffer is kept alive until it is retired.
+    class FrameRingAllocator {
+    public:
+        static constexpr VkBufferUsageFlags USAGE =
+                VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT |
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                VK_BUFFER_USAGE_VERTEX_BUFFER_BIT |
+                VK_BUFFER_USAGE_INDEX_BUFFER_BIT |
+                VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT |
+                VK_BUFFER_USAGE_TRANSFER_SRC_BIT |
+                VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
+
+        FrameRingAllocator(Device& device, VkDeviceSize capacity);
+
+        FrameRingAllocator(const FrameRingAllocator& other) = delete;
+        FrameRingAllocator(FrameRingAllocator&& other) noexcept = delete;
+        FrameRingAllocator& operator=(const FrameRingAllocator& other) = delete;
+        FrameRingAllocator& operator=(FrameRingAllocator&& other) noexcept = delete;
+
+        // Call after the frame's fence has been waited on and before allocating for it
+        void beginFrame(int frameIndex);
+        void endFrame();
+
+        // alignment of 0 uses the device's uniform/storage offset alignment
+        FrameAllocation allocate(VkDeviceSize size, VkDeviceSize alignment = 0);
+
+        template<typename T>
+        FrameAllocation push(const T& value) {
+            FrameAllocation allocation = allocate(sizeof(T), alignof(T) > m_minAlignment ? alignof(T) : 0);
+            std::memcpy(allocation.data, &value, sizeof(T));
+            return allocation;
+        }
+
+        template<typename T>
+        FrameAllocation allocateArray(size_t count) {
+            return allocate(count * sizeof(T), alignof(T) > m_minAlignment ? alignof(T) : 0);
+        }
+
+        [[nodiscard]] VkDeviceSize getCapacity() const { return m_capacity; }
+        [[nodiscard]] VkDeviceSize getUsed() const { return m_head - m_tail; }
+
+    private:
+        void grow(VkDeviceSize minimumSize);
+
+        Device& m_device;
+        std::unique_ptr<Buffer> m_buffer{};
+        uint8_t* m_data{};
+        VkDeviceSize m_capacity{};
+        VkDeviceSize m_minAlignment{};
+
+        // Monotonic byte positions, the physical offset is position % m_capacity
+        VkDeviceSize m_head{};
+        VkDeviceSize m_tail{};
+        std::array<VkDeviceSize, Swapchain::MAX_FRAMES_IN_FLIGHT> m_frameEnds{};
+        int m_currentFrame{-1};
+
+        struct RetiredBuffer {
+            std::unique_ptr<Buffer> buffer;
+            int frameIndex;
+        };
+        std::vector<RetiredBuffer> m_retiredBuffers{};
+    };
+}
+
+#endif //FRAMERINGALLOCATOR_H
@@ -5,13 +5,20 @@
 #include <iostream>
 
 #include "Buffer.h"
+#include "Core/Ktx2File.h"
 #include "Rendering/DebugLabel.h"
+#include "Rendering/MipmapGenerator.h"
+#include "Rendering/UploadBatch.h"
 #include "Rendering/stb_image.h"
 
-womp::Image::Image(Device& device, VkExtent2D size, VkFormat format, VkImageUsageFlags usage, VmaMemoryUsage memoryUsage, bool createView, bool createSampler, VkFilter filter)
+womp::Image::Image(Device& device, VkExtent2D size, VkFormat format, VkImageUsageFlags usage, VmaMemoryUsage memoryUsage, bool createView, bool createSampler, VkFilter filter, uint32_t mipLevels)
     : m_device(device), m_image(VK_NULL_HANDLE), m_allocation(VK_NULL_HANDLE),
-      m_format{format}, m_imageView(VK_NULL_HANDLE) {
-    createImage(size, 1, format, usage, memoryUsage);
+      m_format{format}, m_mipLevels{mipLevels}, m_imageView(VK_NULL_HANDLE) {
+    VkImageCreateFlags flags = 0;
+    if (mipLevels > 1) {
+        MipmapGenerator::GetImageRequirements(m_device, format, usage, flags);
+    }
+    createImage(size, mipLevels, format, usage, memoryUsage, flags);
     if (createView) {
         createImageView(format);
     }
@@ -21,15 +28,36 @@ womp::Image::Image(Device& device, VkExtent2D size, VkFormat format, VkImageUsag
     m_extent = size;
 }
 
-womp::Image::Image(Device& device, const std::string& filename, VkFormat format, VkImageUsageFlags usage, VmaMemoryUsage memoryUsage, VkFilter filter)
+womp::Image::Image(Device& device, const std::string& filename, VkFormat format, VkImageUsageFlags usage, VmaMemoryUsage memoryUsage, VkFilter filter, bool mipmapped)
+    : m_device(device), m_image(VK_NULL_HANDLE), m_allocation(VK_NULL_HANDLE), m_format{format}, m_imageView(VK_NULL_HANDLE) {
+    UploadBatch batch(device);
+    loadFromFile(filename, usage, memoryUsage, filter, mipmapped, batch);
+    batch.submitAndWait();
+}
+
+womp::Image::Image(Device& device, const std::string& filename, VkFormat format, VkImageUsageFlags usage, VmaMemoryUsage memoryUsage, VkFilter filter, UploadBatch& batch, bool mipmapped)
     : m_device(device), m_image(VK_NULL_HANDLE), m_allocation(VK_NULL_HANDLE), m_format{format}, m_imageView(VK_NULL_HANDLE) {
+    loadFromFile(filename, usage, memoryUsage, filter, mipmapped, batch);
+}
+
+womp::Image::Image(Device& device, const Ktx2File& file, VkImageUsageFlags usage, VmaMemoryUsage memoryUsage, VkFilter filter, UploadBatch& batch)
+    : m_device(device), m_image(VK_NULL_HANDLE), m_allocation(VK_NULL_HANDLE), m_imageView(VK_NULL_HANDLE) {
+    loadFromKtx2(file, usage, memoryUsage, filter, batch);
+}
 
+void womp::Image::loadFromFile(const std::string& filename, VkImageUsageFlags usage, VmaMemoryUsage memoryUsage, VkFilter filter, bool mipmapped, UploadBatch& batch) {
     //Check if file exists
     if (std::filesystem::exists(filename) == false) {
         std::cerr << "Texture file does not exist: " << filename << std::endl;
         return;
     }
 
+    // Nothing to decode, the stored levels are copied as they are
+    if (IsKtx2Path(filename)) {
+        loadFromKtx2(Ktx2File(filename), usage, memoryUsage, filter, batch);
+        DebugLabel::NameImage(m_image, filename);
+        return;
+    }
 
     uint8_t* pixels = nullptr;
     VkDeviceSize imageSize{};
@@ -42,22 +70,47 @@ womp::Image::Image(Device& device, const std::string& filename, VkFormat format,
     m_extent = VkExtent2D{static_cast<uint32_t>(texWidth), static_cast<uint32_t>(texHeight)};
     imageSize = texWidth * texHeight * 4;
 
-    Buffer stagingBuffer(device, imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_CPU_ONLY);
+    usage |= VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+    VkImageCreateFlags flags = 0;
+    if (mipmapped) {
+        m_mipLevels = MipmapGenerator::GetMipLevels(m_extent);
+        MipmapGenerator::GetImageRequirements(m_device, m_format, usage, flags);
+    }
 
-    stagingBuffer.copyTo(pixels, imageSize);
+    createImage(m_extent, m_mipLevels, m_format, usage, memoryUsage, flags);
+    createImageView(m_format);
 
+    // The batch stages its own copy, the pixels can go right away
+    batch.uploadImage(*this, pixels, imageSize);
     stbi_image_free(pixels);
 
-    createImage(m_extent, 1, format, usage | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT, memoryUsage);
-    createImageView(format);
-
-    device.TransitionImageLayout(m_image, format, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1);
-    copyToBuffer(stagingBuffer, m_extent);
     createImageSampler(filter, VK_SAMPLER_ADDRESS_MODE_REPEAT);
 
     DebugLabel::NameImage(m_image, filename);
 }
 
+void womp::Image::loadFromKtx2(const Ktx2File& file, VkImageUsageFlags usage, VmaMemoryUsage memoryUsage, VkFilter filter, UploadBatch& batch) {
+    if (!m_device.IsTextureCompressionBCSupported()) {
+        throw std::runtime_error("Block compressed textures need the textureCompressionBC feature");
+    }
+
+    // The file's format wins over the requested one, its blocks can't be converted
+    m_format = static_cast<VkFormat>(file.getVkFormat());
+    m_extent = VkExtent2D{static_cast<uint32_t>(file.getSize().x), static_cast<uint32_t>(file.getSize().y)};
+    m_mipLevels = file.getLevelCount();
+
+    createImage(m_extent, m_mipLevels, m_format, usage | VK_IMAGE_USAGE_TRANSFER_DST_BIT, memoryUsage);
+    createImageView(m_format);
+
+    std::vector<std::span<const uint8_t>> levels;
+    for (uint32_t level = 0; level < m_mipLevels; ++level) {
+        levels.push_back(file.getLevel(level));
+    }
+    batch.uploadImageLevels(*this, levels);
+
+    createImageSampler(filter, VK_SAMPLER_ADDRESS_MODE_REPEAT);
+}
+
 
 womp::Image::Image(Device& device, VkExtent2D size, VkFormat format, VkImageUsageFlags usage, VmaMemoryUsage memoryUsage, VkImage existingImage): m_device{device}, m_image(existingImage), m_allocation(VK_NULL_HANDLE), m_extent{size}, m_format{format}, m_imageView(VK_NULL_HANDLE) {
     assert(existingImage != VK_NULL_HANDLE && "Swapchain image is null!");
@@ -115,38 +168,6 @@ VkDescriptorImageInfo womp::Image::descriptorInfo() {
     return imageInfo;
 }
 
-void womp::Image::copyToBuffer(Buffer& buffer, VkExtent2D size) const {
-    const VkCommandBuffer commandBuffer = m_device.beginSingleTimeCommands();
-
-    VkBufferImageCopy region{};
-    region.bufferOffset = 0;
-    region.bufferRowLength = 0;
-    region.bufferImageHeight = 0;
-
-    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-    region.imageSubresource.mipLevel = 0;
-    region.imageSubresource.baseArrayLayer = 0;
-    region.imageSubresource.layerCount = 1;
-
-    region.imageOffset = {0, 0, 0};
-    region.imageExtent = {
-        size.width,
-        size.height,
-        1
-    };
-
-    vkCmdCopyBufferToImage(
-        commandBuffer,
-        buffer.getBuffer(),
-        m_image,
-        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-        1,
-        &region
-    );
-
-    m_device.endSingleTimeCommands(commandBuffer);
-}
-
 bool womp::Image::HasStencil() const {
     switch (m_format)
     {
@@ -172,9 +193,10 @@ bool womp::Image::HasDepth() const {
     }
 }
 
-void womp::Image::createImage(VkExtent2D size, uint32_t miplevels, VkFormat format, VkImageUsageFlags usage, VmaMemoryUsage memoryUsage) {
+void womp::Image::createImage(VkExtent2D size, uint32_t miplevels, VkFormat format, VkImageUsageFlags usage, VmaMemoryUsage memoryUsage, VkImageCreateFlags flags) {
     VkImageCreateInfo imageInfo{};
     imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageInfo.flags = flags;
     imageInfo.imageType = VK_IMAGE_TYPE_2D;
     imageInfo.extent.height = size.height;
     imageInfo.extent.width = size.width;
@@ -188,6 +210,9 @@ void womp::Image::createImage(VkExtent2D size, uint32_t miplevels, VkFormat form
     imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
     imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 
+    m_usage = usage;
+    m_createFlags = flags;
+
     VmaAllocationCreateInfo allocInfo{};
     allocInfo.usage = memoryUsage;
 
@@ -200,11 +225,13 @@ void womp::Image::createImage(VkExtent2D size, uint32_t miplevels, VkFormat form
 }
 
 void womp::Image::createImageView(VkFormat format) {
-    m_imageView = std::make_unique<ImageView>(m_device, m_image, format, getImageAspect(format), 1);
+    // Storage usage added for the mipmap.comp fallback only holds for its UNORM views, this one is read by shaders
+    const VkImageUsageFlags viewUsage = m_createFlags & VK_IMAGE_CREATE_EXTENDED_USAGE_BIT ? m_usage & ~VK_IMAGE_USAGE_STORAGE_BIT : 0;
+    m_imageView = std::make_unique<ImageView>(m_device, m_image, format, getImageAspect(format), m_mipLevels, 0, viewUsage);
 }
 
 void womp::Image::createImageSampler(const VkFilter filter, const VkSamplerAddressMode addressMode) {
-    m_sampler = std::make_unique<Sampler>(m_device, filter, addressMode, 1);
+    m_sampler = std::make_unique<Sampler>(m_device, filter, addressMode, m_mipLevels);
 }
 
 VkImageAspectFlags womp::Image::getImageAspect(const VkFormat format) {
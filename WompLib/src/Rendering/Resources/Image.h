@@ -9,8 +9,12 @@
 #include "Rendering/Device.h"
 
 namespace womp {
+    class Ktx2File;
+    class UploadBatch;
+
     class Image {
     public:
+        // With more than one level the image also gets the usage UploadBatch::generateMipmaps needs
         explicit Image(
             Device& device,
             VkExtent2D size,
@@ -19,9 +23,16 @@ namespace womp {
             VmaMemoryUsage memoryUsage,
             bool createView = true,
             bool createSampler = true,
-            VkFilter filter = VK_FILTER_LINEAR
+            VkFilter filter = VK_FILTER_LINEAR,
+            uint32_t mipLevels = 1
         );
-        Image(Device& device, const std::string& filename, VkFormat format, VkImageUsageFlags usage, VmaMemoryUsage memoryUsage, VkFilter filter);
+        // Loads and uploads the file, blocking until the image is shader readable. A mipmapped image gets
+        // a full chain, generated on the GPU. A .ktx2 file keeps its own format and stored levels instead.
+        Image(Device& device, const std::string& filename, VkFormat format, VkImageUsageFlags usage, VmaMemoryUsage memoryUsage, VkFilter filter, bool mipmapped = false);
+        // Records the upload into batch instead, the image can be sampled once the batch has completed
+        Image(Device& device, const std::string& filename, VkFormat format, VkImageUsageFlags usage, VmaMemoryUsage memoryUsage, VkFilter filter, UploadBatch& batch, bool mipmapped = false);
+        // Copies the blocks of every level into batch as they are stored, the file can go once this returns
+        Image(Device& device, const Ktx2File& file, VkImageUsageFlags usage, VmaMemoryUsage memoryUsage, VkFilter filter, UploadBatch& batch);
 
         Image(Device& device, VkExtent2D size, VkFormat format, VkImageUsageFlags usage, VmaMemoryUsage memoryUsage, VkImage existingImage);
         ~Image();
@@ -32,20 +43,25 @@ namespace womp {
         [[nodiscard]] VmaAllocation getAllocation() const { return m_allocation; }
 
         VkExtent2D GetExtent() const { return m_extent; }
+        [[nodiscard]] VkFormat GetFormat() const { return m_format; }
+        [[nodiscard]] uint32_t GetMipLevels() const { return m_mipLevels; }
 
         [[nodiscard]] VkImageLayout GetCurrentLayout() const { return m_imageLayout; }
+        // For transitions recorded outside of Image, like those of an UploadBatch
+        void SetCurrentLayout(VkImageLayout layout) { m_imageLayout = layout; }
 
         void TransitionImageLayout(VkCommandBuffer commandBuffer, VkImageLayout newLayout, VkPipelineStageFlags srcStageMask, VkPipelineStageFlags dstStageMask);
 
         VkDescriptorImageInfo descriptorInfo();
-        void copyToBuffer(Buffer& buffer, VkExtent2D size) const;
 
 
         [[nodiscard]] bool HasStencil() const;
         [[nodiscard]] bool HasDepth() const;
 
     private:
-        void createImage(VkExtent2D size, uint32_t miplevels, VkFormat format, VkImageUsageFlags usage, VmaMemoryUsage memoryUsage);
+        void loadFromFile(const std::string& filename, VkImageUsageFlags usage, VmaMemoryUsage memoryUsage, VkFilter filter, bool mipmapped, UploadBatch& batch);
+        void loadFromKtx2(const Ktx2File& file, VkImageUsageFlags usage, VmaMemoryUsage memoryUsage, VkFilter filter, UploadBatch& batch);
+        void createImage(VkExtent2D size, uint32_t miplevels, VkFormat format, VkImageUsageFlags usage, VmaMemoryUsage memoryUsage, VkImageCreateFlags flags = 0);
         void createImageView(VkFormat format);
         void createImageSampler(VkFilter filter, VkSamplerAddressMode addressMode);
         static VkImageAspectFlags getImageAspect(VkFormat format);
@@ -57,6 +73,9 @@ namespace womp {
         VkExtent2D m_extent{};
         VkImageLayout m_imageLayout{VK_IMAGE_LAYOUT_UNDEFINED};
         VkFormat m_format{VK_FORMAT_UNDEFINED};
+        uint32_t m_mipLevels{1};
+        VkImageUsageFlags m_usage{};
+        VkImageCreateFlags m_createFlags{};
 
         std::unique_ptr<ImageView> m_imageView;
         std::unique_ptr<Sampler> m_sampler;
@@ -2,7 +2,7 @@
 
 #include <stdexcept>
 
-womp::ImageView::ImageView(Device& device, VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, uint32_t mipLevels)
+womp::ImageView::ImageView(Device& device, VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, uint32_t mipLevels, uint32_t baseMipLevel, VkImageUsageFlags usage)
     : m_device(device) {
     VkImageViewCreateInfo viewInfo{};
     viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
@@ -10,11 +10,18 @@ womp::ImageView::ImageView(Device& device, VkImage image, VkFormat format, VkIma
     viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
     viewInfo.format = format;
     viewInfo.subresourceRange.aspectMask = aspectFlags;
-    viewInfo.subresourceRange.baseMipLevel = 0;
+    viewInfo.subresourceRange.baseMipLevel = baseMipLevel;
     viewInfo.subresourceRange.levelCount = mipLevels;
     viewInfo.subresourceRange.baseArrayLayer = 0;
     viewInfo.subresourceRange.layerCount = 1;
 
+    VkImageViewUsageCreateInfo usageInfo{};
+    usageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_USAGE_CREATE_INFO;
+    usageInfo.usage = usage;
+    if (usage != 0) {
+        viewInfo.pNext = &usageInfo;
+    }
+
     if (vkCreateImageView(m_device.GetVkDevice(), &viewInfo, nullptr, &m_view) != VK_SUCCESS) {
         throw std::runtime_error("Failed to create image view");
     }
@@ -6,7 +6,8 @@
 namespace womp {
     class ImageView {
     public:
-        ImageView(Device& device, VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, uint32_t mipLevels = 1);
+        // A usage other than 0 narrows what the view is used for, needed when the image has usages its format lacks
+        ImageView(Device& device, VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, uint32_t mipLevels = 1, uint32_t baseMipLevel = 0, VkImageUsageFlags usage = 0);
         ~ImageView();
 
         [[nodiscard]] VkImageView getHandle() const { return m_view; }
@@ -17,9 +17,10 @@ womp::Sampler::Sampler(Device& device, VkFilter filter, VkSamplerAddressMode add
     samplerInfo.unnormalizedCoordinates = VK_FALSE;
     samplerInfo.compareEnable = VK_FALSE;
     samplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
-    samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+    // Pixel art stays crisp between levels too
+    samplerInfo.mipmapMode = filter == VK_FILTER_NEAREST ? VK_SAMPLER_MIPMAP_MODE_NEAREST : VK_SAMPLER_MIPMAP_MODE_LINEAR;
     samplerInfo.minLod = 0.0f;
-    samplerInfo.maxLod = static_cast<float>(mipLevels);
+    samplerInfo.maxLod = static_cast<float>(mipLevels - 1);
     samplerInfo.mipLodBias = 0.0f;
 
     if (vkCreateSampler(m_device.GetVkDevice(), &samplerInfo, nullptr, &m_sampler) != VK_SUCCESS) {
@@ -0,0 +1,80 @@
+#include "TextureAtlas.h"
+
+#include <cstring>
+#include <stdexcept>
+
+#include "Rendering/DebugLabel.h"
+
+namespace womp {
+    TextureAtlas::TextureAtlas(Device& device, uint32_t pageSize, VkFormat format): m_device{device}, m_pageSize{pageSize}, m_format{format} {
+    }
+
+    TextureAtlas::Entry TextureAtlas::add(const uint8_t* pixels, glm::ivec2 size, UploadBatch& batch) {
+        const glm::ivec2 paddedSize = size + glm::ivec2(PADDING * 2);
+        if (paddedSize.x > static_cast<int>(m_pageSize) || paddedSize.y > static_cast<int>(m_pageSize)) {
+            throw std::runtime_error("Texture does not fit in an atlas page");
+        }
+
+        // Pages only fill up, so older pages are tried first to keep the page count low
+        std::optional<glm::ivec2> position;
+        uint32_t pageIndex = 0;
+        for (; pageIndex < m_pages.size(); ++pageIndex) {
+            position = m_pages[pageIndex].packer.insert(paddedSize);
+            if (position) break;
+        }
+        if (!position) {
+            position = createPage(m_pageSize, static_cast<int>(m_pageSize)).packer.insert(paddedSize);
+        }
+
+        const Buffer& staging = batch.allocateStaging(static_cast<VkDeviceSize>(paddedSize.x) * paddedSize.y * 4);
+        CopyWithBorder(pixels, size, PADDING, static_cast<uint8_t*>(staging.GetRawData()), static_cast<size_t>(paddedSize.x) * 4);
+
+        upload(m_pages[pageIndex], staging, *position, paddedSize, batch);
+        return Entry{pageIndex, *position + glm::ivec2(PADDING), size};
+    }
+
+    uint32_t TextureAtlas::addPage(const uint8_t* pixels, uint32_t size, UploadBatch& batch) {
+        // A zero sized packer rejects every rect
+        Page& page = createPage(size, 0);
+
+        const VkDeviceSize byteSize = static_cast<VkDeviceSize>(size) * size * 4;
+        const Buffer& staging = batch.allocateStaging(byteSize);
+        std::memcpy(staging.GetRawData(), pixels, byteSize);
+
+        upload(page, staging, glm::ivec2(0), glm::ivec2(static_cast<int>(size)), batch);
+        return static_cast<uint32_t>(m_pages.size() - 1);
+    }
+
+    TextureAtlas::Page& TextureAtlas::createPage(uint32_t size, int packedSize) {
+        auto image = std::make_unique<Image>(
+            m_device,
+            VkExtent2D{size, size},
+            m_format,
+            VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+            VMA_MEMORY_USAGE_GPU_ONLY
+        );
+        DebugLabel::NameImage(image->getImage(), "Texture Atlas Page " + std::to_string(m_pages.size()));
+
+        return m_pages.emplace_back(Page{
+            .image = std::move(image),
+            .packer = SkylinePacker(packedSize, packedSize)
+        });
+    }
+
+    void TextureAtlas::upload(Page& page, const Buffer& staging, glm::ivec2 offset, glm::ivec2 size, UploadBatch& batch) {
+        const VkImage image = page.image->getImage();
+
+        // Frames submitted earlier may still sample other textures on this page
+        batch.transitionImage(image, page.initialized ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+
+        VkBufferImageCopy region{};
+        region.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+        region.imageOffset = {offset.x, offset.y, 0};
+        region.imageExtent = {static_cast<uint32_t>(size.x), static_cast<uint32_t>(size.y), 1};
+        batch.copyBufferToImage(staging.getBuffer(), image, region);
+
+        batch.transitionImage(image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+        page.image->SetCurrentLayout(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+        page.initialized = true;
+    }
+}
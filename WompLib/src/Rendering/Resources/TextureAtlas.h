@@ -0,0 +1,63 @@
+#ifndef TEXTUREATLAS_H
+#define TEXTUREATLAS_H
+
+#include <memory>
+#include <vector>
+
+#include "Image.h"
+#include "Core/AtlasFile.h"
+#include "Core/SkylinePacker.h"
+#include "Rendering/Device.h"
+#include "Rendering/UploadBatch.h"
+
+namespace womp {
+    // Packs small RGBA8 textures into shared pages so draws using any of them can share a descriptor
+    // set. Every texture gets a one texel border copied from its edges, linear filtering at the
+    // edge of a sub-rect never picks up a neighbour.
+    class TextureAtlas {
+    public:
+        static constexpr int PADDING = ATLAS_SPRITE_PADDING;
+
+        struct Page {
+            std::unique_ptr<Image> image;
+            SkylinePacker packer;
+            bool initialized{false};   // Layout is still undefined before the first upload
+        };
+
+        struct Entry {
+            uint32_t page;
+            glm::ivec2 offset;  // Texel position of the texture itself, inside its padding
+            glm::ivec2 size;
+        };
+
+        TextureAtlas(Device& device, uint32_t pageSize, VkFormat format);
+
+        TextureAtlas(const TextureAtlas& other) = delete;
+        TextureAtlas(TextureAtlas&& other) noexcept = delete;
+        TextureAtlas& operator=(const TextureAtlas& other) = delete;
+        TextureAtlas& operator=(TextureAtlas&& other) noexcept = delete;
+
+        // Packs tightly packed RGBA8 pixels, opening a new page when the others are full, and records
+        // their upload into batch, an UploadQueue::Graphics one as the page may already be in use.
+        // Textures bigger than a page are rejected.
+        Entry add(const uint8_t* pixels, glm::ivec2 size, UploadBatch& batch);
+        // Records the upload of a page packed offline, nothing is packed into it at runtime. Returns its index.
+        uint32_t addPage(const uint8_t* pixels, uint32_t size, UploadBatch& batch);
+
+        // Size of pages opened by add, pages from addPage can differ
+        [[nodiscard]] uint32_t getPageSize() const { return m_pageSize; }
+        [[nodiscard]] size_t getPageCount() const { return m_pages.size(); }
+        [[nodiscard]] Page& getPage(uint32_t index) { return m_pages[index]; }
+
+    private:
+        Page& createPage(uint32_t size, int packedSize);
+        static void upload(Page& page, const Buffer& staging, glm::ivec2 offset, glm::ivec2 size, UploadBatch& batch);
+
+        Device& m_device;
+        uint32_t m_pageSize;
+        VkFormat m_format;
+        std::vector<Page> m_pages{};
+    };
+}
+
+#endif //TEXTUREATLAS_H
@@ -0,0 +1,78 @@
+#ifndef SPRITEINSTANCE_H
+#define SPRITEINSTANCE_H
+
+#include <cstdint>
+#include <vulkan/vulkan.h>
+
+#include <womp/WompMath.h>
+
+#include "Rendering/BlendMode.h"
+
+namespace womp {
+    // textureIndex of an instance drawn as an antialiased rounded box instead of a texture, in the same
+    // batches as textured sprites. srcRect.x holds the corner radius in pixels. Slot 0 is never a texture.
+    constexpr uint32_t SHAPE_TEXTURE = 0;
+
+    // Per-instance data pulled by basic.vert through a buffer device address, std430 layout
+    struct alignas(16) SpriteInstance {
+        glm::vec4 srcRect;  // normalized UV x, y, width, height
+        glm::vec4 dstRect;
+        glm::vec4 color;
+        float rotation;
+        uint32_t textureIndex;  // Slot in the bindless texture array
+        uint32_t batchIndex;    // Indirect draw the instance belongs to when GPU culling
+        uint32_t clipIndex;     // Into the frame's clip rects, 0 is unclipped
+    };
+
+    // Per-glyph data pulled by text.vert, same size as SpriteInstance so both share the ring's alignment
+    struct alignas(16) GlyphInstance {
+        glm::vec4 srcRect;
+        glm::vec4 dstRect;
+        glm::vec4 color;
+        float screenPxRange;    // Distance range of the font in screen pixels at the size drawn
+        uint32_t textureIndex;
+        uint32_t msdf;          // Distance in the median of RGB instead of alpha
+        uint32_t clipIndex;
+    };
+
+    // Run of consecutive instances that share a texture and blend mode, drawn with one instanced vkCmdDraw
+    struct SpriteBatch {
+        VkDescriptorSet descriptorSet{};
+        uint32_t firstInstance{};
+        uint32_t instanceCount{};
+        BlendMode blendMode{BlendMode::Alpha};
+    };
+
+    // Where a texture is sampled from, its own image or a sub-rect of an atlas page
+    struct TextureRegion {
+        uint32_t texture{};         // Handle whose descriptor set or bindless slot the draw uses
+        glm::vec2 uvOffset{0.0f};
+        glm::vec2 uvScale{1.0f};
+    };
+
+    // UVs of a texture to UVs of the image holding it. The fragment shaders sample at (u, 1 - v),
+    // so the offset of an atlas region is mirrored vertically when the region is made.
+    inline glm::vec4 ApplyTextureRegion(const glm::vec4& uv, const TextureRegion& region) {
+        return glm::vec4(
+            region.uvOffset.x + uv.x * region.uvScale.x,
+            region.uvOffset.y + uv.y * region.uvScale.y,
+            uv.z * region.uvScale.x,
+            uv.w * region.uvScale.y
+        );
+    }
+
+    // Pixel source rect to UVs, an empty rect covers the whole texture
+    inline glm::vec4 NormalizeSourceRect(const WP_Rect& srcRect, glm::vec2 textureSize) {
+        if (srcRect.width <= 0 || srcRect.height <= 0 || textureSize.x <= 0 || textureSize.y <= 0) {
+            return glm::vec4(0, 0, 1, 1);
+        }
+        return glm::vec4(
+            srcRect.x / textureSize.x,
+            srcRect.y / textureSize.y,
+            srcRect.width / textureSize.x,
+            srcRect.height / textureSize.y
+        );
+    }
+}
+
+#endif //SPRITEINSTANCE_H
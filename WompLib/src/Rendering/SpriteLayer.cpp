@@ -0,0 +1,72 @@
+#include <womp/SpriteLayer.h>
+
+#include <algorithm>
+#include <cassert>
+
+#include <womp/WompRenderer.h>
+
+namespace womp {
+    SpriteLayer::SpriteLayer(const WompRenderer& renderer): m_renderer{renderer} {
+    }
+
+    SpriteId SpriteLayer::add(TextureHandle texture, WP_Rect srcRect, WP_Rect dstRect, float rotation, glm::vec4 color) {
+        const auto sprite = static_cast<SpriteId>(m_instances.size());
+        m_instances.push_back(makeInstance(texture, srcRect, dstRect, rotation, color));
+        markDirty(sprite, 1);
+        m_batchesDirty = true;
+        return sprite;
+    }
+
+    void SpriteLayer::update(SpriteId sprite, TextureHandle texture, WP_Rect srcRect, WP_Rect dstRect, float rotation, glm::vec4 color) {
+        assert(sprite < m_instances.size() && "Sprite is not part of this layer");
+        const SpriteInstance instance = makeInstance(texture, srcRect, dstRect, rotation, color);
+        m_batchesDirty |= m_instances[sprite].textureIndex != instance.textureIndex;
+        m_instances[sprite] = instance;
+        markDirty(sprite, 1);
+    }
+
+    void SpriteLayer::setDestination(SpriteId sprite, WP_Rect dstRect, float rotation) {
+        assert(sprite < m_instances.size() && "Sprite is not part of this layer");
+        m_instances[sprite].dstRect = dstRect.toVec4();
+        m_instances[sprite].rotation = rotation;
+        markDirty(sprite, 1);
+    }
+
+    void SpriteLayer::setColor(SpriteId sprite, glm::vec4 color) {
+        assert(sprite < m_instances.size() && "Sprite is not part of this layer");
+        m_instances[sprite].color = color;
+        markDirty(sprite, 1);
+    }
+
+    void SpriteLayer::clear() {
+        m_instances.clear();
+        m_dirtyRanges.clear();
+        m_batches.clear();
+        m_batchesDirty = false;
+        m_revision = NextRevision();
+    }
+
+    SpriteInstance SpriteLayer::makeInstance(TextureHandle texture, WP_Rect srcRect, WP_Rect dstRect, float rotation, glm::vec4 color) const {
+        // Atlased textures are stored as their page, so they batch with the rest of it
+        const auto [boundTexture, uv] = m_renderer.resolveSource(texture, srcRect);
+        return SpriteInstance{
+            .srcRect = uv,
+            .dstRect = dstRect.toVec4(),
+            .color = color,
+            .rotation = rotation,
+            .textureIndex = m_renderer.getTextureSlot(boundTexture),
+            .batchIndex = 0
+        };
+    }
+
+    void SpriteLayer::markDirty(uint32_t first, uint32_t count) {
+        m_revision = NextRevision();
+
+        // Sprites are usually touched in order, so extending the last range catches most of them
+        if (!m_dirtyRanges.empty() && first >= m_dirtyRanges.back().first && first <= m_dirtyRanges.back().second) {
+            m_dirtyRanges.back().second = std::max(m_dirtyRanges.back().second, first + count);
+            return;
+        }
+        m_dirtyRanges.emplace_back(first, first + count);
+    }
+}
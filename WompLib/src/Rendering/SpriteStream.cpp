@@ -0,0 +1,164 @@
+#include "SpriteStream.h"
+
+#include <algorithm>
+
+namespace womp {
+    namespace {
+        constexpr size_t MAX_GROUP_LOOKBACK = 32;
+
+        // Screen rect a draw can touch. Rotated draws use the circle around them, shapes grow by a pixel.
+        glm::vec4 DrawBounds(const glm::vec4& dstRect, float rotation) {
+            glm::vec2 extent = glm::abs(glm::vec2(dstRect.z, dstRect.w));
+            if (rotation != 0.0f) {
+                extent = glm::vec2(glm::length(extent));
+            }
+            extent += 1.0f;
+            return glm::vec4(glm::vec2(dstRect.x, dstRect.y) - extent, glm::vec2(dstRect.x, dstRect.y) + extent);
+        }
+
+        bool Overlaps(const glm::vec4& a, const glm::vec4& b) {
+            return a.x < b.z && b.x < a.z && a.y < b.w && b.y < a.w;
+        }
+
+        // Raw stream pointers, so stores into the mapped instance buffer don't force the vectors to be reloaded
+        struct StreamPointers {
+            const TextureHandle* textures;
+            const BlendMode* blendModes;
+            const glm::vec4* srcRects;
+            const glm::vec4* dstRects;
+            const glm::vec4* colors;
+            const float* rotations;
+            const uint32_t* clips;
+            const uint32_t* slots;      // Indexed by texture
+        };
+
+        template<typename IndexOf>
+        uint32_t WriteInstances(const StreamPointers draws, uint32_t count, IndexOf indexOf, const VkDescriptorSet* textureSets,
+                                VkDescriptorSet sharedSet, SpriteInstance* instances, std::vector<SpriteBatch>& batches) {
+            // Batches are closed when the set or blend mode changes instead of bumping batches.back() per instance
+            const VkDescriptorSet shapeSet = sharedSet != VK_NULL_HANDLE ? sharedSet : textureSets[SHAPE_TEXTURE];
+            const uint32_t firstDraw = indexOf(0);
+            VkDescriptorSet currentSet = sharedSet != VK_NULL_HANDLE ? sharedSet : textureSets[draws.textures[firstDraw]];
+            BlendMode currentBlendMode = draws.blendModes[firstDraw];
+            uint32_t batchStart = 0;
+            auto batchIndex = static_cast<uint32_t>(batches.size());
+
+            for (uint32_t i = 0; i < count; ++i) {
+                const uint32_t draw = indexOf(i);
+                const TextureHandle texture = draws.textures[draw];
+                const BlendMode blendMode = draws.blendModes[draw];
+
+                if (blendMode != currentBlendMode) {
+                    batches.push_back(SpriteBatch{currentSet, batchStart, i - batchStart, currentBlendMode});
+                    batchStart = i;
+                    batchIndex++;
+                    currentBlendMode = blendMode;
+                    if (sharedSet == VK_NULL_HANDLE) {
+                        currentSet = textureSets[texture];
+                    }
+                } else if (sharedSet == VK_NULL_HANDLE && texture != SHAPE_TEXTURE && textureSets[texture] != currentSet) {
+                    // Shapes sample nothing and join any batch, a batch of only shapes takes the next texture's set
+                    if (currentSet != shapeSet) {
+                        batches.push_back(SpriteBatch{currentSet, batchStart, i - batchStart, currentBlendMode});
+                        batchStart = i;
+                        batchIndex++;
+                    }
+                    currentSet = textureSets[texture];
+                }
+
+                instances[i] = SpriteInstance{
+                    .srcRect = draws.srcRects[draw],
+                    .dstRect = draws.dstRects[draw],
+                    .color = draws.colors[draw],
+                    .rotation = draws.rotations[draw],
+                    .textureIndex = draws.slots[texture],
+                    .batchIndex = batchIndex,
+                    .clipIndex = draws.clips[draw]
+                };
+            }
+            batches.push_back(SpriteBatch{currentSet, batchStart, count - batchStart, currentBlendMode});
+            return count;
+        }
+    }
+
+    void GroupDraws(const DrawStreams& draws, bool bindless, std::vector<uint32_t>& groups, std::vector<DrawGroup>& scratch) {
+        groups.resize(draws.size());
+        scratch.clear();
+
+        for (size_t i = 0; i < draws.size(); ++i) {
+            // Out of group ids the rest keep submission order after every group
+            if (scratch.size() > MAX_DRAW_GROUP) {
+                groups[i] = MAX_DRAW_GROUP;
+                continue;
+            }
+
+            const TextureHandle texture = bindless ? SHAPE_TEXTURE : draws.textures[i];
+            const BlendMode blendMode = draws.blendModes[i];
+            const uint8_t layer = draws.layers[i];
+            const glm::vec4 bounds = DrawBounds(draws.dstRects[i], draws.rotations[i]);
+
+            // Walks back from the newest group until one of the layer overlaps the draw, the draw may not go before it
+            size_t target = scratch.size();
+            const size_t oldest = scratch.size() - std::min(scratch.size(), MAX_GROUP_LOOKBACK);
+            for (size_t group = scratch.size(); group-- > oldest;) {
+                const DrawGroup& candidate = scratch[group];
+                if (candidate.layer != layer) {
+                    continue;
+                }
+                if (candidate.blendMode == blendMode &&
+                    (texture == SHAPE_TEXTURE || candidate.texture == SHAPE_TEXTURE || candidate.texture == texture)) {
+                    target = group;
+                }
+                if (Overlaps(candidate.bounds, bounds)) {
+                    break;
+                }
+            }
+
+            if (target == scratch.size()) {
+                scratch.push_back(DrawGroup{bounds, blendMode, texture, layer});
+            } else {
+                DrawGroup& group = scratch[target];
+                group.bounds = glm::vec4(glm::min(glm::vec2(group.bounds.x, group.bounds.y), glm::vec2(bounds.x, bounds.y)),
+                                         glm::max(glm::vec2(group.bounds.z, group.bounds.w), glm::vec2(bounds.z, bounds.w)));
+                if (group.texture == SHAPE_TEXTURE) {
+                    group.texture = texture;
+                }
+            }
+            groups[i] = static_cast<uint32_t>(target);
+        }
+    }
+
+    uint32_t WriteSpriteInstances(
+        const DrawStreams& draws,
+        const std::vector<SortItem>* order,
+        std::span<const VkDescriptorSet> textureSets,
+        std::span<const uint32_t> textureSlots,
+        VkDescriptorSet sharedSet,
+        SpriteInstance* instances,
+        std::vector<SpriteBatch>& batches
+    ) {
+        batches.clear();
+
+        const auto count = static_cast<uint32_t>(order ? order->size() : draws.size());
+        if (count == 0) {
+            return 0;
+        }
+
+        const StreamPointers streams{
+            draws.textures.data(),
+            draws.blendModes.data(),
+            draws.srcRects.data(),
+            draws.dstRects.data(),
+            draws.colors.data(),
+            draws.rotations.data(),
+            draws.clips.data(),
+            textureSlots.data()
+        };
+
+        if (order) {
+            const SortItem* items = order->data();
+            return WriteInstances(streams, count, [items](uint32_t i) { return items[i].index; }, textureSets.data(), sharedSet, instances, batches);
+        }
+        return WriteInstances(streams, count, [](uint32_t i) { return i; }, textureSets.data(), sharedSet, instances, batches);
+    }
+}
@@ -0,0 +1,43 @@
+#ifndef SPRITESTREAM_H
+#define SPRITESTREAM_H
+
+#include <span>
+#include <vector>
+
+#include "Core/RadixSort.h"
+#include "Rendering/DrawQueue.h"
+#include "Rendering/SpriteInstance.h"
+
+namespace womp {
+    // Draws of one layer that can be drawn in one run
+    struct DrawGroup {
+        glm::vec4 bounds;       // min xy, max xy of every draw in the group
+        BlendMode blendMode;
+        TextureHandle texture;  // SHAPE_TEXTURE while the group only holds shapes
+        uint8_t layer;
+    };
+
+    // Writes a group per draw, ordering by layer, group and sequence then keeps painter's order. A draw joins
+    // the oldest group of its layer with the same blend mode and texture (any texture when bindless) that no
+    // group created after it overlaps, else starts a new one. Only the last MAX_GROUP_LOOKBACK groups are
+    // searched and bounds are conservative, so a draw may start a group it could have joined but never
+    // jumps over a draw it overlaps.
+    void GroupDraws(const DrawStreams& draws, bool bindless, std::vector<uint32_t>& groups, std::vector<DrawGroup>& scratch);
+
+    // Writes one instance per draw, in the order of the sort items when given, and splits them into
+    // runs sharing a descriptor set and blend mode. textureSets and textureSlots are indexed by TextureHandle, the
+    // slot is the textureIndex written. A non null sharedSet is used for every draw instead of its set. Every texture in draws must have a set, shapes join the run they
+    // fall in and runs of only shapes use textureSets[SHAPE_TEXTURE]. Clip indices are written as they are,
+    // the frame's clip rects start with the unclipped one and continue with draws.clipRects. Returns the instance count.
+    uint32_t WriteSpriteInstances(
+        const DrawStreams& draws,
+        const std::vector<SortItem>* order,
+        std::span<const VkDescriptorSet> textureSets,
+        std::span<const uint32_t> textureSlots,
+        VkDescriptorSet sharedSet,
+        SpriteInstance* instances,
+        std::vector<SpriteBatch>& batches
+    );
+}
+
+#endif //SPRITESTREAM_H
@@ -110,13 +110,8 @@ namespace womp {
         submitInfo.signalSemaphoreCount = 1;
         submitInfo.pSignalSemaphores = signalSemaphores;
 
-        const VkQueue graphicsQueue = m_device.GetVkbDevice().get_queue(vkb::QueueType::graphics).value();
-
-
         vkResetFences(m_device.GetVkDevice(), 1, &m_inFlightFences[m_currentFrame]);
-        if (vkQueueSubmit(graphicsQueue, 1, &submitInfo, m_inFlightFences[m_currentFrame]) != VK_SUCCESS) {
-            throw std::runtime_error("failed to submit draw command buffer!");
-        }
+        m_device.SubmitGraphics(submitInfo, m_inFlightFences[m_currentFrame]);
 
         VkPresentInfoKHR presentInfo = {};
         presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
@@ -129,7 +124,7 @@ namespace womp {
         presentInfo.pImageIndices = imageIndex;
 
 
-        const VkResult result = vkQueuePresentKHR(graphicsQueue, &presentInfo);
+        const VkResult result = m_device.PresentGraphics(presentInfo);
         m_currentFrame = (m_currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
 
         return result;
@@ -21,6 +21,7 @@ namespace womp {
         [[nodiscard]] VkExtent2D GetSwapChainExtent() const { return m_swapchain.extent; }
         [[nodiscard]] size_t imageCount() const { return m_swapchain.image_count; }
         [[nodiscard]] VkFormat GetSwapChainImageFormat() const { return m_swapchain.image_format; }
+        [[nodiscard]] VkFormat GetDepthFormat() const { return m_swapChainDepthFormat; }
         [[nodiscard]] uint32_t GetWidth() const { return m_swapchain.extent.width; }
         [[nodiscard]] uint32_t GetHeight() const { return m_swapchain.extent.height; }
         [[nodiscard]] float ExtentAspectRatio() const;
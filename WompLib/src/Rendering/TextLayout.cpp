@@ -0,0 +1,117 @@
+#include "TextLayout.h"
+
+#include <algorithm>
+
+namespace womp {
+    namespace {
+        // Next code point of UTF-8 text, malformed bytes come out as U+FFFD one at a time
+        uint32_t DecodeUtf8(std::string_view text, size_t& i) {
+            const auto lead = static_cast<uint8_t>(text[i++]);
+            if (lead < 0x80) {
+                return lead;
+            }
+
+            int length;
+            uint32_t codepoint;
+            if ((lead & 0xE0) == 0xC0) {
+                length = 1;
+                codepoint = lead & 0x1F;
+            } else if ((lead & 0xF0) == 0xE0) {
+                length = 2;
+                codepoint = lead & 0x0F;
+            } else if ((lead & 0xF8) == 0xF0) {
+                length = 3;
+                codepoint = lead & 0x07;
+            } else {
+                return 0xFFFD;
+            }
+
+            if (i + length > text.size()) {
+                return 0xFFFD;
+            }
+            for (int j = 0; j < length; ++j) {
+                const auto continuation = static_cast<uint8_t>(text[i + j]);
+                if ((continuation & 0xC0) != 0x80) {
+                    return 0xFFFD;
+                }
+                codepoint = codepoint << 6 | (continuation & 0x3F);
+            }
+            i += length;
+            return codepoint;
+        }
+    }
+
+    TextLayout LayoutText(const FontFile& font, std::string_view text) {
+        TextLayout layout;
+        layout.glyphs.reserve(text.size());
+
+        const glm::vec2 atlasSize = font.getAtlasSize();
+        const FontGlyph* fallback = font.findGlyph('?');
+
+        glm::vec2 pen(0.0f);
+        float width = 0.0f;
+        int lines = 1;
+        uint32_t previous = 0;
+
+        for (size_t i = 0; i < text.size();) {
+            const uint32_t codepoint = DecodeUtf8(text, i);
+            if (codepoint == '\n') {
+                width = std::max(width, pen.x);
+                pen = glm::vec2(0.0f, pen.y - font.getLineHeight());
+                ++lines;
+                previous = 0;
+                continue;
+            }
+
+            const FontGlyph* glyph = font.findGlyph(codepoint);
+            if (!glyph) {
+                glyph = fallback;
+                if (!glyph) continue;
+            }
+
+            pen.x += font.getKerning(previous, codepoint);
+            previous = codepoint;
+
+            if (glyph->size.x > 0.0f && glyph->size.y > 0.0f) {
+                // Metrics point down from the top of the line, sprite coordinates point up
+                const float top = pen.y + font.getBase() - glyph->offset.y;
+                layout.glyphs.push_back(TextGlyph{
+                    .uvRect = glm::vec4(
+                        glyph->atlasPosition.x / atlasSize.x,
+                        1.0f - (glyph->atlasPosition.y + glyph->size.y) / atlasSize.y,
+                        glyph->size.x / atlasSize.x,
+                        glyph->size.y / atlasSize.y
+                    ),
+                    .rect = glm::vec4(pen.x + glyph->offset.x, top - glyph->size.y, glyph->size.x, glyph->size.y)
+                });
+            }
+            pen.x += glyph->advance;
+        }
+
+        layout.size = glm::vec2(std::max(width, pen.x), static_cast<float>(lines) * font.getLineHeight());
+        return layout;
+    }
+
+    const TextLayout& TextLayoutCache::get(uint64_t key, uint32_t font, const FontFile& fontFile, std::string_view text) {
+        Entry& entry = m_entries[key];
+        if (entry.lastUsed == 0 || entry.font != font || entry.text != text) {
+            entry.font = font;
+            entry.text = text;
+            entry.layout = LayoutText(fontFile, text);
+        }
+        entry.lastUsed = m_frame + 1;
+        return entry.layout;
+    }
+
+    void TextLayoutCache::endFrame() {
+        ++m_frame;
+        if (m_frame % EVICT_AFTER_FRAMES != 0) {
+            return;
+        }
+
+        // A sweep every EVICT_AFTER_FRAMES frames keeps the per frame cost to a counter bump
+        std::erase_if(m_entries, [this](const auto& item) {
+            return item.second.lastUsed + EVICT_AFTER_FRAMES < m_frame;
+        });
+    }
+}
@@ -0,0 +1,53 @@
+#ifndef TEXTLAYOUT_H
+#define TEXTLAYOUT_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "Core/FontFile.h"
+
+namespace womp {
+    struct TextGlyph {
+        glm::vec4 uvRect;   // Normalized like a sprite's source rect
+        glm::vec4 rect;     // Lower left corner and size, in font texels from the start of the first baseline
+    };
+
+    // Glyph quads of a string at the size its font was baked at, independent of where it is drawn
+    struct TextLayout {
+        std::vector<TextGlyph> glyphs{};
+        glm::vec2 size{};   // Widest line by the line count times the line height
+    };
+
+    // Shapes UTF-8 text left to right with kerning, '\n' starts a new line below. Code points the font
+    // doesn't have fall back to '?', or take no space without it.
+    TextLayout LayoutText(const FontFile& font, std::string_view text);
+
+    // Layouts of the strings drawn recently, so unchanged text is shaped once. Entries that go unused for
+    // EVICT_AFTER_FRAMES frames are dropped by endFrame. Layouts stay put in memory until they are evicted.
+    class TextLayoutCache {
+    public:
+        static constexpr uint64_t EVICT_AFTER_FRAMES = 120;
+
+        // key identifies font and text, a colliding entry is shaped again
+        const TextLayout& get(uint64_t key, uint32_t font, const FontFile& fontFile, std::string_view text);
+        void endFrame();
+
+        [[nodiscard]] size_t size() const { return m_entries.size(); }
+
+    private:
+        struct Entry {
+            uint32_t font{};
+            std::string text{};
+            TextLayout layout{};
+            uint64_t lastUsed{};
+        };
+
+        std::unordered_map<uint64_t, Entry> m_entries{};
+        uint64_t m_frame{};
+    };
+}
+
+#endif //TEXTLAYOUT_H
@@ -0,0 +1,110 @@
+#include <womp/Tilemap.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#include <womp/WompRenderer.h>
+
+namespace womp {
+    Tilemap::Tilemap(const WompRenderer& renderer, glm::ivec2 size, TextureHandle tileset, glm::ivec2 tilesetTileSize):
+        m_size{size},
+        m_chunkCount{(size.x + CHUNK_SIZE - 1) / CHUNK_SIZE, (size.y + CHUNK_SIZE - 1) / CHUNK_SIZE},
+        m_tileSize{tilesetTileSize} {
+        assert(size.x > 0 && size.y > 0 && "Tilemap needs at least one tile");
+        assert(tilesetTileSize.x > 0 && tilesetTileSize.y > 0 && "Tileset tiles need a size");
+
+        const auto chunkCount = static_cast<size_t>(m_chunkCount.x) * m_chunkCount.y;
+        m_tiles.assign(chunkCount * CHUNK_TILES, EMPTY_TILE);
+        m_dirtyRanges.assign(chunkCount, {CHUNK_TILES, 0});
+
+        // Tiles are resolved like sprite source rects, so an atlased tileset samples from its page.
+        // Source rects count up from the bottom of the texture, tiles are numbered from the top.
+        const glm::vec2 textureSize = renderer.getTextureSize(tileset);
+        const int columns = static_cast<int>(textureSize.x) / tilesetTileSize.x;
+        const int rows = static_cast<int>(textureSize.y) / tilesetTileSize.y;
+        m_tileUVs.reserve(static_cast<size_t>(std::max(columns * rows, 0)));
+        for (int row = 0; row < rows; ++row) {
+            for (int column = 0; column < columns; ++column) {
+                const WP_Rect srcRect{
+                    static_cast<float>(column * tilesetTileSize.x),
+                    textureSize.y - static_cast<float>((row + 1) * tilesetTileSize.y),
+                    static_cast<float>(tilesetTileSize.x),
+                    static_cast<float>(tilesetTileSize.y)
+                };
+                const auto [texture, uv] = renderer.resolveSource(tileset, srcRect);
+                m_texture = texture;
+                m_tileUVs.push_back(uv);
+            }
+        }
+    }
+
+    void Tilemap::setTile(glm::ivec2 position, uint32_t tile) {
+        assert(position.x >= 0 && position.y >= 0 && position.x < m_size.x && position.y < m_size.y && "Tile is outside the tilemap");
+        assert((tile == EMPTY_TILE || tile < m_tileUVs.size()) && "Tile is not part of the tileset");
+
+        const uint32_t offset = tileOffset(position);
+        if (m_tiles[offset] == tile) {
+            return;
+        }
+        m_tiles[offset] = tile;
+
+        auto& [first, end] = m_dirtyRanges[offset / CHUNK_TILES];
+        first = std::min(first, offset % CHUNK_TILES);
+        end = std::max(end, offset % CHUNK_TILES + 1);
+        m_revision = NextRevision();
+    }
+
+    uint32_t Tilemap::getTile(glm::ivec2 position) const {
+        assert(position.x >= 0 && position.y >= 0 && position.x < m_size.x && position.y < m_size.y && "Tile is outside the tilemap");
+        return m_tiles[tileOffset(position)];
+    }
+
+    void Tilemap::fill(uint32_t tile) {
+        assert((tile == EMPTY_TILE || tile < m_tileUVs.size()) && "Tile is not part of the tileset");
+
+        for (int y = 0; y < m_size.y; ++y) {
+            for (int x = 0; x < m_size.x; ++x) {
+                m_tiles[tileOffset(glm::ivec2(x, y))] = tile;
+            }
+        }
+        m_allDirty = true;
+        m_revision = NextRevision();
+    }
+
+    void Tilemap::setPosition(glm::vec2 position) {
+        m_position = position;
+        m_revision = NextRevision();
+    }
+
+    void Tilemap::setTileSize(glm::vec2 tileSize) {
+        m_tileSize = tileSize;
+        m_revision = NextRevision();
+    }
+
+    void Tilemap::setColor(glm::vec4 color) {
+        m_color = color;
+        m_revision = NextRevision();
+    }
+
+    uint32_t Tilemap::tileOffset(glm::ivec2 position) const {
+        const uint32_t chunk = position.y / CHUNK_SIZE * m_chunkCount.x + position.x / CHUNK_SIZE;
+        return chunk * CHUNK_TILES + position.y % CHUNK_SIZE * CHUNK_SIZE + position.x % CHUNK_SIZE;
+    }
+
+    std::pair<glm::ivec2, glm::ivec2> Tilemap::getVisibleChunks(glm::vec2 screenSize) const {
+        if (m_tileSize.x <= 0.0f || m_tileSize.y <= 0.0f) {
+            return {glm::ivec2(0), glm::ivec2(-1)};
+        }
+
+        const glm::vec2 chunkPixels = m_tileSize * static_cast<float>(CHUNK_SIZE);
+        const glm::vec2 first = glm::vec2(-m_position.x, -m_position.y) / chunkPixels;
+        const glm::vec2 last = (screenSize - m_position) / chunkPixels;
+
+        // A chunk that only touches the screen edge isn't visible
+        return {
+            glm::ivec2(std::max(static_cast<int>(std::floor(first.x)), 0), std::max(static_cast<int>(std::floor(first.y)), 0)),
+            glm::ivec2(std::min(static_cast<int>(std::ceil(last.x)) - 1, m_chunkCount.x - 1), std::min(static_cast<int>(std::ceil(last.y)) - 1, m_chunkCount.y - 1))
+        };
+    }
+}
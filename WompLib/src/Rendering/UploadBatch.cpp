@@ -0,0 +1,463 @@
+#include "UploadBatch.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#include "Rendering/Resources/Image.h"
+
+namespace {
+    struct LayoutAccess {
+        VkAccessFlags access;
+        VkPipelineStageFlags stage;
+    };
+
+    // What is done to an image in a layout, for both sides of a transition
+    LayoutAccess GetLayoutAccess(VkImageLayout layout) {
+        switch (layout) {
+            case VK_IMAGE_LAYOUT_UNDEFINED:
+                return {0, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT};
+            case VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL:
+                return {VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT};
+            case VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL:
+                return {VK_ACCESS_TRANSFER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT};
+            case VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL:
+                return {VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT};
+            case VK_IMAGE_LAYOUT_GENERAL:
+                return {VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT};
+            default:
+                return {VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT};
+        }
+    }
+
+    bool IsTransferLayout(VkImageLayout layout) {
+        return layout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL || layout == VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    }
+}
+
+namespace womp {
+    UploadBatch::UploadBatch(Device& device, UploadQueue queue)
+        : m_device{device}, m_separateQueue{queue == UploadQueue::Transfer && device.HasSeparateTransferQueue()} {
+        m_commandPool = createCommandPool(m_separateQueue ? device.GetTransferQueueFamily() : device.GetGraphicsQueueFamily(), m_commandBuffer);
+        m_fence = createFence();
+
+        if (m_separateQueue) {
+            m_acquireCommandPool = createCommandPool(device.GetGraphicsQueueFamily(), m_acquireCommandBuffer);
+            m_transferFence = createFence();
+
+            VkSemaphoreCreateInfo semaphoreInfo{};
+            semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+            if (vkCreateSemaphore(device.GetVkDevice(), &semaphoreInfo, nullptr, &m_transferSemaphore) != VK_SUCCESS) {
+                throw std::runtime_error("failed to create upload semaphore!");
+            }
+        }
+
+        VkCommandBufferBeginInfo beginInfo{};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        vkBeginCommandBuffer(m_commandBuffer, &beginInfo);
+    }
+
+    UploadBatch::~UploadBatch() {
+        // The staging buffers and the command buffers may still be in use
+        if (m_acquireSubmitted) {
+            wait();
+        } else if (m_submitted) {
+            vkWaitForFences(m_device.GetVkDevice(), 1, &m_transferFence, VK_TRUE, std::numeric_limits<uint64_t>::max());
+        }
+
+        const VkDevice device = m_device.GetVkDevice();
+        vkDestroySemaphore(device, m_transferSemaphore, nullptr);
+        vkDestroyFence(device, m_transferFence, nullptr);
+        vkDestroyFence(device, m_fence, nullptr);
+        vkDestroyCommandPool(device, m_acquireCommandPool, nullptr);
+        vkDestroyCommandPool(device, m_commandPool, nullptr);
+    }
+
+    VkBuffer UploadBatch::stage(const void* data, VkDeviceSize size) {
+        const auto& staging = m_stagingBuffers.emplace_back(std::make_unique<Buffer>(m_device, size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_CPU_ONLY));
+        staging->copyTo(data, size);
+        return staging->getBuffer();
+    }
+
+    Buffer& UploadBatch::allocateStaging(VkDeviceSize size) {
+        // Flushed on submit
+        return *m_stagingBuffers.emplace_back(std::make_unique<Buffer>(m_device, size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_CPU_ONLY, true));
+    }
+
+    void UploadBatch::keepAlive(std::shared_ptr<Buffer> buffer) {
+        m_retainedBuffers.push_back(std::move(buffer));
+    }
+
+    void UploadBatch::copyBuffer(VkBuffer source, VkBuffer destination, const VkBufferCopy& region) {
+        vkCmdCopyBuffer(getCommandBuffer(), source, destination, 1, &region);
+
+        if (m_separateQueue) {
+            VkBufferMemoryBarrier release{};
+            release.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+            release.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            release.dstAccessMask = 0;
+            release.srcQueueFamilyIndex = m_device.GetTransferQueueFamily();
+            release.dstQueueFamilyIndex = m_device.GetGraphicsQueueFamily();
+            release.buffer = destination;
+            release.offset = region.dstOffset;
+            release.size = region.size;
+            m_releaseBufferBarriers.push_back(release);
+        }
+    }
+
+    void UploadBatch::copyBufferToImage(VkBuffer source, VkImage image, const VkBufferImageCopy& region) {
+        vkCmdCopyBufferToImage(getCommandBuffer(), source, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+    }
+
+    void UploadBatch::imageBarrier(const VkImageMemoryBarrier& barrier, VkPipelineStageFlags srcStage, VkPipelineStageFlags dstStage) {
+        assert(!m_submitted && "Cannot record into a submitted UploadBatch");
+
+        // Barriers in one vkCmdPipelineBarrier are unordered, a second transition of the same image
+        // continues the pending one when it can and otherwise has to wait for the next call
+        for (VkImageMemoryBarrier& pending: m_pendingBarriers) {
+            if (pending.image != barrier.image) continue;
+
+            const VkImageSubresourceRange& a = pending.subresourceRange;
+            const VkImageSubresourceRange& b = barrier.subresourceRange;
+            if (pending.newLayout == barrier.oldLayout && a.aspectMask == b.aspectMask && a.baseMipLevel == b.baseMipLevel &&
+                a.levelCount == b.levelCount && a.baseArrayLayer == b.baseArrayLayer && a.layerCount == b.layerCount &&
+                pending.srcQueueFamilyIndex == barrier.srcQueueFamilyIndex && pending.dstQueueFamilyIndex == barrier.dstQueueFamilyIndex) {
+                pending.newLayout = barrier.newLayout;
+                pending.dstAccessMask = barrier.dstAccessMask;
+                m_pendingDstStages |= dstStage;
+                return;
+            }
+            flushBarriers();
+            break;
+        }
+
+        m_pendingBarriers.push_back(barrier);
+        m_pendingSrcStages |= srcStage;
+        m_pendingDstStages |= dstStage;
+    }
+
+    void UploadBatch::transitionImage(VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout, uint32_t mipLevels) {
+        const LayoutAccess source = GetLayoutAccess(oldLayout);
+        const LayoutAccess destination = GetLayoutAccess(newLayout);
+
+        VkImageMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.oldLayout = oldLayout;
+        barrier.newLayout = newLayout;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image = image;
+        barrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, mipLevels, 0, 1};
+        barrier.srcAccessMask = source.access;
+        barrier.dstAccessMask = destination.access;
+
+        const bool fromTransfer = oldLayout == VK_IMAGE_LAYOUT_UNDEFINED || IsTransferLayout(oldLayout);
+        if (!m_separateQueue || IsTransferLayout(newLayout)) {
+            assert((!m_separateQueue || fromTransfer) && "The graphics queue owns this image, transition it in an UploadQueue::Graphics batch");
+            imageBarrier(barrier, source.stage, destination.stage);
+            return;
+        }
+        assert(fromTransfer && "The graphics queue owns this image, transition it in an UploadQueue::Graphics batch");
+
+        // Leaving the transfer layouts hands the image to the graphics queue. Undefined contents have
+        // nothing to hand over, the transition is only done on the graphics side.
+        if (oldLayout != VK_IMAGE_LAYOUT_UNDEFINED) {
+            barrier.srcQueueFamilyIndex = m_device.GetTransferQueueFamily();
+            barrier.dstQueueFamilyIndex = m_device.GetGraphicsQueueFamily();
+
+            VkImageMemoryBarrier release = barrier;
+            release.dstAccessMask = 0;
+            imageBarrier(release, source.stage, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+        }
+
+        barrier.srcAccessMask = 0;
+        m_acquireBarriers.push_back(barrier);
+        m_acquireDstStages |= destination.stage;
+    }
+
+    void UploadBatch::uploadImage(Image& image, const void* pixels, VkDeviceSize size) {
+        const VkBuffer staging = stage(pixels, size);
+
+        transitionImage(image.getImage(), VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, image.GetMipLevels());
+
+        VkBufferImageCopy region{};
+        region.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+        region.imageExtent = {image.GetExtent().width, image.GetExtent().height, 1};
+        copyBufferToImage(staging, image.getImage(), region);
+
+        if (image.GetMipLevels() > 1) {
+            generateMipmaps(image);
+            return;
+        }
+        transitionImage(image.getImage(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+        image.SetCurrentLayout(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    }
+
+    void UploadBatch::uploadImageLevels(Image& image, std::span<const std::span<const uint8_t>> levels) {
+        assert(levels.size() == image.GetMipLevels() && "Every level of the image needs its data");
+
+        // One staging buffer for the chain, offsets stay a multiple of the largest block size
+        constexpr VkDeviceSize LEVEL_ALIGNMENT = 16;
+        std::vector<VkDeviceSize> offsets;
+        VkDeviceSize size = 0;
+        for (const auto& level: levels) {
+            offsets.push_back(size);
+            size = (size + level.size() + LEVEL_ALIGNMENT - 1) / LEVEL_ALIGNMENT * LEVEL_ALIGNMENT;
+        }
+
+        const Buffer& staging = allocateStaging(size);
+        for (size_t level = 0; level < levels.size(); ++level) {
+            std::memcpy(static_cast<uint8_t*>(staging.GetRawData()) + offsets[level], levels[level].data(), levels[level].size());
+        }
+
+        transitionImage(image.getImage(), VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, image.GetMipLevels());
+
+        const VkExtent2D extent = image.GetExtent();
+        for (uint32_t level = 0; level < image.GetMipLevels(); ++level) {
+            VkBufferImageCopy region{};
+            region.bufferOffset = offsets[level];
+            region.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, level, 0, 1};
+            region.imageExtent = {std::max(extent.width >> level, 1u), std::max(extent.height >> level, 1u), 1};
+            copyBufferToImage(staging.getBuffer(), image.getImage(), region);
+        }
+
+        transitionImage(image.getImage(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, image.GetMipLevels());
+        image.SetCurrentLayout(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    }
+
+    void UploadBatch::generateMipmaps(Image& image) {
+        if (m_separateQueue) {
+            // Blits and dispatches need the graphics queue, the whole image moves over in TRANSFER_DST
+            VkImageMemoryBarrier barrier{};
+            barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+            barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+            barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+            barrier.srcQueueFamilyIndex = m_device.GetTransferQueueFamily();
+            barrier.dstQueueFamilyIndex = m_device.GetGraphicsQueueFamily();
+            barrier.image = image.getImage();
+            barrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, image.GetMipLevels(), 0, 1};
+            barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            barrier.dstAccessMask = 0;
+            imageBarrier(barrier, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+
+            barrier.srcAccessMask = 0;
+            barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+            m_acquireBarriers.push_back(barrier);
+            m_acquireDstStages |= VK_PIPELINE_STAGE_TRANSFER_BIT;
+        }
+
+        const VkCommandBuffer commandBuffer = getGraphicsCommandBuffer();
+        if (MipmapGenerator::CanBlit(m_device, image.GetFormat())) {
+            MipmapGenerator::RecordBlits(commandBuffer, image);
+        } else {
+            m_mipmapResources.push_back(m_device.GetMipmapGenerator().recordDownsample(commandBuffer, image));
+        }
+        image.SetCurrentLayout(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    }
+
+    VkCommandBuffer UploadBatch::getCommandBuffer() {
+        assert(!m_submitted && "Cannot record into a submitted UploadBatch");
+        flushBarriers();
+        m_recorded = true;
+        return m_commandBuffer;
+    }
+
+    void UploadBatch::submit(bool acquireNow) {
+        assert(!m_submitted && "UploadBatch submitted twice");
+        flushBarriers();
+        if (!m_releaseBufferBarriers.empty()) {
+            vkCmdPipelineBarrier(
+                m_commandBuffer,
+                VK_PIPELINE_STAGE_TRANSFER_BIT,
+                VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                0,
+                0, nullptr,
+                static_cast<uint32_t>(m_releaseBufferBarriers.size()), m_releaseBufferBarriers.data(),
+                0, nullptr
+            );
+        }
+        vkEndCommandBuffer(m_commandBuffer);
+
+        for (const auto& staging: m_stagingBuffers) {
+            if (staging->isMapped()) {
+                staging->flush();
+            }
+        }
+
+        VkSubmitInfo submitInfo{};
+        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers = &m_commandBuffer;
+
+        if (!m_separateQueue) {
+            m_device.SubmitGraphics(submitInfo, m_fence);
+            m_submitted = true;
+            m_acquireSubmitted = true;
+            return;
+        }
+
+        recordAcquire();
+
+        submitInfo.signalSemaphoreCount = 1;
+        submitInfo.pSignalSemaphores = &m_transferSemaphore;
+        m_device.SubmitTransfer(submitInfo, m_transferFence);
+        m_submitted = true;
+
+        if (acquireNow) {
+            submitAcquire();
+        }
+    }
+
+    void UploadBatch::submitAcquire() {
+        assert(m_submitted && "Submit an UploadBatch before its acquire");
+        if (m_acquireSubmitted) {
+            return;
+        }
+
+        // Only this submit waits, graphics work after it waits through the acquire barriers alone
+        const VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+
+        VkSubmitInfo submitInfo{};
+        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.waitSemaphoreCount = 1;
+        submitInfo.pWaitSemaphores = &m_transferSemaphore;
+        submitInfo.pWaitDstStageMask = &waitStage;
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers = &m_acquireCommandBuffer;
+
+        m_device.SubmitGraphics(submitInfo, m_fence);
+        m_acquireSubmitted = true;
+    }
+
+    void UploadBatch::submitAndWait() {
+        submit();
+        wait();
+    }
+
+    bool UploadBatch::isTransferComplete() const {
+        return m_submitted && vkGetFenceStatus(m_device.GetVkDevice(), m_separateQueue ? m_transferFence : m_fence) == VK_SUCCESS;
+    }
+
+    bool UploadBatch::isComplete() const {
+        return m_acquireSubmitted && vkGetFenceStatus(m_device.GetVkDevice(), m_fence) == VK_SUCCESS;
+    }
+
+    void UploadBatch::wait() const {
+        assert(m_acquireSubmitted && "Waiting on an UploadBatch that was never submitted or whose acquire is deferred");
+        vkWaitForFences(m_device.GetVkDevice(), 1, &m_fence, VK_TRUE, std::numeric_limits<uint64_t>::max());
+    }
+
+    VkCommandPool UploadBatch::createCommandPool(uint32_t queueFamily, VkCommandBuffer& commandBuffer) const {
+        VkCommandPoolCreateInfo poolInfo{};
+        poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        poolInfo.queueFamilyIndex = queueFamily;
+        poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+
+        VkCommandPool commandPool;
+        if (vkCreateCommandPool(m_device.GetVkDevice(), &poolInfo, nullptr, &commandPool) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create upload command pool!");
+        }
+
+        VkCommandBufferAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        allocInfo.commandPool = commandPool;
+        allocInfo.commandBufferCount = 1;
+        if (vkAllocateCommandBuffers(m_device.GetVkDevice(), &allocInfo, &commandBuffer) != VK_SUCCESS) {
+            throw std::runtime_error("failed to allocate upload command buffer!");
+        }
+        return commandPool;
+    }
+
+    VkFence UploadBatch::createFence() const {
+        VkFenceCreateInfo fenceInfo{};
+        fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+        VkFence fence;
+        if (vkCreateFence(m_device.GetVkDevice(), &fenceInfo, nullptr, &fence) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create upload fence!");
+        }
+        return fence;
+    }
+
+    void UploadBatch::flushBarriers() {
+        if (m_pendingBarriers.empty()) {
+            return;
+        }
+
+        vkCmdPipelineBarrier(
+            m_commandBuffer,
+            m_pendingSrcStages,
+            m_pendingDstStages,
+            0,
+            0, nullptr,
+            0, nullptr,
+            static_cast<uint32_t>(m_pendingBarriers.size()), m_pendingBarriers.data()
+        );
+
+        m_pendingBarriers.clear();
+        m_pendingSrcStages = 0;
+        m_pendingDstStages = 0;
+        m_recorded = true;
+    }
+
+    VkCommandBuffer UploadBatch::getGraphicsCommandBuffer() {
+        if (!m_separateQueue) {
+            return getCommandBuffer();
+        }
+        assert(!m_submitted && "Cannot record into a submitted UploadBatch");
+
+        if (!m_acquireBegun) {
+            VkCommandBufferBeginInfo beginInfo{};
+            beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+            beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+            vkBeginCommandBuffer(m_acquireCommandBuffer, &beginInfo);
+            m_acquireBegun = true;
+        }
+
+        // Whatever is recorded next may use the images acquired so far
+        if (!m_acquireBarriers.empty()) {
+            vkCmdPipelineBarrier(
+                m_acquireCommandBuffer,
+                VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                m_acquireDstStages,
+                0,
+                0, nullptr,
+                0, nullptr,
+                static_cast<uint32_t>(m_acquireBarriers.size()), m_acquireBarriers.data()
+            );
+            m_acquireBarriers.clear();
+            m_acquireDstStages = 0;
+        }
+        return m_acquireCommandBuffer;
+    }
+
+    void UploadBatch::recordAcquire() {
+        // Records the image acquires not recorded yet
+        const VkCommandBuffer commandBuffer = getGraphicsCommandBuffer();
+
+        // Mirrors of the releases, a buffer can be read by anything once it is back
+        std::vector<VkBufferMemoryBarrier> bufferBarriers = m_releaseBufferBarriers;
+        for (VkBufferMemoryBarrier& barrier: bufferBarriers) {
+            barrier.srcAccessMask = 0;
+            barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+        }
+
+        if (!bufferBarriers.empty()) {
+            vkCmdPipelineBarrier(
+                commandBuffer,
+                VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                0,
+                0, nullptr,
+                static_cast<uint32_t>(bufferBarriers.size()), bufferBarriers.data(),
+                0, nullptr
+            );
+        }
+
+        vkEndCommandBuffer(commandBuffer);
+    }
+}
@@ -0,0 +1,127 @@
+#ifndef UPLOADBATCH_H
+#define UPLOADBATCH_H
+
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "Rendering/Device.h"
+#include "Rendering/MipmapGenerator.h"
+#include "Rendering/Resources/Buffer.h"
+
+namespace womp {
+    class Image;
+
+    enum class UploadQueue : uint8_t {
+        Transfer,   // Overlaps rendering when the device has a separate transfer family
+        Graphics    // For resources the graphics queue already uses, like atlas pages being added to
+    };
+
+    // Records any number of copies and layout transitions into one command buffer that is submitted
+    // once and signals a fence, instead of a submit and a queue wait per operation. Image barriers
+    // are collected and recorded together right before the next copy or the submit, so uploading N
+    // images costs N + 1 vkCmdPipelineBarrier calls rather than 2N.
+    //
+    // On a separate transfer queue, images leaving the transfer layouts and buffers copied into are
+    // released to the graphics family, and a second submit on the graphics queue acquires them after
+    // waiting on a semaphore the copies signal. Without a separate family everything is one submit
+    // on the graphics queue.
+    //
+    // Each batch has its own command pools, batches can be recorded on any thread. Staging memory
+    // is owned by the batch and released when it is destroyed, which waits for a submitted batch.
+    class UploadBatch {
+    public:
+        explicit UploadBatch(Device& device, UploadQueue queue = UploadQueue::Transfer);
+        ~UploadBatch();
+
+        UploadBatch(const UploadBatch& other) = delete;
+        UploadBatch(UploadBatch&& other) noexcept = delete;
+        UploadBatch& operator=(const UploadBatch& other) = delete;
+        UploadBatch& operator=(UploadBatch&& other) noexcept = delete;
+
+        // Copies data into staging memory owned by the batch, to copy from at offset 0
+        VkBuffer stage(const void* data, VkDeviceSize size);
+        // Mapped staging memory owned by the batch, for callers that write into it themselves
+        Buffer& allocateStaging(VkDeviceSize size);
+        // Keeps a buffer the batch reads from alive until the batch is destroyed
+        void keepAlive(std::shared_ptr<Buffer> buffer);
+
+        void copyBuffer(VkBuffer source, VkBuffer destination, const VkBufferCopy& region);
+        void copyBufferToImage(VkBuffer source, VkImage image, const VkBufferImageCopy& region);
+
+        // Queued until the next copy or the submit, then recorded with the other pending barriers
+        void imageBarrier(const VkImageMemoryBarrier& barrier, VkPipelineStageFlags srcStage, VkPipelineStageFlags dstStage);
+        // Barrier over the first mipLevels levels, access masks and stages follow from the layouts.
+        // On a separate transfer queue only images the graphics queue has not used yet can be transitioned.
+        void transitionImage(VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout, uint32_t mipLevels = 1);
+
+        // Fills the first level with tightly packed pixels, generates the others and leaves the image shader readable
+        void uploadImage(Image& image, const void* pixels, VkDeviceSize size);
+        // Copies every level as it is stored, tightly packed texels or blocks with the largest level first.
+        // For block compressed images, which can't have levels generated.
+        void uploadImageLevels(Image& image, std::span<const std::span<const uint8_t>> levels);
+        // Every level has to be in TRANSFER_DST_OPTIMAL with the first one written. Recorded on the graphics
+        // queue's side of the batch, in the acquire submit when there are two.
+        void generateMipmaps(Image& image);
+
+        // For recording anything else on the upload queue, pending barriers are recorded first
+        VkCommandBuffer getCommandBuffer();
+
+        // Does not block, nothing can be recorded afterwards. With acquireNow false the graphics
+        // queue's half is left to submitAcquire, so frames submitted meanwhile never wait on the copies.
+        void submit(bool acquireNow = true);
+        // Call once isTransferComplete, before the frame that uses the uploaded resources is submitted
+        void submitAcquire();
+        void submitAndWait();
+
+        [[nodiscard]] bool isSubmitted() const { return m_submitted; }
+        // Polls the copies, past this point submitAcquire does not make the graphics queue wait
+        [[nodiscard]] bool isTransferComplete() const;
+        // Polls the whole batch, a batch that was never submitted is not complete
+        [[nodiscard]] bool isComplete() const;
+        void wait() const;
+
+        [[nodiscard]] bool isEmpty() const { return !m_recorded && m_pendingBarriers.empty() && m_acquireBarriers.empty(); }
+        [[nodiscard]] bool usesSeparateQueue() const { return m_separateQueue; }
+
+    private:
+        VkCommandPool createCommandPool(uint32_t queueFamily, VkCommandBuffer& commandBuffer) const;
+        VkFence createFence() const;
+        void flushBarriers();
+        // Where work needing a graphics queue is recorded, begun on first use after the acquire barriers so far
+        VkCommandBuffer getGraphicsCommandBuffer();
+        void recordAcquire();
+
+        Device& m_device;
+        bool m_separateQueue{false};
+
+        VkCommandPool m_commandPool{VK_NULL_HANDLE};
+        VkCommandBuffer m_commandBuffer{VK_NULL_HANDLE};
+        VkFence m_fence{VK_NULL_HANDLE};    // Of the last submit, the graphics one when there are two
+
+        // Only with a separate transfer queue
+        VkCommandPool m_acquireCommandPool{VK_NULL_HANDLE};
+        VkCommandBuffer m_acquireCommandBuffer{VK_NULL_HANDLE};
+        VkFence m_transferFence{VK_NULL_HANDLE};
+        VkSemaphore m_transferSemaphore{VK_NULL_HANDLE};
+        bool m_acquireBegun{false};
+
+        bool m_recorded{false};
+        bool m_submitted{false};
+        bool m_acquireSubmitted{false};
+
+        std::vector<VkImageMemoryBarrier> m_pendingBarriers{};
+        VkPipelineStageFlags m_pendingSrcStages{0};
+        VkPipelineStageFlags m_pendingDstStages{0};
+
+        std::vector<VkImageMemoryBarrier> m_acquireBarriers{};
+        std::vector<VkBufferMemoryBarrier> m_releaseBufferBarriers{};
+        VkPipelineStageFlags m_acquireDstStages{0};
+
+        std::vector<std::unique_ptr<Buffer>> m_stagingBuffers{};
+        std::vector<std::shared_ptr<Buffer>> m_retainedBuffers{};
+        std::vector<MipmapGenerator::Resources> m_mipmapResources{};
+    };
+}
+
+#endif //UPLOADBATCH_H
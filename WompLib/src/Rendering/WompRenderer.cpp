@@ -1,37 +1,80 @@
 #include <womp/WompRenderer.h>
 
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+
 #include "DebugLabel.h"
+#include "Core/Hash.h"
+#include "MipmapGenerator.h"
+#include "SpriteStream.h"
+#include "stb_image.h"
+#include "UploadBatch.h"
 #include "Descriptors/DescriptorSetLayout.h"
 #include "Descriptors/DescriptorWriter.h"
 
 #include "basic_frag_spv.h"
 #include "basic_vert_spv.h"
-
-womp::WompRenderer::WompRenderer(Window& windowRef): m_framesInFlight(Swapchain::MAX_FRAMES_IN_FLIGHT) {
+#include "bindless_frag_spv.h"
+#include "cull_comp_spv.h"
+#include "particles_comp_spv.h"
+#include "pretransformed_vert_spv.h"
+#include "sdf_bindless_frag_spv.h"
+#include "sdf_frag_spv.h"
+#include "text_vert_spv.h"
+#include "tilemap_vert_spv.h"
+
+womp::WompRenderer::WompRenderer(Window& windowRef, const RendererSettings& settings): m_framesInFlight(Swapchain::MAX_FRAMES_IN_FLIGHT) {
     m_renderer = std::make_unique<Renderer>(windowRef);
 
     Device& deviceRef = m_renderer->getDevice();
     m_device = &deviceRef;
 
-    m_pendingDrawCommands.resize(m_framesInFlight * 10);
+    m_bindless = settings.bindlessTextures && deviceRef.IsBindlessSupported();
+    m_sortedSubmission = settings.sortedSubmission;
+    m_gpuCulling = settings.gpuCulling;
+    m_cpuTransform = settings.cpuTransform;
+    m_frameReplay = settings.frameReplay;
+    m_textureLoadThreads = std::max(settings.textureLoadThreads, 1u);
+
+    m_pendingDraws.reserve(INITIAL_INSTANCE_CAPACITY);
 
     m_descriptorPool = DescriptorPool::Builder(deviceRef)
             .setMaxSets(Swapchain::MAX_FRAMES_IN_FLIGHT * 100)
             .addPoolSize(VK_DESCRIPTOR_TYPE_SAMPLER, Swapchain::MAX_FRAMES_IN_FLIGHT * 100)
-            .addPoolSize(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, Swapchain::MAX_FRAMES_IN_FLIGHT * 2)
-            .build();
-
-    m_screenSizeDescriptorSetLayout = DescriptorSetLayout::Builder(deviceRef)
-            .addBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT)
             .build();
 
     m_textureDescriptorSetLayout = DescriptorSetLayout::Builder(deviceRef)
             .addBinding(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT)
             .build();
 
+    if (m_bindless) {
+        const uint32_t maxTextures = deviceRef.GetMaxBindlessTextures();
+
+        m_bindlessDescriptorPool = DescriptorPool::Builder(deviceRef)
+                .setMaxSets(1)
+                .setPoolFlags(VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT)
+                .addPoolSize(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, maxTextures)
+                .build();
+
+        m_bindlessDescriptorSetLayout = DescriptorSetLayout::Builder(deviceRef)
+                .addBinding(
+                    0,
+                    VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+                    VK_SHADER_STAGE_FRAGMENT_BIT,
+                    maxTextures,
+                    VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT |
+                    VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT |
+                    VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT)
+                .setLayoutFlags(VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT)
+                .build();
+
+        m_bindlessDescriptorPool->allocateDescriptor(m_bindlessDescriptorSetLayout->getDescriptorSetLayout(), m_bindlessDescriptorSet);
+    }
+
     const std::array descriptorSetLayouts = {
-        m_screenSizeDescriptorSetLayout->getDescriptorSetLayout(),
-        m_textureDescriptorSetLayout->getDescriptorSetLayout()
+        m_bindless ? m_bindlessDescriptorSetLayout->getDescriptorSetLayout() : m_textureDescriptorSetLayout->getDescriptorSetLayout()
     };
 
     VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
@@ -40,9 +83,9 @@ womp::WompRenderer::WompRenderer(Window& windowRef): m_framesInFlight(Swapchain:
     pipelineLayoutInfo.pSetLayouts = descriptorSetLayouts.data();
 
     VkPushConstantRange pushConstantRange{};
-    pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
     pushConstantRange.offset = 0;
-    pushConstantRange.size = sizeof(PushConstants);
+    pushConstantRange.size = sizeof(SpritePushConstants);
     pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
     pipelineLayoutInfo.pushConstantRangeCount = 1;
 
@@ -54,249 +97,1410 @@ womp::WompRenderer::WompRenderer(Window& windowRef): m_framesInFlight(Swapchain:
     Pipeline::DefaultPipelineConfigInfo(pipelineConfig);
 
     VkFormat swapchainFormat = m_renderer->getSwapchain().GetSwapChainImageFormat();
+    m_colorFormat = swapchainFormat;
 
-    pipelineConfig.pipelineLayout = m_pipelineLayout;
     pipelineConfig.colorAttachments = {swapchainFormat};
-
-    pipelineConfig.inputAssemblyInfo.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+    pipelineConfig.depthAttachment = m_renderer->getSwapchain().GetDepthFormat();
     pipelineConfig.rasterizationInfo.cullMode = VK_CULL_MODE_NONE;
 
-    m_pipeline = std::make_unique<Pipeline>(
-        deviceRef,
-        reinterpret_cast<const uint8_t*>(basic_vert_spv),
-        basic_vert_spv_len,
-        reinterpret_cast<const uint8_t*>(basic_frag_spv),
-        basic_frag_spv_len,
-        pipelineConfig
-    );
+    // Everything is drawn in order at the same depth, so depth testing would only reject overlapping sprites
+    pipelineConfig.depthStencilInfo.depthTestEnable = VK_FALSE;
+    pipelineConfig.depthStencilInfo.depthWriteEnable = VK_FALSE;
 
-    m_textureDescriptorSets.resize(Swapchain::MAX_FRAMES_IN_FLIGHT);
-    m_screenSizeDescriptorSets.resize(Swapchain::MAX_FRAMES_IN_FLIGHT);
+    // Quads are generated from gl_VertexIndex and sprites pulled from a buffer, no vertex input
+    pipelineConfig.vertexBindingDescriptions.clear();
+    pipelineConfig.vertexAttributeDescriptions.clear();
 
-    m_dummyImage = std::make_unique<Image>(deviceRef, VkExtent2D{100, 100}, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
+    m_pipelineCache = std::make_unique<PipelineCache>(deviceRef, pipelineConfig, settings.pipelineCachePath);
 
-    deviceRef.TransitionImageLayout(
-        m_dummyImage->getImage(),
-        VK_FORMAT_R8G8B8A8_SRGB,
-        VK_IMAGE_LAYOUT_UNDEFINED,
-        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-        1
-    );
+    const ShaderCode spriteFragment{
+        reinterpret_cast<const uint8_t*>(m_bindless ? bindless_frag_spv : basic_frag_spv),
+        m_bindless ? bindless_frag_spv_len : basic_frag_spv_len
+    };
 
-    const auto dummyInfo = m_dummyImage->descriptorInfo();
+    m_spritePipelineKey = PipelineKey{
+        .vertex = {reinterpret_cast<const uint8_t*>(basic_vert_spv), basic_vert_spv_len},
+        .fragment = spriteFragment,
+        .layout = m_pipelineLayout
+    };
+    m_pretransformedPipelineKey = m_spritePipelineKey;
+    m_pretransformedPipelineKey.vertex = {reinterpret_cast<const uint8_t*>(pretransformed_vert_spv), pretransformed_vert_spv_len};
 
-    m_screenSizeUniformBuffers.resize(m_framesInFlight);
+    // Alpha blending is drawn by every frame, the other modes are made when first used
+    m_pipelineCache->get(m_spritePipelineKey);
+    m_pipelineCache->get(m_pretransformedPipelineKey);
 
+    VkPushConstantRange tilemapPushConstantRange{};
+    tilemapPushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+    tilemapPushConstantRange.offset = 0;
+    tilemapPushConstantRange.size = sizeof(TilemapPushConstants);
 
-    for (size_t i{0}; i < m_framesInFlight; i++) {
-        m_descriptorPool->allocateDescriptor(m_textureDescriptorSetLayout->getDescriptorSetLayout(), m_textureDescriptorSets[i]);
+    VkPipelineLayoutCreateInfo tilemapPipelineLayoutInfo = pipelineLayoutInfo;
+    tilemapPipelineLayoutInfo.pPushConstantRanges = &tilemapPushConstantRange;
 
-        DescriptorWriter(*m_textureDescriptorSetLayout, *m_descriptorPool)
-                .writeImage(0, &dummyInfo)
-                .build(m_textureDescriptorSets[i]);
+    if (vkCreatePipelineLayout(deviceRef.GetVkDevice(), &tilemapPipelineLayoutInfo, nullptr, &m_tilemapPipelineLayout) != VK_SUCCESS) {
+        throw std::runtime_error("Could not make tilemap pipeline layout");
+    }
 
-        m_descriptorPool->allocateDescriptor(m_screenSizeDescriptorSetLayout->getDescriptorSetLayout(), m_screenSizeDescriptorSets[i]);
+    m_tilemapPipeline = &m_pipelineCache->get(PipelineKey{
+        .vertex = {reinterpret_cast<const uint8_t*>(tilemap_vert_spv), tilemap_vert_spv_len},
+        .fragment = spriteFragment,
+        .layout = m_tilemapPipelineLayout
+    });
 
-        m_screenSizeUniformBuffers[i] = std::make_unique<Buffer>(
-            deviceRef,
-            sizeof(glm::vec2),
-            VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-            VMA_MEMORY_USAGE_CPU_TO_GPU,
-            true
-        );
+    m_textPipeline = &m_pipelineCache->get(PipelineKey{
+        .vertex = {reinterpret_cast<const uint8_t*>(text_vert_spv), text_vert_spv_len},
+        .fragment = {
+            reinterpret_cast<const uint8_t*>(m_bindless ? sdf_bindless_frag_spv : sdf_frag_spv),
+            m_bindless ? sdf_bindless_frag_spv_len : sdf_frag_spv_len
+        },
+        .layout = m_pipelineLayout
+    });
 
-        auto screenSizeInfo = m_screenSizeUniformBuffers[i]->descriptorInfo();
-        DescriptorWriter(*m_screenSizeDescriptorSetLayout, *m_descriptorPool)
-            .writeBuffer(0, &screenSizeInfo)
-            .build(m_screenSizeDescriptorSets[i]);
+    VkPushConstantRange cullPushConstantRange{};
+    cullPushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    cullPushConstantRange.offset = 0;
+    cullPushConstantRange.size = sizeof(CullPushConstants);
+
+    VkPipelineLayoutCreateInfo cullPipelineLayoutInfo{};
+    cullPipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    cullPipelineLayoutInfo.setLayoutCount = 0;
+    cullPipelineLayoutInfo.pushConstantRangeCount = 1;
+    cullPipelineLayoutInfo.pPushConstantRanges = &cullPushConstantRange;
+
+    if (vkCreatePipelineLayout(deviceRef.GetVkDevice(), &cullPipelineLayoutInfo, nullptr, &m_cullPipelineLayout) != VK_SUCCESS) {
+        throw std::runtime_error("Could not make cull pipeline layout");
     }
 
-    const std::vector<Vertex> verticies = {
-        Vertex{glm::vec3(-1.0f, -1.0f, 0.0f), glm::vec2(0.0f, 0.0f)},
-        Vertex{glm::vec3(1.0f, -1.0f, 0.0f), glm::vec2(1.0f, 0.0f)},
-        Vertex{glm::vec3(1.0f, 1.0f, 0.0f), glm::vec2(1.0f, 1.0f)},
-        Vertex{glm::vec3(-1.0f, 1.0f, 0.0f), glm::vec2(0.0f, 1.0f)}
-    };
+    m_cullPipeline = std::make_unique<ComputePipeline>(
+        deviceRef,
+        reinterpret_cast<const uint8_t*>(cull_comp_spv),
+        cull_comp_spv_len,
+        m_cullPipelineLayout,
+        m_pipelineCache->getVkPipelineCache()
+    );
+    m_cullingFrames.resize(m_framesInFlight);
 
-    const std::vector<uint32_t> indices = {
-        0, 1, 2,
-        2, 3, 0
-    };
+    VkPushConstantRange particlePushConstantRange{};
+    particlePushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    particlePushConstantRange.offset = 0;
+    particlePushConstantRange.size = sizeof(ParticlePushConstants);
 
-    const auto vertexStaging = std::make_unique<Buffer>(deviceRef, sizeof(Vertex) * 4, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_AUTO, true);
+    VkPipelineLayoutCreateInfo particlePipelineLayoutInfo = cullPipelineLayoutInfo;
+    particlePipelineLayoutInfo.pPushConstantRanges = &particlePushConstantRange;
 
-    vertexStaging->map();
-    vertexStaging->copyTo(verticies.data(), sizeof(Vertex) * verticies.size());
-    vertexStaging->unmap();
+    if (vkCreatePipelineLayout(deviceRef.GetVkDevice(), &particlePipelineLayoutInfo, nullptr, &m_particlePipelineLayout) != VK_SUCCESS) {
+        throw std::runtime_error("Could not make particle pipeline layout");
+    }
 
-    m_vertexBuffer = std::make_unique<Buffer>(
+    m_particlePipeline = std::make_unique<ComputePipeline>(
         deviceRef,
-        sizeof(Vertex) * 4,
-        VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-        VMA_MEMORY_USAGE_AUTO,
-        true
+        reinterpret_cast<const uint8_t*>(particles_comp_spv),
+        particles_comp_spv_len,
+        m_particlePipelineLayout,
+        m_pipelineCache->getVkPipelineCache()
     );
 
-    vertexStaging->copyToBuffer(m_vertexBuffer.get(), sizeof(Vertex) * 4);
+    if (settings.recordingThreads > 1) {
+        // The calling thread records too, so it counts as one of them
+        m_parallelRecorder = std::make_unique<ParallelRecorder>(deviceRef, settings.recordingThreads - 1);
+    }
 
-    const auto indexStaging = std::make_unique<Buffer>(
-        deviceRef,
-        sizeof(uint32_t) * 6, // 6 indices for two triangles
-        VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-        VMA_MEMORY_USAGE_AUTO,
-        true
-    );
+    VkCommandPoolCreateInfo replayPoolInfo{};
+    replayPoolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    replayPoolInfo.queueFamilyIndex = deviceRef.GetGraphicsQueueFamily();
+    replayPoolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
 
-    indexStaging->map();
-    indexStaging->copyTo(indices.data(), sizeof(uint32_t) * indices.size());
-    indexStaging->unmap();
+    if (vkCreateCommandPool(deviceRef.GetVkDevice(), &replayPoolInfo, nullptr, &m_replayCommandPool) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create replay command pool!");
+    }
 
-    m_indexBuffer = std::make_unique<Buffer>(
-        deviceRef,
-        sizeof(uint32_t) * 6, // 6 indices for two triangles
-        VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-        VMA_MEMORY_USAGE_AUTO,
-        true
-    );
+    for (size_t i{0}; i < m_replayFrames.size(); i++) {
+        VkCommandBufferAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+        allocInfo.commandPool = m_replayCommandPool;
+        allocInfo.commandBufferCount = 1;
+
+        if (vkAllocateCommandBuffers(deviceRef.GetVkDevice(), &allocInfo, &m_replayFrames[i].commandBuffer) != VK_SUCCESS) {
+            throw std::runtime_error("failed to allocate replay command buffer!");
+        }
+        DebugLabel::NameCommandBuffer(m_replayFrames[i].commandBuffer, "Replay CommandBuffer: " + std::to_string(i));
+    }
+
+    m_textureDescriptorSets.resize(Swapchain::MAX_FRAMES_IN_FLIGHT);
+
+    m_dummyImage = std::make_unique<Image>(deviceRef, VkExtent2D{100, 100}, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
+
+    {
+        UploadBatch batch(deviceRef, UploadQueue::Graphics);
+        batch.transitionImage(m_dummyImage->getImage(), VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+        batch.submitAndWait();
+        m_dummyImage->SetCurrentLayout(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    }
+
+    const auto dummyInfo = m_dummyImage->descriptorInfo();
+
+    // Slot 0 is never handed out as a TextureHandle, keep it pointing at something valid
+    if (m_bindless) {
+        DescriptorWriter(*m_bindlessDescriptorSetLayout, *m_bindlessDescriptorPool)
+                .writeImage(0, 0, &dummyInfo)
+                .overwrite(m_bindlessDescriptorSet);
+    }
+
+    m_frameRing = std::make_unique<FrameRingAllocator>(deviceRef, FRAME_RING_SIZE);
+
+    m_packTextures = settings.textureAtlas;
+    if (m_packTextures) {
+        m_atlas = std::make_unique<TextureAtlas>(deviceRef, ATLAS_PAGE_SIZE, VK_FORMAT_R8G8B8A8_SRGB);
+    }
+
+    for (size_t i{0}; i < m_framesInFlight; i++) {
+        m_descriptorPool->allocateDescriptor(m_textureDescriptorSetLayout->getDescriptorSetLayout(), m_textureDescriptorSets[i]);
 
-    indexStaging->copyToBuffer(m_indexBuffer.get(), sizeof(uint32_t) * 6);
+        DescriptorWriter(*m_textureDescriptorSetLayout, *m_descriptorPool)
+                .writeImage(0, &dummyInfo)
+                .build(m_textureDescriptorSets[i]);
+    }
+
+    // Runs of only shapes bind a set too, the shaders never sample it
+    ensureTextureTables(SHAPE_TEXTURE);
+    m_textureSets[SHAPE_TEXTURE] = m_textureDescriptorSets[0];
 }
 
 womp::WompRenderer::~WompRenderer() {
-    m_vertexBuffer.reset();
-    m_indexBuffer.reset();
+    // Workers still decoding hand their result to this renderer
+    m_textureLoader.reset();
+    m_textureUploads.clear();
+    for (auto& batches: m_frameUploadBatches) {
+        batches.clear();
+    }
+    m_frameRing.reset();
+    m_parallelRecorder.reset();
+    for (auto& buffers: m_frameLayerBuffers) {
+        buffers.clear();
+    }
+    m_cullingFrames.clear();
+    for (auto& replayFrame: m_replayFrames) {
+        replayFrame.data.reset();
+        replayFrame.layerBuffers.clear();
+    }
     m_dummyImage.reset();
-    m_pipeline.reset();
+    m_loadedAtlases.clear();
+    m_atlas.reset();
+    m_cullPipeline.reset();
+    m_particlePipeline.reset();
+    m_pipelineCache->save();
+    m_pipelineCache.reset();
+    m_fonts.clear();
     m_descriptorPool.reset();
+    m_bindlessDescriptorPool.reset();
+    m_bindlessDescriptorSetLayout.reset();
     m_textureDescriptorSetLayout.reset();
-    m_screenSizeDescriptorSetLayout.reset();
-    m_screenSizeUniformBuffers.clear();
     for (auto& [handle, texture]: m_textures) {
         texture.image.reset();
     }
-    m_pendingDrawCommands.clear();
+    m_pendingDraws.clear();
 
     vkDestroyPipelineLayout(m_renderer->getDevice().GetVkDevice(), m_pipelineLayout, nullptr);
+    vkDestroyPipelineLayout(m_renderer->getDevice().GetVkDevice(), m_cullPipelineLayout, nullptr);
+    vkDestroyPipelineLayout(m_renderer->getDevice().GetVkDevice(), m_tilemapPipelineLayout, nullptr);
+    vkDestroyPipelineLayout(m_renderer->getDevice().GetVkDevice(), m_particlePipelineLayout, nullptr);
+    // Frees the replay command buffers with it
+    vkDestroyCommandPool(m_renderer->getDevice().GetVkDevice(), m_replayCommandPool, nullptr);
     this->waitIdle();
     m_renderer.reset();
 }
 
-void womp::WompRenderer::drawTexture(TextureHandle image, WP_Rect srcRect, WP_Rect dstRect, glm::vec4 color) {;
-    m_pendingDrawCommands.push_back(DrawCommand{
-        .texture = image,
-        .srcRect = srcRect,
-        .dstRect = dstRect,
-        .color = color
-    });
+void womp::WompRenderer::drawTexture(TextureHandle image, WP_Rect srcRect, WP_Rect dstRect, glm::vec4 color) {
+    drawTexture(image, srcRect, dstRect, 0.0f, color);
 }
 
 void womp::WompRenderer::drawTexture(TextureHandle image, WP_Rect srcRect, WP_Rect dstRect, float rotation, glm::vec4 color) {
-    m_pendingDrawCommands.push_back(DrawCommand{
-        .texture = image,
-        .srcRect = srcRect,
-        .dstRect = dstRect,
-        .rotation = rotation,
-        .color = color
-    });
+    // Unknown textures are dropped here so recording never has to check
+    if (image >= m_textureSizes.size() || m_textureSizes[image].x <= 0) {
+        return;
+    }
+    const auto [texture, uv] = resolveSource(image, srcRect);
+    m_drawQueue.submit(texture, uv, dstRect.toVec4(), rotation, color);
 }
 
 void womp::WompRenderer::drawTexture(TextureHandle image, glm::vec2 position, glm::vec2 size, glm::vec4 color) {
-    glm::vec2 textureSize = m_textures[image].size;
-    const WP_Rect srcRect{0, 0, textureSize.x, textureSize.y};
+    // An empty source rect samples the whole texture
+    const WP_Rect srcRect{0, 0, 0, 0};
     const WP_Rect dstRect{position.x, position.y, size.x, size.y};
-    drawTexture(image, srcRect, dstRect, color);
+    drawTexture(image, srcRect, dstRect, 0.0f, color);
+}
+
+void womp::WompRenderer::drawRect(WP_Rect dstRect, glm::vec4 color, float rotation) {
+    drawRoundedRect(dstRect, 0.0f, color, rotation);
+}
+
+void womp::WompRenderer::drawRoundedRect(WP_Rect dstRect, float radius, glm::vec4 color, float rotation) {
+    const float maxRadius = std::min(std::abs(dstRect.width), std::abs(dstRect.height));
+    const glm::vec4 shape(std::clamp(radius, 0.0f, maxRadius), 0.0f, 0.0f, 0.0f);
+    m_drawQueue.submit(SHAPE_TEXTURE, shape, dstRect.toVec4(), rotation, color);
+}
+
+void womp::WompRenderer::drawCircle(glm::vec2 center, float radius, glm::vec4 color) {
+    drawRoundedRect(WP_Rect{center.x, center.y, radius, radius}, radius, color);
+}
+
+void womp::WompRenderer::drawLine(glm::vec2 from, glm::vec2 to, float thickness, glm::vec4 color) {
+    const glm::vec2 delta = to - from;
+    const float length = glm::length(delta);
+    if (length <= 0.0f) {
+        return;
+    }
+
+    // basic.vert rotates clockwise, the quad's x axis has to end up along the line
+    const glm::vec2 center = (from + to) * 0.5f;
+    drawRoundedRect(WP_Rect{center.x, center.y, length * 0.5f, thickness * 0.5f}, 0.0f, color, -std::atan2(delta.y, delta.x));
+}
+
+std::unique_ptr<womp::SpriteLayer> womp::WompRenderer::createSpriteLayer() const {
+    return std::unique_ptr<SpriteLayer>(new SpriteLayer(*this));
+}
+
+void womp::WompRenderer::drawLayer(SpriteLayer& layer, bool overlay) {
+    (overlay ? m_overlayLayers : m_backgroundLayers).push_back(&layer);
+}
+
+std::unique_ptr<womp::Tilemap> womp::WompRenderer::createTilemap(glm::ivec2 size, TextureHandle tileset, glm::ivec2 tileSize) const {
+    return std::unique_ptr<Tilemap>(new Tilemap(*this, size, tileset, tileSize));
+}
+
+void womp::WompRenderer::drawTilemap(Tilemap& tilemap, bool overlay) {
+    (overlay ? m_overlayTilemaps : m_backgroundTilemaps).push_back(&tilemap);
+}
+
+std::unique_ptr<womp::ParticleEmitter> womp::WompRenderer::createParticleEmitter(uint32_t capacity, const ParticleEmitterSettings& settings) const {
+    return std::unique_ptr<ParticleEmitter>(new ParticleEmitter(*this, capacity, settings));
+}
+
+void womp::WompRenderer::pushClip(WP_Rect clipRect) {
+    const glm::vec2 center(clipRect.x, clipRect.y);
+    const glm::vec2 halfSize = glm::abs(glm::vec2(clipRect.width, clipRect.height));
+    m_drawQueue.pushClip(glm::vec4(center - halfSize, center + halfSize));
+}
+
+void womp::WompRenderer::drawParticles(ParticleEmitter& emitter, bool overlay) {
+    (overlay ? m_overlayEmitters : m_backgroundEmitters).push_back(&emitter);
+}
+
+void womp::WompRenderer::drawText(FontHandle font, std::string_view text, glm::vec2 position, float size, glm::vec4 color) {
+    if (font == 0 || font > m_fonts.size() || text.empty()) {
+        return;
+    }
+
+    const uint64_t key = HashBytes(text.data(), text.size(), font);
+    m_textDrawLayouts.push_back(&m_textLayouts.get(key, font, *m_fonts[font - 1].file, text));
+    m_textDraws.push_back(TextDraw{
+        .key = key,
+        .font = font,
+        .size = size,
+        .position = position,
+        .color = color,
+        .clip = m_drawQueue.getClip()
+    });
+}
+
+glm::vec2 womp::WompRenderer::measureText(FontHandle font, std::string_view text, float size) {
+    if (font == 0 || font > m_fonts.size()) {
+        return glm::vec2(0.0f);
+    }
+
+    // Through the cache, so measuring a string before drawing it shapes it once
+    const FontFile& file = *m_fonts[font - 1].file;
+    const TextLayout& layout = m_textLayouts.get(HashBytes(text.data(), text.size(), font), font, file, text);
+    return layout.size * (size / file.getSize());
 }
 
 void womp::WompRenderer::render() {
     if (const VkCommandBuffer commandBuffer = m_renderer->BeginFrame()) {
         const int frameIndex = m_renderer->getFrameIndex();
+        m_frameRing->beginFrame(frameIndex);
+
+        m_drawQueue.merge(m_pendingDraws);
+        m_frameLayerBuffers[frameIndex].clear();
+        m_frameUploadBatches[frameIndex].clear();
+
+        // Ahead of the hash, a finished texture bumps the texture generation
+        uploadDecodedTextures(frameIndex);
+
+        // The hash is only worth recording against once the same frame came in twice in a row
+        const uint64_t frameHash = m_frameReplay && !m_gpuCulling ? hashFrame() : 0;
+        const bool replay = frameHash != 0 && frameHash == m_previousFrameHash;
+        m_previousFrameHash = frameHash;
+
+        const ReplayFrame& replayFrame = m_replayFrames[frameIndex];
+        if (replay && replayFrame.recorded && replayFrame.hash == frameHash) {
+            m_frameStats = replayFrame.stats;
+            m_frameStats.replayed = true;
+        } else {
+            const uint32_t instanceCount = buildBatches();
+            const uint32_t glyphCount = buildTextBatches();
+
+            const FrameUniforms uniforms{
+                .screenSize = glm::vec2(m_renderer->getSwapchain().GetWidth(), m_renderer->getSwapchain().GetHeight()),
+                .clipRects = writeClipRects().deviceAddress
+            };
+            const FrameAllocation frameUniforms = m_frameRing->push(uniforms);
+
+            for (SpriteLayer* layer: m_backgroundLayers) {
+                prepareLayer(commandBuffer, frameIndex, *layer);
+            }
+            for (SpriteLayer* layer: m_overlayLayers) {
+                prepareLayer(commandBuffer, frameIndex, *layer);
+            }
+            for (Tilemap* tilemap: m_backgroundTilemaps) {
+                prepareTilemap(commandBuffer, frameIndex, *tilemap);
+            }
+            for (Tilemap* tilemap: m_overlayTilemaps) {
+                prepareTilemap(commandBuffer, frameIndex, *tilemap);
+            }
+            for (ParticleEmitter* emitter: m_backgroundEmitters) {
+                simulateParticles(commandBuffer, frameIndex, *emitter);
+            }
+            for (ParticleEmitter* emitter: m_overlayEmitters) {
+                simulateParticles(commandBuffer, frameIndex, *emitter);
+            }
+
+            const bool culling = m_gpuCulling && instanceCount > 0;
+            if (culling) {
+                recordCulling(commandBuffer, frameIndex, instanceCount);
+            }
+
+            const bool pretransformed = m_cpuTransform && !culling && instanceCount > 0;
+            const FrameAllocation quads = pretransformed ? transformQuads(instanceCount) : FrameAllocation{};
+
+            const SpritePushConstants push{
+                .instances = culling ? m_cullingFrames[frameIndex].visibleInstances->getDeviceAddress() : m_instanceAllocation.deviceAddress,
+                .frame = frameUniforms.deviceAddress,
+                .quads = quads.deviceAddress
+            };
 
-        auto& screenSizeBuffer = m_screenSizeUniformBuffers[frameIndex];
-        glm::vec2 screenSize{ m_renderer->getSwapchain().GetWidth(), m_renderer->getSwapchain().GetHeight() };
-        screenSizeBuffer->copyTo(&screenSize, sizeof(screenSize));
-        screenSizeBuffer->flush();
+            const uint32_t jobCount = m_parallelRecorder
+                ? std::min(m_parallelRecorder->getThreadCount(), instanceCount / MIN_INSTANCES_PER_RECORDING_JOB)
+                : 1;
+
+            if (replay) {
+                recordReplay(commandBuffer, frameIndex, frameHash, uniforms, instanceCount, quads, glyphCount);
+            } else if (jobCount > 1) {
+                m_renderer->beginSwapChainRenderPass(commandBuffer, VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT);
+                DebugLabel::BeginCmdLabel(commandBuffer, "Draw Textures", glm::vec4(0.1f, 0.8f, 0.2f, 1));
+
+                const VkCommandBufferInheritanceRenderingInfo renderingInfo = getInheritanceRenderingInfo();
+
+                // Each job records a contiguous slice of the instances, executed in job order
+                const auto& secondaries = m_parallelRecorder->record(frameIndex, jobCount, renderingInfo, [&](VkCommandBuffer secondary, uint32_t job) {
+                    m_renderer->setViewportAndScissor(secondary);
+                    if (job == 0) {
+                        recordTilemaps(secondary, m_backgroundTilemaps, push.frame);
+                        recordLayers(secondary, m_backgroundLayers, push.frame);
+                        recordParticles(secondary, m_backgroundEmitters, push.frame);
+                    }
+                    recordSprites(secondary, instanceCount * job / jobCount, instanceCount * (job + 1) / jobCount, culling, push);
+                    if (job == jobCount - 1) {
+                        recordLayers(secondary, m_overlayLayers, push.frame);
+                        recordParticles(secondary, m_overlayEmitters, push.frame);
+                        recordTilemaps(secondary, m_overlayTilemaps, push.frame);
+                        recordText(secondary, m_glyphAllocation.deviceAddress, push.frame);
+                    }
+                });
+                vkCmdExecuteCommands(commandBuffer, static_cast<uint32_t>(secondaries.size()), secondaries.data());
+            } else {
+                m_renderer->beginSwapChainRenderPass(commandBuffer);
+                DebugLabel::BeginCmdLabel(commandBuffer, "Draw Textures", glm::vec4(0.1f, 0.8f, 0.2f, 1));
+
+                recordTilemaps(commandBuffer, m_backgroundTilemaps, push.frame);
+                recordLayers(commandBuffer, m_backgroundLayers, push.frame);
+                recordParticles(commandBuffer, m_backgroundEmitters, push.frame);
+                recordSprites(commandBuffer, 0, instanceCount, culling, push);
+                recordLayers(commandBuffer, m_overlayLayers, push.frame);
+                recordParticles(commandBuffer, m_overlayEmitters, push.frame);
+                recordTilemaps(commandBuffer, m_overlayTilemaps, push.frame);
+                recordText(commandBuffer, m_glyphAllocation.deviceAddress, push.frame);
+            }
+        }
+
+        if (replay) {
+            m_renderer->beginSwapChainRenderPass(commandBuffer, VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT);
+            DebugLabel::BeginCmdLabel(commandBuffer, "Replay Textures", glm::vec4(0.1f, 0.8f, 0.2f, 1));
+            vkCmdExecuteCommands(commandBuffer, 1, &replayFrame.commandBuffer);
+        }
+
+        DebugLabel::EndCmdLabel(commandBuffer);
+        m_renderer->endSwapChainRenderPass(commandBuffer);
+        m_renderer->endFrame();
+        m_frameRing->endFrame();
+
+        // Clear draw queue AFTER render is finished
+        m_pendingDraws.clear();
+    }
+
+    m_backgroundLayers.clear();
+    m_overlayLayers.clear();
+    m_backgroundTilemaps.clear();
+    m_overlayTilemaps.clear();
+    m_backgroundEmitters.clear();
+    m_overlayEmitters.clear();
+    m_textDraws.clear();
+    m_textDrawLayouts.clear();
+    m_textLayouts.endFrame();
+}
+
+std::pair<womp::TextureHandle, glm::vec4> womp::WompRenderer::resolveSource(TextureHandle texture, const WP_Rect& srcRect) const {
+    if (texture >= m_textureRegions.size()) {
+        return {texture, NormalizeSourceRect(srcRect, glm::vec2(0.0f))};
+    }
+    const TextureRegion& region = m_textureRegions[texture];
+    return {region.texture, ApplyTextureRegion(NormalizeSourceRect(srcRect, m_textureSizes[texture]), region)};
+}
+
+uint32_t womp::WompRenderer::getTextureSlot(TextureHandle texture) const {
+    return texture < m_textureSlots.size() ? m_textureSlots[texture] : SHAPE_TEXTURE;
+}
+
+uint32_t womp::WompRenderer::buildBatches() {
+    m_frameStats = {};
+    m_instanceAllocation = m_frameRing->allocateArray<SpriteInstance>(std::max<size_t>(m_pendingDraws.size(), 1));
+
+    // Binds only happen when the pipeline or, without bindless, the texture changes
+    const auto stateOf = [this](uint32_t draw) {
+        const uint64_t pipeline = static_cast<uint64_t>(m_pendingDraws.blendModes[draw]) << 32;
+        return m_bindless ? pipeline : pipeline | m_pendingDraws.textures[draw];
+    };
+
+    if (m_sortedSubmission) {
+        const auto drawCount = static_cast<uint32_t>(m_pendingDraws.size());
+        m_sortItems.resize(drawCount);
+        GroupDraws(m_pendingDraws, m_bindless, m_drawGroups, m_drawGroupScratch);
+
+        uint64_t previousState = ~0ull;
+        uint32_t unsortedStateChanges = 0;
+        for (uint32_t i = 0; i < drawCount; ++i) {
+            unsortedStateChanges += stateOf(i) != previousState;
+            previousState = stateOf(i);
+
+            m_sortItems[i] = SortItem{MakeSortKey(m_pendingDraws.layers[i], m_drawGroups[i], i), i};
+        }
+
+        RadixSort(m_sortItems, m_sortScratch);
+
+        previousState = ~0ull;
+        uint32_t sortedStateChanges = 0;
+        for (const auto& item: m_sortItems) {
+            sortedStateChanges += stateOf(item.index) != previousState;
+            previousState = stateOf(item.index);
+        }
+        m_frameStats.stateChangesRemoved = static_cast<int32_t>(unsortedStateChanges) - static_cast<int32_t>(sortedStateChanges);
+    }
+
+    const uint32_t instanceCount = WriteSpriteInstances(
+        m_pendingDraws,
+        m_sortedSubmission ? &m_sortItems : nullptr,
+        m_textureSets,
+        m_textureSlots,
+        m_bindless ? m_bindlessDescriptorSet : VK_NULL_HANDLE,
+        static_cast<SpriteInstance*>(m_instanceAllocation.data),
+        m_batches
+    );
 
+    m_frameStats.sprites = instanceCount;
+    m_frameStats.drawCalls = static_cast<uint32_t>(m_batches.size());
+    m_frameStats.stateChanges = static_cast<uint32_t>(m_batches.size());
 
-        m_renderer->beginSwapChainRenderPass(commandBuffer);
-        DebugLabel::BeginCmdLabel(commandBuffer, "Draw Textures", glm::vec4(0.1f, 0.8f, 0.2f, 1));
+    return instanceCount;
+}
 
-        m_pipeline->bind(commandBuffer);
-        const VkBuffer vertexBuffers[] = {m_vertexBuffer->getBuffer()};
-        constexpr VkDeviceSize offsets[] = {0};
-        vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
-        vkCmdBindIndexBuffer(commandBuffer, m_indexBuffer->getBuffer(), 0, VK_INDEX_TYPE_UINT32);
+womp::FrameAllocation womp::WompRenderer::transformQuads(uint32_t instanceCount) {
+    const FrameAllocation quads = m_frameRing->allocateArray<WP_Quad>(instanceCount);
+    const glm::vec2 screenSize(m_renderer->getSwapchain().GetWidth(), m_renderer->getSwapchain().GetHeight());
+
+    // Quads have to line up with the instances, which are in sort order when sorting
+    const glm::vec4* rects = m_pendingDraws.dstRects.data();
+    const float* rotations = m_pendingDraws.rotations.data();
+    if (m_sortedSubmission) {
+        m_sortedRects.resize(instanceCount);
+        m_sortedRotations.resize(instanceCount);
+        for (uint32_t i = 0; i < instanceCount; ++i) {
+            const uint32_t draw = m_sortItems[i].index;
+            m_sortedRects[i] = m_pendingDraws.dstRects[draw];
+            m_sortedRotations[i] = m_pendingDraws.rotations[draw];
+        }
+        rects = m_sortedRects.data();
+        rotations = m_sortedRotations.data();
+    }
 
+    WP_TransformQuads(rects, rotations, instanceCount, screenSize, static_cast<WP_Quad*>(quads.data));
+    return quads;
+}
 
-        vkCmdBindDescriptorSets(
-            commandBuffer,
-            VK_PIPELINE_BIND_POINT_GRAPHICS,
-            m_pipelineLayout,
-            0,
-            1,
-            &m_screenSizeDescriptorSets[frameIndex],
-            0,
-            nullptr
+const womp::Pipeline& womp::WompRenderer::getSpritePipeline(BlendMode blendMode, bool pretransformed) const {
+    PipelineKey key = pretransformed ? m_pretransformedPipelineKey : m_spritePipelineKey;
+    key.blendMode = blendMode;
+    return m_pipelineCache->get(key);
+}
+
+void womp::WompRenderer::recordSprites(VkCommandBuffer commandBuffer, uint32_t firstInstance, uint32_t endInstance, bool culling, const SpritePushConstants& push) const {
+    vkCmdPushConstants(commandBuffer, m_pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(SpritePushConstants), &push);
+
+    // Without culling the range may cut through a batch. Indirect draws can't be split, so a batch
+    // belongs to the range holding its first instance.
+    auto firstBatch = std::upper_bound(m_batches.begin(), m_batches.end(), firstInstance, [](uint32_t instance, const SpriteBatch& batch) {
+        return instance < batch.firstInstance;
+    });
+    if (!culling && firstBatch != m_batches.begin() && std::prev(firstBatch)->firstInstance + std::prev(firstBatch)->instanceCount > firstInstance) {
+        --firstBatch;
+    } else if (culling && firstBatch != m_batches.begin() && std::prev(firstBatch)->firstInstance == firstInstance) {
+        --firstBatch;
+    }
+
+    // One instanced draw per run of sprites sharing a texture and blend mode, a single draw when bindless and unblended
+    const Pipeline* boundPipeline = nullptr;
+    BlendMode boundBlendMode{};
+    VkDescriptorSet boundSet = VK_NULL_HANDLE;
+    for (auto i = static_cast<uint32_t>(firstBatch - m_batches.begin()); i < m_batches.size() && m_batches[i].firstInstance < endInstance;) {
+        const auto& batch = m_batches[i];
+        if (!boundPipeline || batch.blendMode != boundBlendMode) {
+            // Descriptor sets and push constants stay bound across pipelines sharing the layout
+            boundPipeline = &getSpritePipeline(batch.blendMode, push.quads != 0);
+            boundPipeline->bind(commandBuffer);
+            boundBlendMode = batch.blendMode;
+        }
+        if (batch.descriptorSet != boundSet) {
+            vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelineLayout, 0, 1, &batch.descriptorSet, 0, nullptr);
+            boundSet = batch.descriptorSet;
+        }
+
+        if (!culling) {
+            const uint32_t first = std::max(batch.firstInstance, firstInstance);
+            const uint32_t end = std::min(batch.firstInstance + batch.instanceCount, endInstance);
+            vkCmdDraw(commandBuffer, 6, end - first, 0, first);
+            ++i;
+            continue;
+        }
+
+        // Batches sharing a descriptor set and blend mode go out as one indirect draw
+        uint32_t runEnd = i + 1;
+        while (runEnd < m_batches.size() && m_batches[runEnd].descriptorSet == boundSet && m_batches[runEnd].blendMode == boundBlendMode &&
+               m_batches[runEnd].firstInstance < endInstance) {
+            ++runEnd;
+        }
+        recordIndirectDraws(commandBuffer, i, runEnd - i);
+        i = runEnd;
+    }
+}
+
+void womp::WompRenderer::prepareLayer(VkCommandBuffer commandBuffer, int frameIndex, SpriteLayer& layer) {
+    if (layer.m_instances.empty()) {
+        return;
+    }
+
+    const auto spriteCount = static_cast<uint32_t>(layer.m_instances.size());
+    if (!layer.m_buffer || layer.m_buffer->GetSize() < spriteCount * sizeof(SpriteInstance)) {
+        size_t capacity = layer.m_buffer ? layer.m_buffer->GetSize() / sizeof(SpriteInstance) : INITIAL_INSTANCE_CAPACITY;
+        while (capacity < spriteCount) {
+            capacity *= 2;
+        }
+
+        // Frames still reading the old buffer keep it alive through m_frameLayerBuffers
+        layer.m_buffer = std::make_shared<Buffer>(
+            *m_device,
+            capacity * sizeof(SpriteInstance),
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+            VMA_MEMORY_USAGE_GPU_ONLY
         );
+        DebugLabel::NameBuffer(layer.m_buffer->getBuffer(), "Sprite Layer Instances");
+
+        layer.m_dirtyRanges.assign(1, {0, spriteCount});
+    }
+
+    auto& ranges = layer.m_dirtyRanges;
+    uint32_t dirtyCount = 0;
+    if (!ranges.empty()) {
+        std::sort(ranges.begin(), ranges.end());
 
-        // Draw all pending draw commands
-        for (const auto& cmd: m_pendingDrawCommands) {
-            // if (cmd.texture == static_cast<uint32_t>(-1)) {
-            //     // Draw a rectangle with color
-            //     PushConstants push = {
-            //         .dstRect = cmd.dstRect,
-            //         .rotation = 0.0f,
-            //         .srcRect = glm::vec4(0, 0, 0, 0), // No texture source rect
-            //     };
-            //
-            //     vkCmdPushConstants(commandBuffer, m_pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(PushConstants), &push);
-            //
-            //
-            //     continue;
-            // }
-
-
-            auto it = m_textures.find(cmd.texture);
-            if (it == m_textures.end()) continue;
-
-            const Texture& tex = it->second;
-
-            glm::vec4 srcUV = cmd.srcRect.toVec4();
-            if (srcUV.z > 0 && srcUV.w > 0) {
-                srcUV.x /= tex.size.x;
-                srcUV.y /= tex.size.y;
-                srcUV.z /= tex.size.x;
-                srcUV.w /= tex.size.y;
+        // Coalesce ranges that touch or overlap into as few copies as possible
+        size_t merged = 0;
+        for (size_t i = 1; i < ranges.size(); ++i) {
+            if (ranges[i].first <= ranges[merged].second) {
+                ranges[merged].second = std::max(ranges[merged].second, ranges[i].second);
             } else {
-                srcUV = glm::vec4(0, 0, 1, 1);
+                ranges[++merged] = ranges[i];
+            }
+        }
+        ranges.resize(merged + 1);
+
+        for (auto& [first, end]: ranges) {
+            end = std::min(end, spriteCount);
+            dirtyCount += end > first ? end - first : 0;
+        }
+    }
+
+    if (dirtyCount > 0) {
+        const FrameAllocation staging = m_frameRing->allocateArray<SpriteInstance>(dirtyCount);
+        auto* stagingInstances = static_cast<SpriteInstance*>(staging.data);
+
+        std::vector<VkBufferCopy> regions;
+        regions.reserve(ranges.size());
+        VkDeviceSize stagingOffset = 0;
+        for (const auto& [first, end]: ranges) {
+            if (end <= first) continue;
+
+            const uint32_t count = end - first;
+            std::copy_n(layer.m_instances.begin() + first, count, stagingInstances + stagingOffset);
+            regions.push_back(VkBufferCopy{
+                .srcOffset = staging.offset + stagingOffset * sizeof(SpriteInstance),
+                .dstOffset = first * sizeof(SpriteInstance),
+                .size = count * sizeof(SpriteInstance)
+            });
+            stagingOffset += count;
+        }
+
+        // Earlier frames may still be reading the ranges that are about to be overwritten
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_VERTEX_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 0, nullptr);
+
+        vkCmdCopyBuffer(commandBuffer, staging.buffer, layer.m_buffer->getBuffer(), static_cast<uint32_t>(regions.size()), regions.data());
+
+        VkMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_VERTEX_SHADER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+    }
+    ranges.clear();
+
+    if (layer.m_batchesDirty) {
+        rebuildLayerBatches(layer);
+        layer.m_batchesDirty = false;
+    }
+
+    m_frameLayerBuffers[frameIndex].push_back(layer.m_buffer);
+
+    m_frameStats.sprites += spriteCount;
+    m_frameStats.drawCalls += static_cast<uint32_t>(layer.m_batches.size());
+}
+
+void womp::WompRenderer::rebuildLayerBatches(SpriteLayer& layer) const {
+    layer.m_batches.clear();
+
+    bool inBatch = false;
+    for (uint32_t i = 0; i < layer.m_instances.size(); ++i) {
+        // Sprites with a texture that doesn't exist are left out of every batch
+        const uint32_t slot = layer.m_instances[i].textureIndex;
+        if (slot == SHAPE_TEXTURE) {
+            inBatch = false;
+            continue;
+        }
+
+        // Without bindless the slot is the handle
+        const VkDescriptorSet set = m_bindless ? m_bindlessDescriptorSet : m_textureSets[slot];
+        if (!inBatch || layer.m_batches.back().descriptorSet != set) {
+            layer.m_batches.push_back(SpriteBatch{
+                .descriptorSet = set,
+                .firstInstance = i,
+                .instanceCount = 0
+            });
+            inBatch = true;
+        }
+        layer.m_batches.back().instanceCount++;
+    }
+}
+
+void womp::WompRenderer::recordLayers(VkCommandBuffer commandBuffer, const std::vector<SpriteLayer*>& layers, VkDeviceAddress frameUniforms) const {
+    bool pipelineBound = false;
+    VkDescriptorSet boundSet = VK_NULL_HANDLE;
+
+    for (const SpriteLayer* layer: layers) {
+        if (layer->m_batches.empty()) continue;
+
+        if (!pipelineBound) {
+            getSpritePipeline(BlendMode::Alpha, false).bind(commandBuffer);
+            pipelineBound = true;
+        }
+
+        const SpritePushConstants push{
+            .instances = layer->m_buffer->getDeviceAddress(),
+            .frame = frameUniforms,
+            .quads = 0
+        };
+        vkCmdPushConstants(commandBuffer, m_pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(SpritePushConstants), &push);
+
+        for (const auto& batch: layer->m_batches) {
+            if (batch.descriptorSet != boundSet) {
+                vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelineLayout, 0, 1, &batch.descriptorSet, 0, nullptr);
+                boundSet = batch.descriptorSet;
+            }
+            vkCmdDraw(commandBuffer, 6, batch.instanceCount, 0, batch.firstInstance);
+        }
+    }
+}
+
+uint64_t womp::WompRenderer::hashFrame() const {
+    // Textures never change once they have a handle, so a generation bump covers every new one
+    const Swapchain& swapchain = m_renderer->getSwapchain();
+    const std::array<uint64_t, 4> state{
+        static_cast<uint64_t>(swapchain.GetWidth()) << 32 | swapchain.GetHeight(),
+        m_textureGeneration,
+        static_cast<uint64_t>(m_sortedSubmission) | static_cast<uint64_t>(m_cpuTransform) << 1,
+        m_pendingDraws.size()
+    };
+    uint64_t hash = HashValue(state, 0);
+
+    hash = HashValues(m_pendingDraws.textures, hash);
+    hash = HashValues(m_pendingDraws.layers, hash);
+    hash = HashValues(m_pendingDraws.blendModes, hash);
+    hash = HashValues(m_pendingDraws.srcRects, hash);
+    hash = HashValues(m_pendingDraws.dstRects, hash);
+    hash = HashValues(m_pendingDraws.colors, hash);
+    hash = HashValues(m_pendingDraws.rotations, hash);
+    hash = HashValues(m_pendingDraws.clips, hash);
+    hash = HashValues(m_pendingDraws.clipRects, hash);
+
+    // Layers, tilemaps and emitters are hashed by their m_revision alone. Each edit replaces it with a new
+    // NextRevision value, and no other object ever gets the same value, even one that lived at the same address.
+    for (const auto* layers: {&m_backgroundLayers, &m_overlayLayers}) {
+        hash = HashValue(layers->size(), hash);
+        for (const SpriteLayer* layer: *layers) {
+            hash = HashValue(layer->m_revision, hash);
+        }
+    }
+    for (const auto* tilemaps: {&m_backgroundTilemaps, &m_overlayTilemaps}) {
+        hash = HashValue(tilemaps->size(), hash);
+        for (const Tilemap* tilemap: *tilemaps) {
+            hash = HashValue(tilemap->m_revision, hash);
+        }
+    }
+    // An emitter that wasn't updated isn't simulated, so it draws the same particles again
+    for (const auto* emitters: {&m_backgroundEmitters, &m_overlayEmitters}) {
+        hash = HashValue(emitters->size(), hash);
+        for (const ParticleEmitter* emitter: *emitters) {
+            hash = HashValue(emitter->m_revision, hash);
+        }
+    }
+    // The key stands in for the text, which only the layout cache keeps
+    hash = HashValues(m_textDraws, hash);
+
+    return hash;
+}
+
+void womp::WompRenderer::recordReplay(VkCommandBuffer commandBuffer, int frameIndex, uint64_t hash, const FrameUniforms& frameUniforms, uint32_t instanceCount, const FrameAllocation& quads, uint32_t glyphCount) {
+    ReplayFrame& replayFrame = m_replayFrames[frameIndex];
+
+    // Everything the commands read is copied out of the ring, which is reused by the next frames
+    const VkDeviceSize instancesSize = instanceCount * sizeof(SpriteInstance);
+    const VkDeviceSize instancesOffset = REPLAY_DATA_ALIGNMENT;
+    const VkDeviceSize quadsOffset = (instancesOffset + instancesSize + REPLAY_DATA_ALIGNMENT - 1) / REPLAY_DATA_ALIGNMENT * REPLAY_DATA_ALIGNMENT;
+    const VkDeviceSize glyphsSize = glyphCount * sizeof(GlyphInstance);
+    const VkDeviceSize glyphsOffset = (quadsOffset + quads.size + REPLAY_DATA_ALIGNMENT - 1) / REPLAY_DATA_ALIGNMENT * REPLAY_DATA_ALIGNMENT;
+    const VkDeviceSize clipRectsOffset = (glyphsOffset + glyphsSize + REPLAY_DATA_ALIGNMENT - 1) / REPLAY_DATA_ALIGNMENT * REPLAY_DATA_ALIGNMENT;
+    const VkDeviceSize dataSize = clipRectsOffset + m_clipAllocation.size;
+
+    // The frame's fence has been waited on, so neither the old buffer nor the commands are in use
+    if (!replayFrame.data || replayFrame.data->GetSize() < dataSize) {
+        const VkDeviceSize capacity = std::max(dataSize, replayFrame.data ? replayFrame.data->GetSize() * 2 : 0);
+        replayFrame.data = std::make_unique<Buffer>(
+            *m_device,
+            capacity,
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+            VMA_MEMORY_USAGE_GPU_ONLY
+        );
+        DebugLabel::NameBuffer(replayFrame.data->getBuffer(), "Replay Frame Data: " + std::to_string(frameIndex));
+    }
+
+    // The ring may have grown between allocations, so each one is copied from its own buffer
+    const VkBuffer data = replayFrame.data->getBuffer();
+    const VkDeviceAddress address = replayFrame.data->getDeviceAddress();
+
+    // The uniforms point at the clip rects, so they are written pointing at the copy
+    FrameUniforms replayUniforms = frameUniforms;
+    replayUniforms.clipRects = address + clipRectsOffset;
+    vkCmdUpdateBuffer(commandBuffer, data, 0, sizeof(FrameUniforms), &replayUniforms);
+    const VkBufferCopy clipRectsCopy{m_clipAllocation.offset, clipRectsOffset, m_clipAllocation.size};
+    vkCmdCopyBuffer(commandBuffer, m_clipAllocation.buffer, data, 1, &clipRectsCopy);
+    if (instancesSize > 0) {
+        const VkBufferCopy instancesCopy{m_instanceAllocation.offset, instancesOffset, instancesSize};
+        vkCmdCopyBuffer(commandBuffer, m_instanceAllocation.buffer, data, 1, &instancesCopy);
+    }
+    if (quads.size > 0) {
+        const VkBufferCopy quadsCopy{quads.offset, quadsOffset, quads.size};
+        vkCmdCopyBuffer(commandBuffer, quads.buffer, data, 1, &quadsCopy);
+    }
+    if (glyphsSize > 0) {
+        const VkBufferCopy glyphsCopy{m_glyphAllocation.offset, glyphsOffset, glyphsSize};
+        vkCmdCopyBuffer(commandBuffer, m_glyphAllocation.buffer, data, 1, &glyphsCopy);
+    }
+
+    VkMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_VERTEX_SHADER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+    const SpritePushConstants push{
+        .instances = address + instancesOffset,
+        .frame = address,
+        .quads = quads.size > 0 ? address + quadsOffset : 0
+    };
+
+    const VkCommandBufferInheritanceRenderingInfo renderingInfo = getInheritanceRenderingInfo();
+
+    VkCommandBufferInheritanceInfo inheritanceInfo{};
+    inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+    inheritanceInfo.pNext = &renderingInfo;
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+    beginInfo.pInheritanceInfo = &inheritanceInfo;
+
+    if (vkBeginCommandBuffer(replayFrame.commandBuffer, &beginInfo) != VK_SUCCESS) {
+        throw std::runtime_error("failed to begin recording replay command buffer!");
+    }
+
+    m_renderer->setViewportAndScissor(replayFrame.commandBuffer);
+    recordTilemaps(replayFrame.commandBuffer, m_backgroundTilemaps, push.frame);
+    recordLayers(replayFrame.commandBuffer, m_backgroundLayers, push.frame);
+    recordParticles(replayFrame.commandBuffer, m_backgroundEmitters, push.frame);
+    recordSprites(replayFrame.commandBuffer, 0, instanceCount, false, push);
+    recordLayers(replayFrame.commandBuffer, m_overlayLayers, push.frame);
+    recordParticles(replayFrame.commandBuffer, m_overlayEmitters, push.frame);
+    recordTilemaps(replayFrame.commandBuffer, m_overlayTilemaps, push.frame);
+    recordText(replayFrame.commandBuffer, address + glyphsOffset, push.frame);
+
+    if (vkEndCommandBuffer(replayFrame.commandBuffer) != VK_SUCCESS) {
+        throw std::runtime_error("failed to record replay command buffer!");
+    }
+
+    // The layer buffers are drawn by every replay, not just this frame
+    replayFrame.layerBuffers = m_frameLayerBuffers[frameIndex];
+    replayFrame.stats = m_frameStats;
+    replayFrame.hash = hash;
+    replayFrame.recorded = true;
+}
+
+VkCommandBufferInheritanceRenderingInfo womp::WompRenderer::getInheritanceRenderingInfo() const {
+    VkCommandBufferInheritanceRenderingInfo renderingInfo{};
+    renderingInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO;
+    renderingInfo.colorAttachmentCount = 1;
+    renderingInfo.pColorAttachmentFormats = &m_colorFormat;
+    renderingInfo.depthAttachmentFormat = m_renderer->getSwapchain().GetDepthFormat();
+    renderingInfo.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+    return renderingInfo;
+}
+
+void womp::WompRenderer::prepareTilemap(VkCommandBuffer commandBuffer, int frameIndex, Tilemap& tilemap) {
+    if (tilemap.m_tileUVs.empty()) {
+        return;
+    }
+
+    if (!tilemap.m_buffer) {
+        tilemap.m_buffer = std::make_shared<Buffer>(
+            *m_device,
+            tilemap.m_tiles.size() * sizeof(uint32_t),
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+            VMA_MEMORY_USAGE_GPU_ONLY
+        );
+        DebugLabel::NameBuffer(tilemap.m_buffer->getBuffer(), "Tilemap Chunks");
+
+        tilemap.m_tileUVBuffer = std::make_shared<Buffer>(
+            *m_device,
+            tilemap.m_tileUVs.size() * sizeof(glm::vec4),
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+            VMA_MEMORY_USAGE_GPU_ONLY
+        );
+        DebugLabel::NameBuffer(tilemap.m_tileUVBuffer->getBuffer(), "Tileset UVs");
+
+        // Nothing reads the new buffer yet, so the tileset goes up without a barrier in front
+        const FrameAllocation staging = m_frameRing->allocateArray<glm::vec4>(tilemap.m_tileUVs.size());
+        std::copy(tilemap.m_tileUVs.begin(), tilemap.m_tileUVs.end(), static_cast<glm::vec4*>(staging.data));
+        const VkBufferCopy region{staging.offset, 0, tilemap.m_tileUVs.size() * sizeof(glm::vec4)};
+        vkCmdCopyBuffer(commandBuffer, staging.buffer, tilemap.m_tileUVBuffer->getBuffer(), 1, &region);
+
+        tilemap.m_allDirty = true;
+    }
+
+    if (tilemap.m_allDirty) {
+        tilemap.m_dirtyRanges.assign(tilemap.m_dirtyRanges.size(), {0, Tilemap::CHUNK_TILES});
+        tilemap.m_allDirty = false;
+    }
+
+    uint32_t dirtyCount = 0;
+    for (const auto& [first, end]: tilemap.m_dirtyRanges) {
+        dirtyCount += end > first ? end - first : 0;
+    }
+
+    if (dirtyCount > 0) {
+        const FrameAllocation staging = m_frameRing->allocateArray<uint32_t>(dirtyCount);
+        auto* stagingTiles = static_cast<uint32_t*>(staging.data);
+
+        std::vector<VkBufferCopy> regions;
+        // One copy per edited chunk, covering the tiles between its first and last edit
+        VkDeviceSize stagingOffset = 0;
+        for (uint32_t chunk = 0; chunk < tilemap.m_dirtyRanges.size(); ++chunk) {
+            const auto [first, end] = tilemap.m_dirtyRanges[chunk];
+            if (end <= first) continue;
+
+            const uint32_t count = end - first;
+            const uint32_t tileOffset = chunk * Tilemap::CHUNK_TILES + first;
+            std::copy_n(tilemap.m_tiles.begin() + tileOffset, count, stagingTiles + stagingOffset);
+            regions.push_back(VkBufferCopy{
+                .srcOffset = staging.offset + stagingOffset * sizeof(uint32_t),
+                .dstOffset = tileOffset * sizeof(uint32_t),
+                .size = count * sizeof(uint32_t)
+            });
+            stagingOffset += count;
+        }
+        tilemap.m_dirtyRanges.assign(tilemap.m_dirtyRanges.size(), {Tilemap::CHUNK_TILES, 0});
+
+        // Earlier frames may still be reading the chunks that are about to be overwritten
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_VERTEX_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 0, nullptr);
+
+        vkCmdCopyBuffer(commandBuffer, staging.buffer, tilemap.m_buffer->getBuffer(), static_cast<uint32_t>(regions.size()), regions.data());
+
+        // Also covers the tileset upload, a new tilemap always has every chunk dirty
+        VkMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_VERTEX_SHADER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+    }
+
+    m_frameLayerBuffers[frameIndex].push_back(tilemap.m_buffer);
+    m_frameLayerBuffers[frameIndex].push_back(tilemap.m_tileUVBuffer);
+
+    const auto [firstChunk, lastChunk] = tilemap.getVisibleChunks(glm::vec2(m_renderer->getSwapchain().GetWidth(), m_renderer->getSwapchain().GetHeight()));
+    if (firstChunk.x <= lastChunk.x && firstChunk.y <= lastChunk.y) {
+        m_frameStats.drawCalls += static_cast<uint32_t>((lastChunk.x - firstChunk.x + 1) * (lastChunk.y - firstChunk.y + 1));
+    }
+}
+
+void womp::WompRenderer::recordTilemaps(VkCommandBuffer commandBuffer, const std::vector<Tilemap*>& tilemaps, VkDeviceAddress frameUniforms) const {
+    const glm::vec2 screenSize(m_renderer->getSwapchain().GetWidth(), m_renderer->getSwapchain().GetHeight());
+
+    bool pipelineBound = false;
+    VkDescriptorSet boundSet = VK_NULL_HANDLE;
+
+    for (const Tilemap* tilemap: tilemaps) {
+        if (!tilemap->m_buffer) continue;
+
+        // Chunks outside the screen are never drawn, the rest are one instance per tile
+        const auto [firstChunk, lastChunk] = tilemap->getVisibleChunks(screenSize);
+        if (firstChunk.x > lastChunk.x || firstChunk.y > lastChunk.y) continue;
+
+        if (!pipelineBound) {
+            m_tilemapPipeline->bind(commandBuffer);
+            pipelineBound = true;
+        }
+
+        const VkDescriptorSet set = m_bindless ? m_bindlessDescriptorSet : m_textureSets[tilemap->m_texture];
+        if (set != boundSet) {
+            vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_tilemapPipelineLayout, 0, 1, &set, 0, nullptr);
+            boundSet = set;
+        }
+
+        TilemapPushConstants push{
+            .chunk = 0,
+            .tileset = tilemap->m_tileUVBuffer->getDeviceAddress(),
+            .frame = frameUniforms,
+            .origin = glm::vec2(0.0f),
+            .color = tilemap->m_color,
+            .tileSize = tilemap->m_tileSize,
+            .textureIndex = getTextureSlot(tilemap->m_texture)
+        };
+        const glm::vec2 chunkPixels = tilemap->m_tileSize * static_cast<float>(Tilemap::CHUNK_SIZE);
+
+        for (int y = firstChunk.y; y <= lastChunk.y; ++y) {
+            for (int x = firstChunk.x; x <= lastChunk.x; ++x) {
+                const auto chunk = static_cast<VkDeviceAddress>(y * tilemap->m_chunkCount.x + x);
+                push.chunk = tilemap->m_buffer->getDeviceAddress() + chunk * Tilemap::CHUNK_TILES * sizeof(uint32_t);
+                push.origin = tilemap->m_position + glm::vec2(static_cast<float>(x), static_cast<float>(y)) * chunkPixels;
+
+                vkCmdPushConstants(commandBuffer, m_tilemapPipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(TilemapPushConstants), &push);
+                vkCmdDraw(commandBuffer, 6, Tilemap::CHUNK_TILES, 0, 0);
             }
+        }
+    }
+}
+
+void womp::WompRenderer::simulateParticles(VkCommandBuffer commandBuffer, int frameIndex, ParticleEmitter& emitter) {
+    const bool created = !emitter.m_draws;
+    if (created) {
+        constexpr VkBufferUsageFlags usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
+        for (auto& particles: emitter.m_particles) {
+            particles = std::make_shared<Buffer>(*m_device, emitter.m_capacity * PARTICLE_STRIDE, usage, VMA_MEMORY_USAGE_GPU_ONLY);
+            DebugLabel::NameBuffer(particles->getBuffer(), "Particles");
+        }
+        emitter.m_instances = std::make_shared<Buffer>(*m_device, emitter.m_capacity * sizeof(SpriteInstance), usage, VMA_MEMORY_USAGE_GPU_ONLY);
+        DebugLabel::NameBuffer(emitter.m_instances->getBuffer(), "Particle Instances");
+        emitter.m_draws = std::make_shared<Buffer>(
+            *m_device,
+            2 * sizeof(VkDrawIndirectCommand),
+            usage | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VMA_MEMORY_USAGE_GPU_ONLY
+        );
+        DebugLabel::NameBuffer(emitter.m_draws->getBuffer(), "Particle Draws");
 
-            PushConstants push = {
-                .srcRect = srcUV,
-                .dstRect = cmd.dstRect.toVec4(),
-                .rotation = cmd.rotation,
-                .color = cmd.color
+        const std::array<VkDrawIndirectCommand, 2> emptyDraws{VkDrawIndirectCommand{6, 0, 0, 0}, VkDrawIndirectCommand{6, 0, 0, 0}};
+        vkCmdUpdateBuffer(commandBuffer, emitter.m_draws->getBuffer(), 0, sizeof(emptyDraws), emptyDraws.data());
+    }
+
+    for (const auto& particles: emitter.m_particles) {
+        m_frameLayerBuffers[frameIndex].push_back(particles);
+    }
+    m_frameLayerBuffers[frameIndex].push_back(emitter.m_instances);
+    m_frameLayerBuffers[frameIndex].push_back(emitter.m_draws);
+    m_frameStats.drawCalls++;
+
+    if (!created && emitter.m_pendingTime <= 0.0f && emitter.m_pendingSpawns == 0) {
+        return;
+    }
+
+    DebugLabel::BeginCmdLabel(commandBuffer, "Simulate Particles", glm::vec4(0.9f, 0.6f, 0.1f, 1));
+
+    const uint32_t current = emitter.m_current;
+    const uint32_t next = 1 - current;
+    const VkDeviceSize drawStride = sizeof(VkDrawIndirectCommand);
+
+    // Earlier frames may still be drawing from the command about to be reset
+    VkMemoryBarrier resetBarrier{};
+    resetBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    resetBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    resetBarrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    vkCmdPipelineBarrier(
+        commandBuffer,
+        VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        0, 1, &resetBarrier, 0, nullptr, 0, nullptr
+    );
+    vkCmdFillBuffer(commandBuffer, emitter.m_draws->getBuffer(), next * drawStride + offsetof(VkDrawIndirectCommand, instanceCount), sizeof(uint32_t), 0);
+
+    // The previous dispatch's particles and count are read, the instances may still be drawn
+    VkMemoryBarrier simulateBarrier{};
+    simulateBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    simulateBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    simulateBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    vkCmdPipelineBarrier(
+        commandBuffer,
+        VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        0, 1, &simulateBarrier, 0, nullptr, 0, nullptr
+    );
+
+    const ParticleEmitterSettings& settings = emitter.m_settings;
+    const uint32_t spawnCount = std::min(emitter.m_pendingSpawns, emitter.m_capacity);
+    const FrameAllocation uniforms = m_frameRing->push(ParticleUniforms{
+        .uvRect = emitter.m_uvRect,
+        .startColor = settings.startColor,
+        .endColor = settings.endColor,
+        .position = settings.position,
+        .spread = settings.spread,
+        .velocityMin = settings.velocityMin,
+        .velocityMax = settings.velocityMax,
+        .gravity = settings.gravity,
+        .angularVelocityMax = settings.angularVelocityMax,
+        .lifetimeMin = settings.lifetimeMin,
+        .lifetimeMax = settings.lifetimeMax,
+        .startSize = settings.startSize,
+        .endSize = settings.endSize,
+        .deltaTime = emitter.m_pendingTime,
+        .spawnCount = spawnCount,
+        .capacity = emitter.m_capacity,
+        .seed = ++emitter.m_seed,
+        .textureIndex = getTextureSlot(emitter.m_texture)
+    });
+
+    const VkDeviceAddress draws = emitter.m_draws->getDeviceAddress();
+    const ParticlePushConstants push{
+        .source = emitter.m_particles[current]->getDeviceAddress(),
+        .destination = emitter.m_particles[next]->getDeviceAddress(),
+        .sourceDraw = draws + current * drawStride,
+        .destinationDraw = draws + next * drawStride,
+        .instances = emitter.m_instances->getDeviceAddress(),
+        .emitter = uniforms.deviceAddress
+    };
+
+    m_particlePipeline->bind(commandBuffer);
+    vkCmdPushConstants(commandBuffer, m_particlePipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(ParticlePushConstants), &push);
+
+    // The live count is only known on the GPU, so every slot that could hold a particle gets a thread
+    vkCmdDispatch(commandBuffer, (emitter.m_capacity + spawnCount + 63) / 64, 1, 1);
+
+    VkMemoryBarrier drawBarrier{};
+    drawBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    drawBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    drawBarrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+    vkCmdPipelineBarrier(
+        commandBuffer,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+        0, 1, &drawBarrier, 0, nullptr, 0, nullptr
+    );
+
+    DebugLabel::EndCmdLabel(commandBuffer);
+
+    emitter.m_current = next;
+    emitter.m_pendingTime = 0.0f;
+    emitter.m_pendingSpawns = 0;
+}
+
+void womp::WompRenderer::recordParticles(VkCommandBuffer commandBuffer, const std::vector<ParticleEmitter*>& emitters, VkDeviceAddress frameUniforms) const {
+    const Pipeline* boundPipeline = nullptr;
+    VkDescriptorSet boundSet = VK_NULL_HANDLE;
+
+    for (const ParticleEmitter* emitter: emitters) {
+        if (!emitter->m_draws || emitter->m_texture == SHAPE_TEXTURE || emitter->m_texture >= m_textureSets.size()) continue;
+
+        const VkDescriptorSet set = m_bindless ? m_bindlessDescriptorSet : m_textureSets[emitter->m_texture];
+        if (set == VK_NULL_HANDLE) continue;
+
+        const Pipeline& pipeline = getSpritePipeline(emitter->m_settings.blendMode, false);
+        if (&pipeline != boundPipeline) {
+            pipeline.bind(commandBuffer);
+            boundPipeline = &pipeline;
+        }
+        if (set != boundSet) {
+            vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelineLayout, 0, 1, &set, 0, nullptr);
+            boundSet = set;
+        }
+
+        const SpritePushConstants push{
+            .instances = emitter->m_instances->getDeviceAddress(),
+            .frame = frameUniforms,
+            .quads = 0
+        };
+        vkCmdPushConstants(commandBuffer, m_pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(SpritePushConstants), &push);
+
+        // The instance count was written by particles.comp
+        vkCmdDrawIndirect(commandBuffer, emitter->m_draws->getBuffer(), emitter->m_current * sizeof(VkDrawIndirectCommand), 1, sizeof(VkDrawIndirectCommand));
+    }
+}
+
+uint32_t womp::WompRenderer::buildTextBatches() {
+    m_textBatches.clear();
+    m_textClipRects.clear();
+
+    uint32_t glyphCount = 0;
+    for (const TextLayout* layout: m_textDrawLayouts) {
+        glyphCount += static_cast<uint32_t>(layout->glyphs.size());
+    }
+    if (glyphCount == 0) {
+        return 0;
+    }
+
+    m_glyphAllocation = m_frameRing->allocateArray<GlyphInstance>(glyphCount);
+    auto* glyphs = static_cast<GlyphInstance*>(m_glyphAllocation.data);
+
+    uint32_t written = 0;
+    for (size_t i = 0; i < m_textDraws.size(); ++i) {
+        const TextDraw& draw = m_textDraws[i];
+        const Font& font = m_fonts[draw.font - 1];
+        const float scale = draw.size / font.file->getSize();
+        const float screenPxRange = font.file->getDistanceRange() * scale;
+        const uint32_t msdf = font.file->isMsdf() ? 1 : 0;
+
+        // Text clip rects follow the draws' in the frame's table, consecutive strings under one clip share it
+        uint32_t clip = 0;
+        if (draw.clip != UnclippedRect()) {
+            if (m_textClipRects.empty() || m_textClipRects.back() != draw.clip) {
+                m_textClipRects.push_back(draw.clip);
+            }
+            clip = static_cast<uint32_t>(m_pendingDraws.clipRects.size() + m_textClipRects.size());
+        }
+
+        // Layouts are in font texels from the baseline, instances are centers and half sizes on screen
+        const uint32_t first = written;
+        for (const TextGlyph& glyph: m_textDrawLayouts[i]->glyphs) {
+            const glm::vec2 halfSize = glm::vec2(glyph.rect.z, glyph.rect.w) * (0.5f * scale);
+            const glm::vec2 center = draw.position + glm::vec2(glyph.rect.x, glyph.rect.y) * scale + halfSize;
+            glyphs[written] = GlyphInstance{
+                .srcRect = glyph.uvRect,
+                .dstRect = glm::vec4(center, halfSize),
+                .color = draw.color,
+                .screenPxRange = screenPxRange,
+                .textureIndex = getTextureSlot(font.texture),
+                .msdf = msdf,
+                .clipIndex = clip
             };
+            ++written;
+        }
 
-            vkCmdPushConstants(commandBuffer, m_pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(PushConstants), &push);
+        if (written == first) continue;
 
+        // Without bindless, consecutive strings of the same font still share a draw
+        const VkDescriptorSet set = m_bindless ? m_bindlessDescriptorSet : m_textureSets[font.texture];
+        if (m_textBatches.empty() || m_textBatches.back().descriptorSet != set) {
+            m_textBatches.push_back(SpriteBatch{.descriptorSet = set, .firstInstance = first, .instanceCount = 0});
+        }
+        m_textBatches.back().instanceCount += written - first;
+    }
+
+    m_frameStats.glyphs = glyphCount;
+    m_frameStats.drawCalls += static_cast<uint32_t>(m_textBatches.size());
+    return glyphCount;
+}
 
-            vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelineLayout, 1, 1, &tex.descriptorSet, 0, nullptr);
+womp::FrameAllocation womp::WompRenderer::writeClipRects() {
+    const size_t clipCount = 1 + m_pendingDraws.clipRects.size() + m_textClipRects.size();
+    m_clipAllocation = m_frameRing->allocateArray<glm::vec4>(clipCount);
 
+    auto* clipRects = static_cast<glm::vec4*>(m_clipAllocation.data);
+    clipRects[0] = UnclippedRect();
+    std::copy(m_pendingDraws.clipRects.begin(), m_pendingDraws.clipRects.end(), clipRects + 1);
+    std::copy(m_textClipRects.begin(), m_textClipRects.end(), clipRects + 1 + m_pendingDraws.clipRects.size());
+    return m_clipAllocation;
+}
+
+void womp::WompRenderer::recordText(VkCommandBuffer commandBuffer, VkDeviceAddress glyphs, VkDeviceAddress frameUniforms) const {
+    if (m_textBatches.empty()) {
+        return;
+    }
 
-            vkCmdDrawIndexed(commandBuffer, 6, 1, 0, 0, 0);
+    DebugLabel::BeginCmdLabel(commandBuffer, "Draw Text", glm::vec4(0.9f, 0.9f, 0.9f, 1));
+
+    m_textPipeline->bind(commandBuffer);
+    const SpritePushConstants push{
+        .instances = glyphs,
+        .frame = frameUniforms,
+        .quads = 0
+    };
+    vkCmdPushConstants(commandBuffer, m_pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(SpritePushConstants), &push);
+
+    for (const auto& batch: m_textBatches) {
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelineLayout, 0, 1, &batch.descriptorSet, 0, nullptr);
+        vkCmdDraw(commandBuffer, 6, batch.instanceCount, 0, batch.firstInstance);
+    }
+
+    DebugLabel::EndCmdLabel(commandBuffer);
+}
+
+void womp::WompRenderer::ensureCullingCapacity(int frameIndex, size_t instanceCount) {
+    auto& culling = m_cullingFrames[frameIndex];
+    if (culling.visibleInstances && culling.visibleInstances->GetSize() >= instanceCount * sizeof(SpriteInstance)) {
+        return;
+    }
+
+    // The frame's fence has already been waited on, so the old buffer is no longer in use
+    size_t capacity = culling.visibleInstances ? culling.visibleInstances->GetSize() / sizeof(SpriteInstance) : INITIAL_INSTANCE_CAPACITY;
+    while (capacity < instanceCount) {
+        capacity *= 2;
+    }
+
+    culling.visibleInstances = std::make_unique<Buffer>(
+        *m_device,
+        capacity * sizeof(SpriteInstance),
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+        VMA_MEMORY_USAGE_GPU_ONLY
+    );
+    DebugLabel::NameBuffer(culling.visibleInstances->getBuffer(), "Visible Sprite Instances: " + std::to_string(frameIndex));
+
+    culling.scanScratch = std::make_unique<Buffer>(
+        *m_device,
+        (capacity + (capacity + CULL_WORKGROUP_SIZE - 1) / CULL_WORKGROUP_SIZE) * sizeof(uint32_t),
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+        VMA_MEMORY_USAGE_GPU_ONLY
+    );
+    DebugLabel::NameBuffer(culling.scanScratch->getBuffer(), "Cull Scan Scratch: " + std::to_string(frameIndex));
+}
+
+void womp::WompRenderer::recordCulling(VkCommandBuffer commandBuffer, int frameIndex, uint32_t instanceCount) {
+    ensureCullingCapacity(frameIndex, instanceCount);
+    const auto& culling = m_cullingFrames[frameIndex];
+
+    m_indirectAllocation = m_frameRing->allocate(INDIRECT_DRAWS_OFFSET + m_batches.size() * sizeof(VkDrawIndirectCommand));
+
+    // cull.comp raises the draw count and fills in where each batch's survivors start and how many there are.
+    // The counts have to start at zero, the shader adds to them.
+    auto* indirectData = static_cast<uint8_t*>(m_indirectAllocation.data);
+    *reinterpret_cast<uint32_t*>(indirectData) = 0;
+
+    auto* draws = reinterpret_cast<VkDrawIndirectCommand*>(indirectData + INDIRECT_DRAWS_OFFSET);
+    for (size_t i = 0; i < m_batches.size(); ++i) {
+        draws[i] = VkDrawIndirectCommand{
+            .vertexCount = 6,
+            .instanceCount = 0,
+            .firstVertex = 0,
+            .firstInstance = m_batches[i].firstInstance
+        };
+    }
+
+    DebugLabel::BeginCmdLabel(commandBuffer, "Cull Sprites", glm::vec4(0.8f, 0.4f, 0.1f, 1));
+
+    m_cullPipeline->bind(commandBuffer);
+
+    CullPushConstants push{
+        .instances = m_instanceAllocation.deviceAddress,
+        .visibleInstances = culling.visibleInstances->getDeviceAddress(),
+        .indirectDraws = m_indirectAllocation.deviceAddress,
+        .scanScratch = culling.scanScratch->getDeviceAddress(),
+        .screenSize = glm::vec2(m_renderer->getSwapchain().GetWidth(), m_renderer->getSwapchain().GetHeight()),
+        .instanceCount = instanceCount
+    };
+
+    // Survivors are placed by an exclusive scan over their visibility, so they keep their order: a scan inside
+    // every workgroup, one over the workgroup totals, then the scatter
+    const uint32_t workgroups = (instanceCount + CULL_WORKGROUP_SIZE - 1) / CULL_WORKGROUP_SIZE;
+    const std::array<uint32_t, 3> passWorkgroups{workgroups, 1, workgroups};
+    for (uint32_t pass = 0; pass < passWorkgroups.size(); ++pass) {
+        if (pass > 0) {
+            VkMemoryBarrier scanBarrier{};
+            scanBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+            scanBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+            scanBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+            vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &scanBarrier, 0, nullptr, 0, nullptr);
         }
 
-        DebugLabel::EndCmdLabel(commandBuffer);
-        m_renderer->endSwapChainRenderPass(commandBuffer);
-        m_renderer->endFrame();
+        push.pass = pass;
+        vkCmdPushConstants(commandBuffer, m_cullPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(CullPushConstants), &push);
+        vkCmdDispatch(commandBuffer, passWorkgroups[pass], 1, 1);
+    }
 
-        // Clear draw queue AFTER render is finished
-        m_pendingDrawCommands.clear();
+    VkMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+
+    vkCmdPipelineBarrier(
+        commandBuffer,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+        0,
+        1, &barrier,
+        0, nullptr,
+        0, nullptr
+    );
+
+    DebugLabel::EndCmdLabel(commandBuffer);
+}
+
+void womp::WompRenderer::recordIndirectDraws(VkCommandBuffer commandBuffer, uint32_t firstBatch, uint32_t batchCount) const {
+    const VkBuffer indirectBuffer = m_indirectAllocation.buffer;
+    const VkDeviceSize countOffset = m_indirectAllocation.offset;
+    const VkDeviceSize offset = countOffset + INDIRECT_DRAWS_OFFSET + firstBatch * sizeof(VkDrawIndirectCommand);
+
+    if (m_device->IsDrawIndirectCountSupported()) {
+        // Every run reads the frame's count at offset 0, one past the last batch with survivors. Anything it trims
+        // from a run starting at firstBatch lies past that batch and is empty, and cull.comp writes every batch's
+        // firstInstance and instanceCount, so runs after the first draw the same as the first.
+        vkCmdDrawIndirectCount(commandBuffer, indirectBuffer, offset, indirectBuffer, countOffset, batchCount, sizeof(VkDrawIndirectCommand));
+        return;
+    }
+
+    for (uint32_t i = 0; i < batchCount; ++i) {
+        vkCmdDrawIndirect(commandBuffer, indirectBuffer, offset + i * sizeof(VkDrawIndirectCommand), 1, sizeof(VkDrawIndirectCommand));
     }
 }
 
+womp::TextureHandle womp::WompRenderer::createTexture(const std::string& filepath, bool mipmapped) {
+    // Atlas pages have a single level, neighbouring textures would bleed into each other's mips anyway
+    if (m_packTextures && !mipmapped) {
+        if (const auto handle = createAtlasTexture(filepath)) {
+            return *handle;
+        }
+    }
 
-womp::TextureHandle womp::WompRenderer::createTexture(const std::string& filepath) {
     Device& device = m_renderer->getDevice();
 
     auto image = std::make_unique<Image>(
@@ -305,40 +1509,371 @@ womp::TextureHandle womp::WompRenderer::createTexture(const std::string& filepat
         VK_FORMAT_R8G8B8A8_SRGB,
         VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
         VMA_MEMORY_USAGE_GPU_ONLY,
-        VK_FILTER_LINEAR
+        VK_FILTER_LINEAR,
+        mipmapped
     );
 
-    device.TransitionImageLayout(
-        image->getImage(),
-        VK_FORMAT_R8G8B8A8_SRGB,
-        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-        1
-    );
+    Image& imageRef = *image;
+    return registerImage(imageRef, std::move(image));
+}
+
+std::optional<womp::TextureHandle> womp::WompRenderer::createAtlasTexture(const std::string& filepath) {
+    // Only the header is read to decide, big textures go through Image as before
+    int width, height, channels;
+    if (!stbi_info(filepath.c_str(), &width, &height, &channels) || width > ATLAS_MAX_TEXTURE_SIZE || height > ATLAS_MAX_TEXTURE_SIZE) {
+        return std::nullopt;
+    }
+
+    uint8_t* pixels = stbi_load(filepath.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+    if (!pixels) {
+        return std::nullopt;
+    }
+
+    UploadBatch batch(m_renderer->getDevice(), UploadQueue::Graphics);
+    const TextureAtlas::Entry entry = m_atlas->add(pixels, glm::ivec2(width, height), batch);
+    stbi_image_free(pixels);
+    batch.submitAndWait();
+
+    if (entry.page == m_atlasPageTextures.size()) {
+        m_atlasPageTextures.push_back(registerImage(*m_atlas->getPage(entry.page).image, nullptr));
+    }
+    return addAtlasTexture(entry.page, entry.offset, entry.size);
+}
+
+womp::TextureHandle womp::WompRenderer::addAtlasTexture(uint32_t page, glm::ivec2 offset, glm::ivec2 size) {
+    const TextureHandle pageTexture = m_atlasPageTextures[page];
+
+    // Only a region of the page, drawn through the page's slot
+    const TextureHandle handle = m_nextHandle++;
+    ensureTextureTables(handle);
+    ++m_textureGeneration;
+
+    const auto pageSize = static_cast<float>(m_atlas->getPage(page).image->GetExtent().width);
+    const glm::vec2 uvOffset = glm::vec2(offset) / pageSize;
+    const glm::vec2 uvScale = glm::vec2(size) / pageSize;
+
+    m_textureSizes[handle] = glm::vec2(size);
+    m_textureSets[handle] = m_textureSets[pageTexture];
+    m_textureSlots[handle] = m_textureSlots[pageTexture];
+    m_textureRegions[handle] = TextureRegion{
+        .texture = pageTexture,
+        .uvOffset = glm::vec2(uvOffset.x, 1.0f - uvOffset.y - uvScale.y),
+        .uvScale = uvScale
+    };
+
+    return handle;
+}
+
+void womp::WompRenderer::loadAtlas(const std::string& filepath) {
+    auto file = std::make_unique<AtlasFile>(filepath);
+
+    if (!m_atlas) {
+        m_atlas = std::make_unique<TextureAtlas>(m_renderer->getDevice(), ATLAS_PAGE_SIZE, VK_FORMAT_R8G8B8A8_SRGB);
+    }
+
+    // Every page in one submit
+    UploadBatch batch(m_renderer->getDevice());
+    std::vector<uint32_t> pages(file->getPageCount());
+    for (uint32_t i = 0; i < file->getPageCount(); ++i) {
+        pages[i] = m_atlas->addPage(file->getPagePixels(i), file->getPageSize(), batch);
+        m_atlasPageTextures.push_back(registerImage(*m_atlas->getPage(pages[i]).image, nullptr));
+    }
+    batch.submitAndWait();
+
+    const TextureHandle firstSprite = m_nextHandle;
+    for (uint32_t slot = 0; slot < file->getSpriteCount(); ++slot) {
+        const AtlasFileSprite& sprite = file->getSprite(slot);
+        addAtlasTexture(
+            pages[sprite.page],
+            glm::ivec2(static_cast<int>(sprite.x), static_cast<int>(sprite.y)),
+            glm::ivec2(static_cast<int>(sprite.width), static_cast<int>(sprite.height))
+        );
+    }
 
-    VkDescriptorSet set;
+    // The mapping stays open for the names findTexture compares against
+    m_loadedAtlases.push_back(LoadedAtlas{std::move(file), firstSprite});
+}
 
-    m_descriptorPool->allocateDescriptor(m_textureDescriptorSetLayout->getDescriptorSetLayout(), set);
+womp::TextureHandle womp::WompRenderer::findTexture(std::string_view name) const {
+    for (const auto& atlas: m_loadedAtlases) {
+        if (const auto slot = atlas.file->find(name)) {
+            return atlas.firstSprite + *slot;
+        }
+    }
+    return 0;
+}
 
-    const auto imageInfo = image->descriptorInfo();
+womp::TextureHandle womp::WompRenderer::registerImage(Image& image, std::unique_ptr<Image> owned) {
+    const TextureHandle handle = allocateHandle();
+    bindImage(handle, image, std::move(owned));
+    return handle;
+}
 
-    DescriptorWriter(*m_textureDescriptorSetLayout, *m_descriptorPool)
-            .writeImage(0, &imageInfo)
-            .build(set);
+womp::TextureHandle womp::WompRenderer::allocateHandle() {
+    if (m_bindless && m_nextTextureSlot >= m_device->GetMaxBindlessTextures()) {
+        throw std::runtime_error("Bindless texture table is full");
+    }
+    const TextureHandle handle = m_nextHandle++;
+    ensureTextureTables(handle);
+    m_textureSlots[handle] = m_bindless ? m_nextTextureSlot++ : handle;
+    return handle;
+}
+
+void womp::WompRenderer::bindImage(TextureHandle handle, Image& image, std::unique_ptr<Image> owned) {
+    ++m_textureGeneration;
 
-    const auto imageSize = glm::vec2(image->GetExtent().width, image->GetExtent().height);
+    VkDescriptorSet set = VK_NULL_HANDLE;
+
+    const auto imageInfo = image.descriptorInfo();
+
+    if (m_bindless) {
+        DescriptorWriter(*m_bindlessDescriptorSetLayout, *m_bindlessDescriptorPool)
+                .writeImage(0, m_textureSlots[handle], &imageInfo)
+                .overwrite(m_bindlessDescriptorSet);
+    } else {
+        m_descriptorPool->allocateDescriptor(m_textureDescriptorSetLayout->getDescriptorSetLayout(), set);
+
+        DescriptorWriter(*m_textureDescriptorSetLayout, *m_descriptorPool)
+                .writeImage(0, &imageInfo)
+                .build(set);
+    }
+
+    const auto imageSize = glm::vec2(image.GetExtent().width, image.GetExtent().height);
 
     Texture tex{
-        .image = std::move(image),
+        .image = std::move(owned),
         .descriptorSet = set,
         .size = imageSize,
     };
 
-    TextureHandle handle = m_nextHandle++;
     m_textures.emplace(handle, std::move(tex));
+
+    // A size createTextureAsync published stays, even when the load fell back to the placeholder, so source rects
+    // normalized against it and layouts built from getTextureSize don't change once the image is bound
+    if (m_textureSizes[handle].x <= 0) {
+        m_textureSizes[handle] = imageSize;
+    }
+    m_textureSets[handle] = set;
+    m_textureRegions[handle] = TextureRegion{.texture = handle};
+}
+
+womp::TextureHandle womp::WompRenderer::createTextureAsync(const std::string& filepath, bool mipmapped) {
+    const TextureHandle placeholder = getPlaceholderTexture();
+    if (!m_textureLoader) {
+        m_textureLoader = std::make_unique<TaskQueue>(m_textureLoadThreads);
+    }
+
+    const TextureHandle handle = allocateHandle();
+    ++m_textureGeneration;
+
+    // Until the upload the handle resolves to the placeholder, its own bindless slot stays unwritten and unused
+    if (IsKtx2Path(filepath)) {
+        // Without block compression the worker falls back to the placeholder, its size is the one to publish
+        const std::optional<glm::ivec2> size = m_device->IsTextureCompressionBCSupported() ? Ktx2File::ReadSize(filepath) : std::nullopt;
+        m_textureSizes[handle] = size ? glm::vec2(*size) : m_textureSizes[placeholder];
+    } else {
+        int width, height, channels;
+        const bool headerRead = stbi_info(filepath.c_str(), &width, &height, &channels);
+        m_textureSizes[handle] = headerRead ? glm::vec2(width, height) : m_textureSizes[placeholder];
+    }
+    m_textureSets[handle] = m_textureSets[placeholder];
+    m_textureRegions[handle] = m_textureRegions[placeholder];
+    m_pendingTextures.insert(handle);
+
+    m_textureLoader->push([this, handle, filepath, mipmapped] {
+        DecodedTexture decoded{.handle = handle, .mipmapped = mipmapped};
+
+        int channels;
+        uint8_t* pixels = nullptr;
+        if (IsKtx2Path(filepath)) {
+            // Only mapped, the blocks are read in by the copy into staging memory
+            try {
+                if (!m_device->IsTextureCompressionBCSupported()) {
+                    throw std::runtime_error("Block compressed textures need the textureCompressionBC feature");
+                }
+                decoded.compressed = std::make_unique<Ktx2File>(filepath);
+                decoded.size = decoded.compressed->getSize();
+
+                std::lock_guard lock{m_decodedTexturesMutex};
+                m_decodedTextures.push_back(std::move(decoded));
+                return;
+            } catch (const std::exception& e) {
+                std::cerr << "Failed to load texture " << filepath << ": " << e.what() << std::endl;
+            }
+        } else {
+            pixels = stbi_load(filepath.c_str(), &decoded.size.x, &decoded.size.y, &channels, STBI_rgb_alpha);
+            if (!pixels) {
+                std::cerr << "Failed to load texture " << filepath << ": " << stbi_failure_reason() << std::endl;
+            }
+        }
+        if (!pixels) {
+            pixels = stbi_load(PLACEHOLDER_TEXTURE_PATH, &decoded.size.x, &decoded.size.y, &channels, STBI_rgb_alpha);
+        }
+        decoded.pixels = {pixels, stbi_image_free};
+
+        std::lock_guard lock{m_decodedTexturesMutex};
+        m_decodedTextures.push_back(std::move(decoded));
+    });
+
     return handle;
 }
 
+bool womp::WompRenderer::isTextureReady(TextureHandle texture) const {
+    return texture < m_textureSizes.size() && m_textureSizes[texture].x > 0 && !m_pendingTextures.contains(texture);
+}
+
+womp::TextureHandle womp::WompRenderer::getPlaceholderTexture() {
+    if (m_placeholderTexture != 0) {
+        return m_placeholderTexture;
+    }
+
+    // A magenta checker stands in when the placeholder file is missing too
+    static constexpr std::array<uint32_t, 4> CHECKER{0xFFFF00FF, 0xFF000000, 0xFF000000, 0xFFFF00FF};
+
+    int width, height, channels;
+    uint8_t* pixels = stbi_load(PLACEHOLDER_TEXTURE_PATH, &width, &height, &channels, STBI_rgb_alpha);
+    const void* data = pixels ? static_cast<const void*>(pixels) : CHECKER.data();
+    if (!pixels) {
+        width = height = 2;
+    }
+    const VkDeviceSize size = static_cast<VkDeviceSize>(width) * height * 4;
+
+    auto image = std::make_unique<Image>(
+        *m_device,
+        VkExtent2D{static_cast<uint32_t>(width), static_cast<uint32_t>(height)},
+        VK_FORMAT_R8G8B8A8_SRGB,
+        VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+        VMA_MEMORY_USAGE_GPU_ONLY,
+        true,
+        true,
+        VK_FILTER_NEAREST
+    );
+
+    // Once per renderer, so the one blocking upload is not worth a frame of delay
+    UploadBatch batch(*m_device);
+    batch.uploadImage(*image, data, size);
+    stbi_image_free(pixels);
+    batch.submitAndWait();
+
+    Image& imageRef = *image;
+    m_placeholderTexture = registerImage(imageRef, std::move(image));
+    return m_placeholderTexture;
+}
+
+void womp::WompRenderer::uploadDecodedTextures(int frameIndex) {
+    // Handed to the graphics queue once the copies are done, so a frame never waits on copies still running
+    while (!m_textureUploads.empty() && m_textureUploads.front().batch->isTransferComplete()) {
+        TextureUpload& upload = m_textureUploads.front();
+        upload.batch->submitAcquire();
+        for (size_t i = 0; i < upload.handles.size(); ++i) {
+            m_pendingTextures.erase(upload.handles[i]);
+            Image& imageRef = *upload.images[i];
+            bindImage(upload.handles[i], imageRef, std::move(upload.images[i]));
+        }
+
+        // The acquire is submitted ahead of this frame, it is done once this frame index comes around again
+        m_frameUploadBatches[frameIndex].push_back(std::move(upload.batch));
+        m_textureUploads.pop_front();
+    }
+
+    std::vector<DecodedTexture> decodedTextures;
+    {
+        std::lock_guard lock{m_decodedTexturesMutex};
+        VkDeviceSize stagingSize = 0;
+        while (!m_decodedTextures.empty()) {
+            const DecodedTexture& next = m_decodedTextures.front();
+            const VkDeviceSize textureSize = next.compressed ? next.compressed->getDataSize() : static_cast<VkDeviceSize>(next.size.x) * next.size.y * 4;
+            // At least one per frame, however big
+            if (!decodedTextures.empty() && stagingSize + textureSize > TEXTURE_UPLOAD_BUDGET) break;
+
+            stagingSize += textureSize;
+            decodedTextures.push_back(std::move(m_decodedTextures.front()));
+            m_decodedTextures.pop_front();
+        }
+    }
+    if (decodedTextures.empty()) {
+        return;
+    }
+
+    TextureUpload upload{.batch = std::make_unique<UploadBatch>(*m_device)};
+    for (auto& decoded: decodedTextures) {
+        // Without pixels the handle keeps drawing the placeholder, like a failed createTexture
+        if (!decoded.pixels && !decoded.compressed) {
+            m_pendingTextures.erase(decoded.handle);
+            continue;
+        }
+
+        if (decoded.compressed) {
+            auto image = std::make_unique<Image>(*m_device, *decoded.compressed, VK_IMAGE_USAGE_SAMPLED_BIT, VMA_MEMORY_USAGE_GPU_ONLY, VK_FILTER_LINEAR, *upload.batch);
+            decoded.compressed.reset();
+
+            upload.handles.push_back(decoded.handle);
+            upload.images.push_back(std::move(image));
+            continue;
+        }
+
+        const VkExtent2D imageSize{static_cast<uint32_t>(decoded.size.x), static_cast<uint32_t>(decoded.size.y)};
+        auto image = std::make_unique<Image>(
+            *m_device,
+            imageSize,
+            VK_FORMAT_R8G8B8A8_SRGB,
+            VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+            VMA_MEMORY_USAGE_GPU_ONLY,
+            true,
+            true,
+            VK_FILTER_LINEAR,
+            decoded.mipmapped ? MipmapGenerator::GetMipLevels(imageSize) : 1
+        );
+        upload.batch->uploadImage(*image, decoded.pixels.get(), static_cast<VkDeviceSize>(decoded.size.x) * decoded.size.y * 4);
+        decoded.pixels.reset();
+
+        upload.handles.push_back(decoded.handle);
+        upload.images.push_back(std::move(image));
+    }
+    if (upload.handles.empty()) {
+        return;
+    }
+
+    upload.batch->submit(false);
+    m_textureUploads.push_back(std::move(upload));
+}
+
+void womp::WompRenderer::ensureTextureTables(TextureHandle handle) {
+    // Flat tables for the submission and recording hot paths, indexed by handle
+    if (m_textureSizes.size() <= handle) {
+        m_textureSizes.resize(handle + 1, glm::vec2(0.0f));
+        m_textureSets.resize(handle + 1, VK_NULL_HANDLE);
+        m_textureRegions.resize(handle + 1);
+        m_textureSlots.resize(handle + 1, SHAPE_TEXTURE);
+    }
+}
+
+womp::FontHandle womp::WompRenderer::loadFont(const std::string& filepath) {
+    auto file = std::make_unique<FontFile>(filepath);
+
+    Device& device = m_renderer->getDevice();
+
+    // Distances are linear data, an sRGB format would bend the edge away from 0.5
+    auto image = std::make_unique<Image>(
+        device,
+        file->getPagePath(),
+        VK_FORMAT_R8G8B8A8_UNORM,
+        VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+        VMA_MEMORY_USAGE_GPU_ONLY,
+        VK_FILTER_LINEAR
+    );
+
+    Image& imageRef = *image;
+    const TextureHandle texture = registerImage(imageRef, std::move(image));
+
+    m_fonts.push_back(Font{std::move(file), texture});
+    return static_cast<FontHandle>(m_fonts.size());
+}
+
+glm::vec2 womp::WompRenderer::getTextureSize(TextureHandle texture) const {
+    return texture < m_textureSizes.size() ? m_textureSizes[texture] : glm::vec2(0.0f);
+}
+
 void womp::WompRenderer::waitIdle() const {
     vkDeviceWaitIdle(m_renderer->getDevice().GetVkDevice());
 }